@@ -0,0 +1,140 @@
+#pragma once
+
+#include "common/com/cobs.h"
+#include "common/event/defs.h"
+#include "common/utility/format.h"
+
+namespace common {
+
+// Deferred formatting: a COMMON_FORMAT log call is stored as the id of its
+// format string and the raw bytes of its arguments, the text is rebuilt on
+// a host by tools/binary_log.py from a string table extracted from the
+// sources. Records are COBS framed (com/cobs.h), a zero byte ends each one.
+//
+// Record: format id (uint16_t) | level (int8_t) | error code (uint8_t) |
+// seconds (uint32_t) | argument types, a nibble each, low nibble first |
+// arguments. Numbers are copied in native (little endian) byte order,
+// strings as a uint8_t length and at most 255 bytes.
+enum class BinaryLogType : uint8_t {
+  kU8 = 1,
+  kI8 = 2,
+  kU16 = 3,
+  kI16 = 4,
+  kU32 = 5,
+  kI32 = 6,
+  kU64 = 7,
+  kI64 = 8,
+  kF32 = 9,
+  kF64 = 10,
+  kString = 11,
+  kBool = 12,
+};
+
+namespace detail {
+
+template <typename T>
+constexpr BinaryLogType BinaryLogTypeOf() {
+  if constexpr (std::is_same<T, bool>::value) {
+    return BinaryLogType::kBool;
+  } else if constexpr (std::is_integral<T>::value) {
+    constexpr uint8_t kLog2Size =
+        sizeof(T) == 1 ? 0 : sizeof(T) == 2 ? 1 : sizeof(T) == 4 ? 2 : 3;
+    return static_cast<BinaryLogType>(1 + 2 * kLog2Size +
+                                      std::is_signed<T>::value);
+  } else if constexpr (std::is_floating_point<T>::value) {
+    static_assert(sizeof(T) == 4 || sizeof(T) == 8, "unsupported float");
+    return sizeof(T) == 4 ? BinaryLogType::kF32 : BinaryLogType::kF64;
+  } else {
+    static_assert(std::is_convertible<T, const char *>::value ||
+                      std::is_same<T, std::string>::value ||
+                      std::is_same<T, Symbol>::value,
+                  "unsupported binary log argument");
+    return BinaryLogType::kString;
+  }
+}
+
+template <typename Sink>
+void EncodeBinaryLogString(const char *str, size_t size, Sink &sink) {
+  uint8_t length = size < 0xFF ? size : 0xFF;
+  sink.Write(reinterpret_cast<const char *>(&length), 1);
+  sink.Write(str, length);
+}
+
+template <typename T, typename Sink>
+void EncodeBinaryLogArg(const T &value, Sink &sink) {
+  if constexpr (std::is_arithmetic<T>::value) {
+    sink.Write(reinterpret_cast<const char *>(&value), sizeof(value));
+  } else if constexpr (std::is_same<T, std::string>::value) {
+    EncodeBinaryLogString(value.c_str(), value.size(), sink);
+  } else if constexpr (std::is_same<T, Symbol>::value) {
+    if (value.Size() < 0xFF) {
+      uint8_t length = value.Size();
+      sink.Write(reinterpret_cast<const char *>(&length), 1);
+      value.Write(sink);
+    } else {
+      std::string text = value.ToString();
+      EncodeBinaryLogString(text.c_str(), text.size(), sink);
+    }
+  } else {
+    const char *str = value;
+    EncodeBinaryLogString(str, strlen(str), sink);
+  }
+}
+
+// Bytes EncodeBinaryLogArg() writes for value.
+template <typename T>
+size_t BinaryLogArgSize(const T &value) {
+  if constexpr (std::is_arithmetic<T>::value) {
+    return sizeof(value);
+  } else {
+    size_t size;
+    if constexpr (std::is_same<T, std::string>::value) {
+      size = value.size();
+    } else if constexpr (std::is_same<T, Symbol>::value) {
+      size = value.Size();
+    } else {
+      size = strlen(value);
+    }
+    return 1 + (size < 0xFF ? size : 0xFF);
+  }
+}
+
+}  // namespace detail
+
+// Encodes a framed record, what handlers get through LogBinary().
+template <typename Literal, typename... Args>
+std::string BinaryLogRecord(FormatString<Literal>, LogLevel level,
+                            uint8_t error_code, const Time &time,
+                            const Args &...args) {
+  using Str = FormatString<Literal>;
+  static_assert(Str::kArgs == sizeof...(Args),
+                "number of arguments does not match the format string");
+  constexpr BinaryLogType kTypes[sizeof...(Args) + 1] = {
+      detail::BinaryLogTypeOf<std::decay_t<Args>>()...};
+
+  constexpr size_t kHeader = sizeof(uint16_t) + sizeof(int8_t) +
+                             sizeof(uint8_t) + sizeof(uint32_t) +
+                             (sizeof...(Args) + 1) / 2;
+  size_t payload = (kHeader + ... + detail::BinaryLogArgSize(args));
+
+  // Framed as it is encoded, the size is known so it is allocated once.
+  std::string record;
+  record.reserve(payload + payload / 254 + 2);
+  common::com::CobsStringSink sink(record);
+  common::com::Encode(Str::kId, sink);
+  common::com::Encode(static_cast<int8_t>(level), sink);
+  common::com::Encode(error_code, sink);
+  common::com::Encode(time.Sec(), sink);
+  for (size_t i{0}; i < sizeof...(Args); i += 2) {
+    uint8_t types = static_cast<uint8_t>(kTypes[i]);
+    if (i + 1 < sizeof...(Args)) {
+      types |= static_cast<uint8_t>(kTypes[i + 1]) << 4;
+    }
+    common::com::Encode(types, sink);
+  }
+  (detail::EncodeBinaryLogArg<std::decay_t<Args>>(args, sink), ...);
+  sink.Finish();
+  return record;
+}
+
+}  // namespace common
@@ -0,0 +1,248 @@
+#pragma once
+
+#include "common/com/com.h"
+
+namespace common::com::I2C {
+
+// Status of a request that returned fewer bytes than asked for. Other values
+// are the ones of Wire.endTransmission().
+constexpr const uint8_t kShortRead = 0xFF;
+
+// I2C master transaction queued in a BusScheduler. Writes carry their
+// encoded payload, requests receive the slave's reply in data.
+struct BusTransaction {
+  using Callback = void (*)(const BusTransaction &);
+
+  // Decodes the reply of a finished request.
+  template <typename MsgType>
+  bool Get(MsgType &msg) const {
+    if (status) {
+      return false;
+    }
+    if constexpr (std::is_same<MsgType, std::string>::value) {
+      msg.assign(data, size);
+    } else if constexpr (std::is_arithmetic<MsgType>::value) {
+      if (size < sizeof(MsgType)) {
+        return false;
+      }
+      memcpy(&msg, data, sizeof(MsgType));
+    } else if constexpr (IsEncodible<MsgType>::has_sink_encoding_method) {
+      ByteSpan span(data, size);
+      return common::com::Decode(span, msg);
+    } else {
+      common::com::Decode(std::string(data, size), msg);
+    }
+    return true;
+  }
+
+  char data[kBufferSize];
+  Callback callback;
+  uint32_t queued_us;
+  // Absolute millis() the transaction should be done by, 0 for none.
+  uint32_t deadline_ms;
+  uint8_t address;
+  uint8_t size;
+  uint8_t priority;
+  uint8_t status;
+  bool request;
+};
+
+// Per slave bookkeeping of a BusScheduler. Latencies are measured from the
+// time a transaction was queued to its completion.
+struct SlaveStats {
+  uint8_t address{0};
+  uint16_t transactions{0};
+  uint16_t failures{0};
+  uint16_t missed_deadlines{0};
+  uint32_t total_latency_us{0};
+  uint32_t max_latency_us{0};
+
+  inline uint32_t AverageLatencyUs() const {
+    return transactions ? total_latency_us / transactions : 0;
+  }
+};
+
+// Queues Publish / Request transactions for many slaves and runs them from
+// loop() with Poll(). The next transaction is the one with the highest
+// priority, then the earliest deadline, then the oldest; transactions are
+// run back to back while the time budget lasts instead of one blocking call
+// per slave. The Wire timeout is set once in Begin().
+template <uint8_t Capacity = 8, uint8_t MaxSlaves = 16>
+class BusScheduler final : public Com {
+public:
+  void Begin(uint32_t wire_timeout_us = 0) {
+    MasterInit();
+    Wire.setWireTimeout(wire_timeout_us);
+  }
+
+  // deadline_ms is relative to now, 0 for none.
+  template <typename MsgType>
+  bool Publish(uint8_t address, const MsgType &msg, uint8_t priority = 0,
+               uint32_t deadline_ms = 0,
+               BusTransaction::Callback callback = nullptr) {
+    BusTransaction *transaction =
+        Queue(address, priority, deadline_ms, callback);
+    if (!transaction) {
+      return false;
+    }
+    BufferSink sink(transaction->data, kBufferSize);
+    if constexpr (std::is_same<MsgType, std::string>::value) {
+      sink.Write(msg.c_str(), msg.size());
+    } else if constexpr (std::is_arithmetic<MsgType>::value ||
+                         IsEncodible<MsgType>::has_sink_encoding_method) {
+      common::com::Encode(msg, sink);
+    } else {
+      std::string encoded;
+      common::com::Encode(msg, encoded);
+      sink.Write(encoded.c_str(), encoded.size());
+    }
+    if (sink.Overflow()) {
+      --size_;
+      return false;
+    }
+    transaction->size = sink.Size();
+    transaction->request = false;
+    return true;
+  }
+
+  // The reply is handed to callback, see BusTransaction::Get().
+  bool Request(uint8_t address, uint8_t quantity,
+               BusTransaction::Callback callback, uint8_t priority = 0,
+               uint32_t deadline_ms = 0) {
+    if (quantity > kBufferSize) {
+      return false;
+    }
+    BusTransaction *transaction =
+        Queue(address, priority, deadline_ms, callback);
+    if (!transaction) {
+      return false;
+    }
+    transaction->size = quantity;
+    transaction->request = true;
+    return true;
+  }
+
+  // Runs queued transactions while the next one is expected to end within
+  // budget_us, the last one's duration being the estimate. At least one
+  // runs per call (0 runs exactly one). Returns the number run.
+  uint8_t Poll(uint32_t budget_us = 0) {
+    uint32_t start = micros();
+    uint8_t run{0};
+    while (size_) {
+      uint8_t next = Next();
+      BusTransaction transaction = transactions_[next];
+      Remove(next);
+      uint32_t transaction_start = micros();
+      Run(transaction);
+      ++run;
+      uint32_t now = micros();
+      if (!budget_us ||
+          now - start + (now - transaction_start) > budget_us) {
+        break;
+      }
+    }
+    return run;
+  }
+
+  inline uint8_t Pending() const {
+    return size_;
+  }
+
+  // nullptr until a transaction with address completed.
+  const SlaveStats *GetStats(uint8_t address) const {
+    for (uint8_t i{0}; i < num_slaves_; ++i) {
+      if (stats_[i].address == address) {
+        return &stats_[i];
+      }
+    }
+    return nullptr;
+  }
+
+private:
+  BusTransaction *Queue(uint8_t address, uint8_t priority,
+                        uint32_t deadline_ms,
+                        BusTransaction::Callback callback) {
+    if (size_ == Capacity) {
+      return nullptr;
+    }
+    BusTransaction &transaction = transactions_[size_++];
+    transaction.callback = callback;
+    transaction.queued_us = micros();
+    transaction.deadline_ms = deadline_ms ? millis() + deadline_ms : 0;
+    transaction.address = address;
+    transaction.priority = priority;
+    transaction.status = 0;
+    return &transaction;
+  }
+
+  // Transactions are kept in queue order, so ties go to the oldest.
+  uint8_t Next() const {
+    uint8_t best{0};
+    for (uint8_t i{1}; i < size_; ++i) {
+      const BusTransaction &a = transactions_[i];
+      const BusTransaction &b = transactions_[best];
+      if (a.priority != b.priority) {
+        if (a.priority > b.priority) {
+          best = i;
+        }
+      } else if (a.deadline_ms && (!b.deadline_ms ||
+                 static_cast<int32_t>(a.deadline_ms - b.deadline_ms) < 0)) {
+        best = i;
+      }
+    }
+    return best;
+  }
+
+  void Remove(uint8_t i) {
+    for (; i + 1 < size_; ++i) {
+      transactions_[i] = transactions_[i + 1];
+    }
+    --size_;
+  }
+
+  void Run(BusTransaction &transaction) {
+    if (transaction.request) {
+      uint8_t received = Wire.requestFrom(
+          transaction.address, transaction.size, static_cast<uint8_t>(true));
+      transaction.status = received == transaction.size ? 0 : kShortRead;
+      transaction.size = Wire.readBytes(transaction.data, received);
+    } else {
+      Wire.beginTransmission(transaction.address);
+      Wire.write(reinterpret_cast<const uint8_t *>(transaction.data),
+                 transaction.size);
+      transaction.status = Wire.endTransmission();
+    }
+    Record(transaction);
+    if (transaction.callback) {
+      (*transaction.callback)(transaction);
+    }
+  }
+
+  void Record(const BusTransaction &transaction) {
+    SlaveStats *stats = const_cast<SlaveStats *>(
+        GetStats(transaction.address));
+    if (!stats) {
+      if (num_slaves_ == MaxSlaves) {
+        return;
+      }
+      stats = &stats_[num_slaves_++];
+      stats->address = transaction.address;
+    }
+    uint32_t latency = micros() - transaction.queued_us;
+    ++stats->transactions;
+    stats->failures += transaction.status != 0;
+    stats->missed_deadlines += transaction.deadline_ms &&
+        static_cast<int32_t>(millis() - transaction.deadline_ms) > 0;
+    stats->total_latency_us += latency;
+    if (latency > stats->max_latency_us) {
+      stats->max_latency_us = latency;
+    }
+  }
+
+  BusTransaction transactions_[Capacity];
+  SlaveStats stats_[MaxSlaves];
+  uint8_t size_{0};
+  uint8_t num_slaves_{0};
+};
+
+}  // namespace common::com::I2C
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "common/com/crc.h"
+#include "common/com/specialized_encoding.h"
+
+namespace common::com {
+
+// Consistent overhead byte stuffing: the encoded packet contains no zero
+// byte, so a single zero delimits packets on the wire and a receiver that
+// lost bytes (or joined mid-stream) resynchronizes at the next delimiter.
+// Overhead is one byte per 254 payload bytes plus the delimiter.
+PROGMEM constexpr uint8_t kCobsDelimiter = 0x00;
+PROGMEM constexpr uint8_t kCobsMaxBlock = 0xFF;
+
+template <typename Sink>
+void CobsEncode(const char *data, size_t bytes, Sink &sink) {
+  size_t start{0};
+  while (true) {
+    size_t end = start;
+    while (end < bytes && data[end] != kCobsDelimiter &&
+           end - start < kCobsMaxBlock - 1) {
+      ++end;
+    }
+    char code = static_cast<char>(end - start + 1);
+    sink.Write(&code, 1);
+    sink.Write(data + start, end - start);
+    if (end == bytes) {
+      break;
+    }
+    // A full block has no implicit zero behind it.
+    start = static_cast<uint8_t>(code) == kCobsMaxBlock ? end : end + 1;
+  }
+  char delimiter = kCobsDelimiter;
+  sink.Write(&delimiter, 1);
+}
+
+// Frames what is written to it straight into str, the bytes CobsEncode()
+// gives for the same payload without a copy of the payload first. Finish()
+// closes the frame with the delimiter.
+class CobsStringSink {
+public:
+  explicit CobsStringSink(std::string &str) : str_{str} {
+    Open();
+  }
+
+  inline void Write(const char *data, size_t bytes) {
+    for (size_t i{0}; i < bytes; ++i) {
+      if (full_) {
+        Open();
+      }
+      if (data[i] == static_cast<char>(kCobsDelimiter)) {
+        Open();
+        continue;
+      }
+      str_.push_back(data[i]);
+      full_ = static_cast<uint8_t>(++str_[code_]) == kCobsMaxBlock;
+    }
+  }
+
+  inline void Finish() {
+    str_.push_back(static_cast<char>(kCobsDelimiter));
+  }
+
+private:
+  inline void Open() {
+    code_ = str_.size();
+    str_.push_back(1);
+    full_ = false;
+  }
+
+  std::string &str_;
+  size_t code_{0};
+  bool full_{false};
+};
+
+// Packet: COBS(payload | CRC-16 of payload) followed by the delimiter.
+template <typename Sink>
+void EncodePacket(const std::string &payload, Sink &sink) {
+  std::string data;
+  data.reserve(payload.size() + sizeof(uint16_t));
+  data.append(payload);
+  StringSink crc_sink(data);
+  common::com::Encode(Crc16(payload.c_str(), payload.size()), crc_sink);
+  CobsEncode(data.c_str(), data.size(), sink);
+}
+
+// Incremental packet decoder, fed one byte at a time so it can be driven
+// from whatever is available in the RX buffer. max_size is the largest
+// payload accepted, the CRC comes on top.
+class PacketDecoder {
+public:
+  explicit PacketDecoder(size_t max_size) : max_size_{max_size} {}
+
+  // Returns true when byte completed a well formed packet, available through
+  // Payload() until the next call. Truncated, oversized or corrupted packets
+  // are dropped silently.
+  bool Push(uint8_t byte) {
+    if (byte == kCobsDelimiter) {
+      bool complete = !remaining_ && !overflow_ &&
+                      data_.size() >= sizeof(uint16_t);
+      if (complete) {
+        uint16_t crc;
+        size_t size = data_.size() - sizeof(uint16_t);
+        memcpy(&crc, data_.c_str() + size, sizeof(uint16_t));
+        complete = crc == Crc16(data_.c_str(), size);
+        if (complete) {
+          data_.resize(size);
+        }
+      }
+      Reset();
+      if (complete) {
+        payload_.swap(data_);
+      }
+      data_.clear();
+      return complete;
+    }
+
+    if (remaining_) {
+      Append(static_cast<char>(byte));
+      --remaining_;
+      return false;
+    }
+    if (code_ && code_ != kCobsMaxBlock) {
+      Append(static_cast<char>(kCobsDelimiter));
+    }
+    code_ = byte;
+    remaining_ = byte - 1;
+    return false;
+  }
+
+  inline std::string &Payload() {
+    return payload_;
+  }
+
+  inline const std::string &Payload() const {
+    return payload_;
+  }
+
+private:
+  inline void Reset() {
+    code_ = 0;
+    remaining_ = 0;
+    overflow_ = false;
+  }
+
+  inline void Append(char c) {
+    if (data_.size() >= max_size_ + sizeof(uint16_t)) {
+      overflow_ = true;
+      return;
+    }
+    data_.push_back(c);
+  }
+
+  std::string data_{};
+  std::string payload_{};
+  size_t max_size_;
+  uint8_t code_{0};
+  uint8_t remaining_{0};
+  bool overflow_{false};
+};
+
+}  // namespace common::com
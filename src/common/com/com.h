@@ -6,8 +6,11 @@
 #include <Wire.h>
 #include <SoftwareSerial.h>
 
+#include "common/com/cobs.h"
 #include "common/com/defs.h"
 #include "common/com/specialized_encoding.h"
+#include "common/com/transfer.h"
+#include "common/com/tx_buffer.h"
 #include "common/utility/utility.h"
 
 /*
@@ -40,118 +43,76 @@ public:
   }
 
 private:
-  static PROGMEM constexpr const uint8_t kStrMetadataSize{8};
+  template <typename ComType>
+  inline static void WriteBytes(ComType &com, const char *data, size_t bytes) {
+    com.write(data, bytes);
+  }
 
   template <typename ComType>
   inline static void WriteBytesAndFlush(
       ComType &com, const char *data, size_t bytes) {
-    // TODO: add timeout
-    while (!com.availableForWrite()) {}
-    com.write(data, bytes);
+    WriteBytes(com, data, bytes);
     com.flush();
   }
 
+  // Chunked transfers run a Transfer to completion, yield() being called
+  // while it waits for the peer.
   template <typename ComType>
   static void WriteBytesAndFlush(
-      ComType &com, const char *data, size_t bytes, uint16_t chunk_size) {
+      ComType &com, const char *data, size_t bytes, uint16_t chunk_size,
+      LinkState *link = nullptr) {
     if (!chunk_size) {
       WriteBytesAndFlush(com, data, bytes);
       return;
     }
-    uint16_t num_chunk = 1 + (bytes - 1) / static_cast<size_t>(chunk_size);
-
-    // Encode metadata
-    {
-      std::string chunk_size_encoded, num_chunk_encoded, bytes_encoded;
-      common::com::Encode(chunk_size, chunk_size_encoded);
-      common::com::Encode(num_chunk, num_chunk_encoded);
-      common::com::Encode(static_cast<uint32_t>(bytes), bytes_encoded);
-      std::string metadata =
-          chunk_size_encoded + num_chunk_encoded + bytes_encoded;
-      WriteBytesAndFlush(com, metadata.c_str(), metadata.size());
-    }
-    uint8_t status;
-    Com::Read(com, status, 0);
-
-    // Encode chunk
-    for (uint16_t i{0}; i < num_chunk; i += (status == 0)) {
-      size_t cur_idx = static_cast<size_t>(i * chunk_size);
-      size_t cur_chunk_size = std::min(chunk_size, bytes - cur_idx);
-      WriteBytesAndFlush(com, data + cur_idx, cur_chunk_size);
-      Com::Read(com, status, 0);
-    }
+    Transfer<ComType> transfer;
+    transfer.BeginWrite(com, data, bytes, chunk_size, 0, link);
+    Wait(transfer);
+    com.flush();
   }
 
+  // Returns false when the transfer failed or timed out, data then holds
+  // whatever was received.
   template <typename ComType>
-  static void ReadBytes(ComType &com, std::string &data,
+  static bool ReadBytes(ComType &com, std::string &data,
                         size_t bytes, uint16_t chunk_size,
-                        uint32_t timeout_ms) {
+                        uint32_t timeout_ms, LinkState *link = nullptr) {
     if (!chunk_size) {
       data.resize(bytes);
-      if (CheckAndWaitForMsgToBeAvilable(com, bytes,true,
-                                         timeout_ms, kWaitTimeMs)) {
-        com.readBytes(&data[0], bytes);
-      }
-      return;
+      return CheckAndWaitForMsgToBeAvilable(com, bytes, true, timeout_ms) &&
+             com.readBytes(&data[0], bytes) == bytes;
     }
+    Transfer<ComType> transfer;
+    transfer.BeginRead(com, 0, chunk_size, timeout_ms, link);
+    TransferStatus status = Wait(transfer);
+    data = common::move(transfer.Data());
+    return status == TransferStatus::DONE;
+  }
 
-    size_t available = com.available();
-    std::string metadata(kStrMetadataSize, 0);
-    if (!CheckAndWaitForMsgToBeAvilable(com, kStrMetadataSize, true,
-                                   timeout_ms, kWaitTimeMs)) {
-      return;
-    }
-    com.readBytes(&metadata[0], kStrMetadataSize);
-    uint16_t sender_chunk_size, num_chunk;
-    uint32_t data_len;
-    common::com::Decode(metadata.substr(0, 2), sender_chunk_size);
-    common::com::Decode(metadata.substr(2, 2), num_chunk);
-    common::com::Decode(metadata.substr(4, 4), data_len);
-    if (available != kStrMetadataSize) {
-      com.write(uint8_t(1));
-      com.flush();
-    } else if (sender_chunk_size > chunk_size) {
-      com.write(uint8_t(2));
-      com.flush();
-    } else {
-      com.write(uint8_t(0));
-      com.flush();
-    }
-
-    data.resize(data_len);
-    uint8_t status = {0};
-    for (uint16_t i{0}; i < num_chunk; i += (status == 0)) {
-      size_t idx{i * sender_chunk_size};
-      size_t expected_size = (i + 1) == num_chunk ? data_len - idx :
-                                                    sender_chunk_size;
-      status = 0;
-      if (!CheckAndWaitForMsgToBeAvilable(com, expected_size, true,
-                                          timeout_ms, kWaitTimeMs)) {
-        status = 1;
-      }
-      com.readBytes(&data[idx], expected_size);
-      while (!com.availableForWrite()) {}
-      com.write(status);
-      com.flush();
+  template <typename ComType>
+  static TransferStatus Wait(Transfer<ComType> &transfer) {
+    while (transfer.Poll() == TransferStatus::IN_PROGRESS) {
+      yield();
     }
+    return transfer.Status();
   }
 
 protected:
-  static PROGMEM constexpr const uint16_t kWaitTimeMs{5};
-
   template<typename ComType>
   inline static void Write(ComType &com,
-                           const std::string &msg, uint16_t chunk_size) {
-    WriteBytesAndFlush(com, msg.c_str(), msg.size(), chunk_size);
+                           const std::string &msg, uint16_t chunk_size,
+                           LinkState *link = nullptr) {
+    WriteBytesAndFlush(com, msg.c_str(), msg.size(), chunk_size, link);
   }
 
   template<typename ComType, typename MsgType,
       typename = std::enable_if_t<std::is_arithmetic<MsgType>::value>,
       typename = std::enable_if_t<IsEncodible<MsgType>::value>>
-  inline static void Write(ComType &com, const MsgType &msg, uint16_t = 0) {
-    std::string buffer;
-    common::com::Encode(msg, buffer);
-    WriteBytesAndFlush(com, buffer.c_str(), buffer.size(), 0);
+  inline static void Write(ComType &com, const MsgType &msg, uint16_t = 0,
+                           LinkState * = nullptr) {
+    StreamSink<ComType> sink(com);
+    common::com::Encode(msg, sink);
+    com.flush();
   }
 
   template<typename ComType, typename MsgType,
@@ -159,50 +120,75 @@ protected:
       typename = std::enable_if_t<!std::is_arithmetic<MsgType>::value>,
       typename = std::nullptr_t>
   inline static void Write(
-      ComType &com, const MsgType &msg, uint16_t chunk_size) {
+      ComType &com, const MsgType &msg, uint16_t chunk_size,
+      LinkState *link = nullptr) {
+    // Unchunked transfers have nothing to resend, so sink encodable messages
+    // are written straight into the TX buffer.
+    if constexpr (IsEncodible<MsgType>::has_sink_encoding_method) {
+      if (!chunk_size) {
+        StreamSink<ComType> sink(com);
+        common::com::Encode(msg, sink);
+        com.flush();
+        return;
+      }
+    }
     std::string encoded_msg;
     common::com::Encode(msg, encoded_msg);
     WriteBytesAndFlush(com, encoded_msg.c_str(),
-                       encoded_msg.size(), chunk_size);
+                       encoded_msg.size(), chunk_size, link);
   }
 
+  // The Read overloads return false, leaving msg unspecified, when the
+  // bytes did not arrive in time, the transfer failed or msg did not decode.
   template<typename ComType>
-  inline static void Read(ComType &com, std::string &msg, uint32_t timeout_ms,
-                          int bytes, uint16_t chunk_size) {
-    ReadBytes(com, msg, bytes, chunk_size, timeout_ms);
+  inline static bool Read(ComType &com, std::string &msg, uint32_t timeout_ms,
+                          int bytes, uint16_t chunk_size,
+                          LinkState *link = nullptr) {
+    return ReadBytes(com, msg, bytes, chunk_size, timeout_ms, link);
   }
 
   template<typename MsgType, typename ComType,
       typename = std::enable_if_t<std::is_arithmetic<MsgType>::value>,
       typename = std::enable_if_t<IsEncodible<MsgType>::value>>
-  inline static void Read(ComType &com, MsgType &msg, uint32_t timeout_ms,
-                          int = 0, uint16_t = 0) {
-    std::string buffer;
-    ReadBytes(com, buffer, sizeof(MsgType), 0, 0);
-    common::com::Decode(buffer, msg);
+  inline static bool Read(ComType &com, MsgType &msg, uint32_t timeout_ms,
+                          int = 0, uint16_t = 0, LinkState * = nullptr) {
+    return CheckAndWaitForMsgToBeAvilable(com, sizeof(MsgType), true,
+                                          timeout_ms) &&
+           com.readBytes(reinterpret_cast<char *>(&msg), sizeof(MsgType)) ==
+               sizeof(MsgType);
   }
 
   template<typename MsgType, typename ComType,
       typename = std::enable_if_t<IsEncodible<MsgType>::value>,
       typename = std::enable_if_t<!std::is_arithmetic<MsgType>::value>,
       typename = std::nullptr_t>
-  inline static void Read(ComType &com, MsgType &msg, uint32_t timeout_ms,
-                          int bytes, uint16_t chunk_size) {
+  inline static bool Read(ComType &com, MsgType &msg, uint32_t timeout_ms,
+                          int bytes, uint16_t chunk_size,
+                          LinkState *link = nullptr) {
     std::string msg_str;
-    Read(com, msg_str, bytes, chunk_size, timeout_ms);
-    common::com::Decode(msg_str, msg);
+    if (!Read(com, msg_str, timeout_ms, bytes, chunk_size, link)) {
+      return false;
+    }
+    if constexpr (IsEncodible<MsgType>::has_sink_encoding_method) {
+      ByteSpan span(msg_str);
+      return common::com::Decode(span, msg);
+    } else {
+      common::com::Decode(msg_str, msg);
+      return true;
+    }
   }
 
+  // timeout_ms 0 waits forever. yield() is called while waiting.
   template<typename ComType>
   static bool CheckAndWaitForMsgToBeAvilable(
       ComType &com, size_t expected_bytes, bool blocking,
-      uint32_t timeout_ms, uint32_t delay_time_ms) {
-    uint32_t tick{0};
+      uint32_t timeout_ms) {
+    uint32_t start = millis();
     while (static_cast<size_t>(com.available()) < expected_bytes) {
-      if (!blocking || (timeout_ms && ++tick * delay_time_ms >= timeout_ms)) {
+      if (!blocking || (timeout_ms && millis() - start >= timeout_ms)) {
         return false;
       }
-      delay(delay_time_ms);
+      yield();
     }
     return true;
   }
@@ -218,6 +204,338 @@ protected:
 namespace I2C {
 
 constexpr const uint16_t kChunkSize = 0;
+// Size of the Wire RX / TX buffers (BUFFER_LENGTH on AVR).
+constexpr const uint8_t kBufferSize = 32;
+// Number of routed message types a slave can register (requests and
+// subscriptions together).
+constexpr const uint8_t kMaxRoutes = 32;
+
+// Double buffered, pre-encoded reply. Publish() encodes from loop() into the
+// buffer the request ISR is not reading and then flips the active index, so
+// the ISR only copies bytes (see Reply::RegisterSnapshot).
+class ReplySnapshot {
+public:
+  // Returns false, keeping the previous reply, if msg does not fit.
+  template <typename MsgType>
+  bool Publish(const MsgType &msg) {
+    uint8_t next = active_ ^ 1;
+    BufferSink sink(buffers_[next], kBufferSize);
+    if constexpr (std::is_same<MsgType, std::string>::value) {
+      sink.Write(msg.c_str(), msg.size());
+    } else if constexpr (std::is_arithmetic<MsgType>::value ||
+                         IsEncodible<MsgType>::has_sink_encoding_method) {
+      common::com::Encode(msg, sink);
+    } else {
+      std::string encoded;
+      common::com::Encode(msg, encoded);
+      sink.Write(encoded.c_str(), encoded.size());
+    }
+    if (sink.Overflow()) {
+      return false;
+    }
+    // cli / sei are compiler barriers too, the ISR never sees the new index
+    // before the bytes and the size behind it.
+    noInterrupts();
+    sizes_[next] = sink.Size();
+    active_ = next;
+    interrupts();
+    return true;
+  }
+
+  // Called from the request ISR.
+  inline void WriteTo(TwoWire &wire) const {
+    uint8_t active = active_;
+    wire.write(reinterpret_cast<const uint8_t *>(buffers_[active]),
+               sizes_[active]);
+  }
+
+private:
+  char buffers_[2][kBufferSize];
+  uint8_t sizes_[2]{0, 0};
+  volatile uint8_t active_{0};
+};
+
+// Named field of a RegisterMap: a T stored at a fixed byte offset.
+template <typename T, uint8_t Offset>
+struct Register {
+  static_assert(std::is_arithmetic<T>::value,
+                "registers hold arithmetic types");
+  using Type = T;
+  static constexpr uint8_t kOffset = Offset;
+  static constexpr uint8_t kSize = sizeof(T);
+};
+
+// Slave side register map. A master write made of one offset byte moves the
+// read pointer, every request is answered with the bytes from there on, so
+// the master reads any contiguous range with Request::ReadRegisters and
+// only polls the fields it needs. The pointer moves past what a request
+// sent, a range larger than the Wire buffer is read with back to back
+// requests. Attach() takes over the Wire callbacks.
+template <uint16_t Size>
+class RegisterMap {
+public:
+  static_assert(Size > 0 && Size <= 256, "offsets are one byte");
+
+  void Attach() {
+    Instance() = this;
+    Wire.onReceive(&RegisterMap::OnReceive);
+    Wire.onRequest(&RegisterMap::OnRequest);
+  }
+
+  template <typename Reg>
+  void Set(const typename Reg::Type &value) {
+    static_assert(Reg::kOffset + Reg::kSize <= Size, "register out of map");
+    SetBytes(Reg::kOffset, reinterpret_cast<const char *>(&value),
+             Reg::kSize);
+  }
+
+  template <typename Reg>
+  typename Reg::Type Get() const {
+    static_assert(Reg::kOffset + Reg::kSize <= Size, "register out of map");
+    typename Reg::Type value;
+    memcpy(&value, data_ + Reg::kOffset, Reg::kSize);
+    return value;
+  }
+
+  // Raw access, e.g. for an encoded message spanning several registers.
+  // Interrupts are held off so the ISR never sends a torn value.
+  bool SetBytes(uint16_t offset, const char *data, uint16_t bytes) {
+    if (offset + bytes > Size) {
+      return false;
+    }
+    noInterrupts();
+    memcpy(data_ + offset, data, bytes);
+    interrupts();
+    return true;
+  }
+
+private:
+  static RegisterMap *&Instance() {
+    static RegisterMap *instance{nullptr};
+    return instance;
+  }
+
+  static void OnReceive(int) {
+    RegisterMap *map = Instance();
+    if (Wire.available()) {
+      map->offset_ = Wire.read();
+    }
+    while (Wire.available()) {
+      Wire.read();
+    }
+  }
+
+  static void OnRequest() {
+    RegisterMap *map = Instance();
+    uint16_t offset = map->offset_ < Size ? map->offset_ : 0;
+    uint16_t bytes = Size - offset;
+    bytes = bytes < kBufferSize ? bytes : kBufferSize;
+    Wire.write(map->data_ + offset, bytes);
+    map->offset_ = offset + bytes;
+  }
+
+  uint8_t data_[Size]{};
+  // 256 for a full map wraps to 0.
+  volatile uint8_t offset_{0};
+};
+
+namespace internal {
+
+// Slave side router: every master write starts with a one byte message type
+// used to find the handler. A write made of the type byte alone selects the
+// reply sent on the next request. Routes are kept sorted by (type,
+// direction) in a fixed table and looked up with a binary search from the
+// Wire ISR, so no allocation happens per request for arithmetic and sink
+// encodable messages.
+class Router final : public Com {
+public:
+  Router() = delete;
+
+  struct Route {
+    using Thunk = void (*)(const Route &, int);
+    // Storage for a pointer to a method of a class without virtual bases.
+    using Method = void (Route::*)();
+    uint8_t type;
+    bool request;
+    Thunk thunk;
+    // Type-erased free function callback, or the method called on object.
+    union {
+      void (*callback)();
+      char method[sizeof(Method)];
+    };
+    void *object;
+  };
+
+  // Every route keeps its own method, so one class can serve several
+  // types with different methods taking the same message type.
+  template <class ClassType, typename MethodType>
+  static Route MethodRoute(uint8_t type, bool request, Route::Thunk thunk,
+                           ClassType *object, MethodType method) {
+    static_assert(sizeof(MethodType) <= sizeof(Route::Method),
+                  "method pointer does not fit in a route");
+    Route route{type, request, thunk, nullptr, object};
+    memcpy(route.method, &method, sizeof(method));
+    return route;
+  }
+
+  // Safe while the slave is live: the Wire ISR searching the table never
+  // sees a route half copied or shifted.
+  static bool Add(const Route &route) {
+    Table &table = GetTable();
+    uint8_t i = LowerBound(route.type, route.request);
+    if (i < table.size && table.routes[i].type == route.type &&
+        table.routes[i].request == route.request) {
+      noInterrupts();
+      table.routes[i] = route;
+      interrupts();
+      return true;
+    }
+    if (table.size == kMaxRoutes) {
+      return false;
+    }
+    noInterrupts();
+    for (uint8_t j = table.size; j > i; --j) {
+      table.routes[j] = table.routes[j - 1];
+    }
+    table.routes[i] = route;
+    ++table.size;
+    interrupts();
+    Install();
+    return true;
+  }
+
+  template <typename MsgType>
+  static void ReceiveFunction(const Route &route, int bytes) {
+    MsgType msg;
+    if (!ReadRouted(msg, bytes)) {
+      return;
+    }
+    reinterpret_cast<void (*)(const MsgType &, int)>(route.callback)(
+        msg, bytes);
+  }
+
+  template <class ClassType, typename MsgType>
+  static void ReceiveMethod(const Route &route, int bytes) {
+    MsgType msg;
+    if (!ReadRouted(msg, bytes)) {
+      return;
+    }
+    void (ClassType::*method)(const MsgType &, int);
+    memcpy(&method, route.method, sizeof(method));
+    (static_cast<ClassType *>(route.object)->*method)(msg, bytes);
+  }
+
+  template <typename MsgType>
+  static void RequestFunction(const Route &route, int) {
+    MsgType msg;
+    reinterpret_cast<void (*)(MsgType &)>(route.callback)(msg);
+    Write(Wire, msg, kChunkSize);
+  }
+
+  template <class ClassType, typename MsgType>
+  static void RequestMethod(const Route &route, int) {
+    void (ClassType::*method)(MsgType &);
+    memcpy(&method, route.method, sizeof(method));
+    MsgType msg;
+    (static_cast<ClassType *>(route.object)->*method)(msg);
+    Write(Wire, msg, kChunkSize);
+  }
+
+  static void RequestSnapshot(const Route &route, int) {
+    static_cast<const ReplySnapshot *>(route.object)->WriteTo(Wire);
+  }
+
+private:
+  struct Table {
+    Route routes[kMaxRoutes];
+    uint8_t size{0};
+    uint8_t selected{0};
+  };
+
+  static Table &GetTable() {
+    static Table table;
+    return table;
+  }
+
+  static void Install() {
+    [[maybe_unused]] static bool _ = []() -> bool {
+      Wire.onReceive(&Router::OnReceive);
+      Wire.onRequest(&Router::OnRequest);
+      return true;
+    }();
+  }
+
+  static uint8_t LowerBound(uint8_t type, bool request) {
+    const Table &table = GetTable();
+    uint16_t key = (uint16_t{type} << 1) | request;
+    uint8_t lo{0}, hi{table.size};
+    while (lo < hi) {
+      uint8_t mid = (lo + hi) / 2;
+      const Route &route = table.routes[mid];
+      if (((uint16_t{route.type} << 1) | route.request) < key) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return lo;
+  }
+
+  static const Route *Find(uint8_t type, bool request) {
+    const Table &table = GetTable();
+    uint8_t i = LowerBound(type, request);
+    if (i < table.size && table.routes[i].type == type &&
+        table.routes[i].request == request) {
+      return &table.routes[i];
+    }
+    return nullptr;
+  }
+
+  static void OnReceive(int bytes) {
+    if (!Wire.available()) {
+      return;
+    }
+    uint8_t type = Wire.read();
+    if (--bytes <= 0) {
+      GetTable().selected = type;
+      return;
+    }
+    const Route *route = Find(type, false);
+    if (route) {
+      route->thunk(*route, bytes);
+    }
+    Drain(Wire);
+  }
+
+  static void OnRequest() {
+    const Route *route = Find(GetTable().selected, true);
+    if (route) {
+      route->thunk(*route, 0);
+    }
+  }
+
+  // Fixed size and sink decodable messages are read from the Wire buffer
+  // without going through a std::string. Returns false for a write too
+  // short for the message, its callback is then skipped.
+  template <typename MsgType>
+  static bool ReadRouted(MsgType &msg, int bytes) {
+    if constexpr (std::is_arithmetic<MsgType>::value) {
+      return bytes >= static_cast<int>(sizeof(MsgType)) &&
+             Wire.readBytes(reinterpret_cast<char *>(&msg),
+                            sizeof(MsgType)) == sizeof(MsgType);
+    } else if constexpr (IsEncodible<MsgType>::has_sink_encoding_method) {
+      char buffer[kBufferSize];
+      size_t size = Wire.readBytes(
+          buffer, bytes < kBufferSize ? bytes : kBufferSize);
+      ByteSpan span(buffer, size);
+      return common::com::Decode(span, msg);
+    } else {
+      return Read(Wire, msg, 0, bytes, kChunkSize);
+    }
+  }
+};
+
+}  // namespace internal
 
 class Reply final : public Com {
 public:
@@ -252,7 +570,51 @@ public:
     Wire.onRequest(callback_static);
   }
 
+  // Routed replies: the master selects the message with
+  // Request::RequestFrom<type>(address, ...). Several types can be served,
+  // but routed and unrouted callbacks must not be mixed on one slave.
+  template<typename MsgType>
+  static bool RegisterCallback(uint8_t type, void (*callback)(MsgType &)) {
+    return internal::Router::Add(
+        {type, true, &internal::Router::RequestFunction<MsgType>,
+         reinterpret_cast<void (*)()>(callback), nullptr});
+  }
+
+  template<class ClassType, typename MsgType>
+  static bool RegisterCallback(
+      uint8_t type, ClassType *class_ptr,
+      void (ClassType::*callback)(MsgType &)) {
+    return internal::Router::Add(internal::Router::MethodRoute(
+        type, true, &internal::Router::RequestMethod<ClassType, MsgType>,
+        class_ptr, callback));
+  }
+
+  // Snapshot replies: instead of building the reply in the ISR, loop()
+  // keeps snapshot up to date with snapshot.Publish(msg) and requests are
+  // answered with its pre-encoded bytes.
+  static void RegisterSnapshot(ReplySnapshot &snapshot) {
+    SnapshotStore() = &snapshot;
+    Wire.onRequest(&Reply::WriteSnapshot);
+  }
+
+  static bool RegisterSnapshot(uint8_t type, ReplySnapshot &snapshot) {
+    return internal::Router::Add(
+        {type, true, &internal::Router::RequestSnapshot, nullptr,
+         &snapshot});
+  }
+
 private:
+  static ReplySnapshot *&SnapshotStore() {
+    static ReplySnapshot *snapshot{nullptr};
+    return snapshot;
+  }
+
+  static void WriteSnapshot() {
+    if (SnapshotStore()) {
+      SnapshotStore()->WriteTo(Wire);
+    }
+  }
+
   template<typename MsgType>
   struct FunctionTypeImpl {
     typedef void (*FunctionPtrType)(MsgType &);
@@ -312,7 +674,7 @@ public:
     }
     Wire.setWireTimeout(timeout_ms);
     Wire.requestFrom(address, quantity, static_cast<uint8_t>(true));
-    Read(Wire, msg, quantity, kChunkSize, timeout_ms);
+    Read(Wire, msg, timeout_ms, quantity, kChunkSize);
   }
 
   template<typename MsgType,
@@ -323,10 +685,72 @@ public:
                           MsgType &msg,
                           uint32_t timeout_ms = 0) {
     std::string encoded_msg;
-    RequestFrom(address, quantity, msg, timeout_ms);
+    RequestFrom(address, quantity, encoded_msg, timeout_ms);
     msg.Decode(encoded_msg);
   }
 
+  // Reads bytes registers of a RegisterMap starting at offset. Ranges larger
+  // than the Wire buffer are read with one request per buffer, the slave
+  // moving its pointer past what it sent.
+  static bool ReadRegisters(uint8_t address, uint8_t offset, char *data,
+                            uint16_t bytes, uint32_t timeout_ms = 0) {
+    if (!MasterInit()) {
+      return false;
+    }
+    Wire.setWireTimeout(timeout_ms);
+    Wire.beginTransmission(address);
+    Wire.write(offset);
+    if (Wire.endTransmission(false)) {
+      return false;
+    }
+    while (bytes) {
+      uint8_t quantity = bytes < kBufferSize ? bytes : kBufferSize;
+      bool last = quantity == bytes;
+      if (Wire.requestFrom(address, quantity, static_cast<uint8_t>(last)) !=
+          quantity) {
+        return false;
+      }
+      Wire.readBytes(data, quantity);
+      data += quantity;
+      bytes -= quantity;
+    }
+    return true;
+  }
+
+  template<typename Reg>
+  static bool ReadRegister(uint8_t address, typename Reg::Type &value,
+                           uint32_t timeout_ms = 0) {
+    return ReadRegisters(address, Reg::kOffset,
+                         reinterpret_cast<char *>(&value), Reg::kSize,
+                         timeout_ms);
+  }
+
+  // Requests the reply routed to Type. quantity is the number of bytes the
+  // reply takes, arithmetic types always use their size.
+  template<uint8_t Type, typename MsgType>
+  static bool RequestFrom(uint8_t address,
+                          MsgType &msg,
+                          uint8_t quantity = 0,
+                          uint32_t timeout_ms = 0) {
+    if (!MasterInit()) {
+      return false;
+    }
+    if constexpr (std::is_arithmetic<MsgType>::value) {
+      quantity = sizeof(MsgType);
+    }
+    Wire.setWireTimeout(timeout_ms);
+    Wire.beginTransmission(address);
+    Wire.write(Type);
+    if (Wire.endTransmission(false)) {
+      return false;
+    }
+    if (Wire.requestFrom(address, quantity, static_cast<uint8_t>(true)) !=
+        quantity) {
+      return false;
+    }
+    return Read(Wire, msg, timeout_ms, quantity, kChunkSize);
+  }
+
 };
 
 class Subscriber final : public Com {
@@ -337,9 +761,8 @@ public:
   static void RegisterCallback(void (*callback)(const MsgType &, int)) {
     CallbackFunctionStore<MsgType>() = callback;
     auto _callback = [](int bytes) {
-      if (Wire.available()) {
-        MsgType msg;
-        Read(Wire, msg, bytes, kChunkSize, 0);
+      MsgType msg;
+      if (Wire.available() && Read(Wire, msg, 0, bytes, kChunkSize)) {
         auto callback = Subscriber::CallbackFunctionStore<MsgType>();
         (*callback)(common::move(msg), bytes);
       }
@@ -354,9 +777,8 @@ public:
     ClassCallbackMethodStore<ClassType, MsgType>() = callback;
     ClassPtrStore<ClassType>() = class_ptr;
     auto _callback = [](int bytes) {
-      if (Wire.available()) {
-        MsgType msg;
-        Read(Wire, msg, bytes, kChunkSize, 0);
+      MsgType msg;
+      if (Wire.available() && Read(Wire, msg, 0, bytes, kChunkSize)) {
         auto callback =
             Subscriber::ClassCallbackMethodStore<ClassType, MsgType>();
         ((Subscriber::ClassPtrStore<ClassType>())->*callback)(
@@ -367,6 +789,25 @@ public:
     Wire.onReceive(callback_static);
   }
 
+  // Routed subscriptions for messages sent with
+  // Publisher::Publish<type>(address, ...). bytes excludes the type header.
+  template<typename MsgType>
+  static bool RegisterCallback(uint8_t type,
+                               void (*callback)(const MsgType &, int)) {
+    return internal::Router::Add(
+        {type, false, &internal::Router::ReceiveFunction<MsgType>,
+         reinterpret_cast<void (*)()>(callback), nullptr});
+  }
+
+  template<class ClassType, typename MsgType>
+  static bool RegisterCallback(
+      uint8_t type, ClassType *class_ptr,
+      void (ClassType::*callback)(const MsgType &, int)) {
+    return internal::Router::Add(internal::Router::MethodRoute(
+        type, false, &internal::Router::ReceiveMethod<ClassType, MsgType>,
+        class_ptr, callback));
+  }
+
 private:
   template<typename MsgType>
   struct FunctionTypeImpl {
@@ -415,13 +856,33 @@ public:
     Write(Wire, msg, kChunkSize);
     return (Wire.endTransmission());
   }
+
+  // Publishes to the routed Subscriber callback registered for Type.
+  template<uint8_t Type, typename MsgType>
+  static uint8_t Publish(uint8_t address,
+                         const MsgType &msg,
+                         uint32_t timeout_ms = 0) {
+    if (!MasterInit()) {
+      return -1;
+    }
+    Wire.setWireTimeout(timeout_ms);
+    Wire.beginTransmission(address);
+    Wire.write(Type);
+    Write(Wire, msg, kChunkSize);
+    return (Wire.endTransmission());
+  }
 };
 
 }  // namespace I2C
 
 namespace UART {
 
-constexpr uint16_t kChunkSize = 32;
+// A window of 3 chunks of 16 bytes, CRC framed or not, fits in the 63 byte
+// RX ring, so the default link pipelines.
+constexpr uint16_t kChunkSize = 16;
+constexpr uint8_t kWindowSize = 3;
+// Largest payload a packet (COBS framed) read accepts.
+constexpr uint16_t kMaxPacketSize = 255;
 
 namespace internal {
 
@@ -429,26 +890,166 @@ template <typename SerialType>
 class UARTComBase : public Com {
 protected:
   template <typename MsgType>
-  inline static void Write(SerialType& com,
-                    const MsgType& msg, uint32_t timeout_ms) {
+  inline static void Write(SerialType& com, const MsgType& msg,
+                           uint32_t timeout_ms, LinkState *link) {
     com.setTimeout(timeout_ms);
-    Com::Write(com, msg, kChunkSize);
+    Com::Write(com, msg, kChunkSize, link);
   }
 
   template <typename MsgType>
-  inline static bool Read(SerialType& com, MsgType& msg,
-                          bool blocking, bool drain, uint32_t timeout_ms) {
-    if (CheckAndWaitForMsgToBeAvilable(
-        com, 1, blocking, timeout_ms, kWaitTimeMs)) {
+  inline static bool Read(SerialType& com, MsgType& msg, bool blocking,
+                          bool drain, uint32_t timeout_ms, LinkState *link) {
+    if (CheckAndWaitForMsgToBeAvilable(com, 1, blocking, timeout_ms)) {
       com.setTimeout(timeout_ms);
-      Com::Read(com, msg, 0, kChunkSize, timeout_ms);
+      bool ok = Com::Read(com, msg, timeout_ms, 0, kChunkSize, link);
       if (drain) {
         Drain(com);
       }
-      return true;
+      return ok;
     }
     return false;
   }
+
+  template <typename MsgType>
+  static Transfer<SerialType> *BeginWrite(
+      SerialType& com, Transfer<SerialType>& transfer, const MsgType& msg,
+      uint32_t timeout_ms, LinkState *link,
+      typename Transfer<SerialType>::Callback callback) {
+    std::string data;
+    uint16_t chunk_size = EncodeForTransfer(msg, data);
+    if (!transfer.BeginWrite(com, common::move(data), chunk_size, timeout_ms,
+                             link, callback)) {
+      return nullptr;
+    }
+    return &transfer;
+  }
+
+  template <typename MsgType>
+  static Transfer<SerialType> *BeginRead(
+      SerialType& com, Transfer<SerialType>& transfer, uint32_t timeout_ms,
+      LinkState *link, typename Transfer<SerialType>::Callback callback) {
+    constexpr bool raw = std::is_arithmetic<MsgType>::value;
+    if (!transfer.BeginRead(com, raw ? sizeof(MsgType) : 0,
+                            raw ? 0 : kChunkSize, timeout_ms, link,
+                            callback)) {
+      return nullptr;
+    }
+    return &transfer;
+  }
+
+  // Packet mode: one COBS framed, CRC checked message per call with no
+  // metadata handshake and no acknowledgement.
+  template <typename MsgType>
+  static void WritePacket(SerialType& com, const MsgType& msg) {
+    std::string payload;
+    EncodeForTransfer(msg, payload);
+    SendPacket(com, payload);
+    com.flush();
+  }
+
+  template <typename MsgType>
+  static bool ReadPacket(SerialType& com, PacketDecoder& decoder,
+                         MsgType& msg, bool blocking, uint32_t timeout_ms) {
+    if (!ReceivePacket(com, decoder, blocking, timeout_ms)) {
+      return false;
+    }
+    return DecodeFromTransfer(decoder.Payload(), msg);
+  }
+
+  // Telemetry: packets with a trailing sequence number, written back to back
+  // without waiting for the TX buffer to drain. Nothing is ever read back.
+  template <typename MsgType>
+  static void WriteTelemetry(SerialType& com, uint16_t& seq,
+                             const MsgType& msg) {
+    StreamSink<SerialType> sink(com);
+    EncodeTelemetry(sink, seq, msg);
+  }
+
+  template <typename Sink, typename MsgType>
+  static void EncodeTelemetry(Sink& sink, uint16_t& seq, const MsgType& msg) {
+    std::string payload;
+    EncodeForTransfer(msg, payload);
+    StringSink seq_sink(payload);
+    common::com::Encode(seq++, seq_sink);
+    EncodePacket(payload, sink);
+  }
+
+  template <typename MsgType>
+  static bool ReadTelemetry(SerialType& com, PacketDecoder& decoder,
+                            TelemetryStats& stats, MsgType& msg,
+                            bool blocking, uint32_t timeout_ms) {
+    if (!ReceivePacket(com, decoder, blocking, timeout_ms)) {
+      return false;
+    }
+    std::string& payload = decoder.Payload();
+    if (payload.size() < sizeof(uint16_t)) {
+      return false;
+    }
+    uint16_t seq{0};
+    size_t size = payload.size() - sizeof(uint16_t);
+    memcpy(&seq, payload.c_str() + size, sizeof(uint16_t));
+    payload.resize(size);
+    // A record that does not decode is not counted as received.
+    if (!DecodeFromTransfer(payload, msg)) {
+      return false;
+    }
+    stats.Update(seq);
+    return true;
+  }
+
+private:
+  inline static void SendPacket(SerialType& com, const std::string& payload) {
+    StreamSink<SerialType> sink(com);
+    EncodePacket(payload, sink);
+  }
+
+  // Feeds the decoder with what is in the RX buffer until a packet is
+  // complete. A partial packet is kept in the decoder for the next call.
+  static bool ReceivePacket(SerialType& com, PacketDecoder& decoder,
+                            bool blocking, uint32_t timeout_ms) {
+    uint32_t start = millis();
+    while (true) {
+      while (com.available()) {
+        if (decoder.Push(static_cast<uint8_t>(com.read()))) {
+          return true;
+        }
+      }
+      if (!blocking || (timeout_ms && millis() - start >= timeout_ms)) {
+        return false;
+      }
+      yield();
+    }
+  }
+
+  // Same framing as Write(): arithmetic types are sent raw, everything else
+  // is chunked. Returns the chunk size to use.
+  inline static uint16_t EncodeForTransfer(const std::string& msg,
+                                           std::string& data) {
+    data = msg;
+    return kChunkSize;
+  }
+
+  template <typename MsgType,
+      typename = std::enable_if_t<IsEncodible<MsgType>::value>>
+  inline static uint16_t EncodeForTransfer(const MsgType& msg,
+                                           std::string& data) {
+    common::com::Encode(msg, data);
+    return std::is_arithmetic<MsgType>::value ? 0 : kChunkSize;
+  }
+
+  // False when data does not decode, msg may then be partly written.
+  inline static bool DecodeFromTransfer(const std::string& data,
+                                        std::string& msg) {
+    msg = data;
+    return true;
+  }
+
+  template <typename MsgType,
+      typename = std::enable_if_t<IsEncodible<MsgType>::value>>
+  inline static bool DecodeFromTransfer(const std::string& data,
+                                        MsgType& msg) {
+    return common::com::Decode(data, msg);
+  }
 };
 
 }  // namespace internal
@@ -470,24 +1071,125 @@ public:
 
   template <typename MsgType>
   static void Write(const MsgType& msg, uint32_t timeout_ms = 0) {
-    internal::UARTComBase<SoftwareSerial>::Write(GetSerial(), msg, timeout_ms);
+    internal::UARTComBase<SoftwareSerial>::Write(
+        GetSerial(), msg, timeout_ms, &GetLinkState());
   }
 
   template <typename MsgType>
   static bool Read(MsgType& msg, bool blocking = false, bool drain = false,
                    uint32_t timeout_ms = 0) {
   return internal::UARTComBase<SoftwareSerial>::Read(
-      GetSerial(), msg, blocking, drain, timeout_ms);
+      GetSerial(), msg, blocking, drain, timeout_ms, &GetLinkState());
+  }
+
+  // Number of chunks kept in flight for chunked transfers, 1 disables the
+  // windowed mode. Effective only once the peer advertised a window too, and
+  // capped to the chunks that fit in the peer's RX buffer together.
+  static void SetWindowSize(uint8_t window) {
+    GetLinkState().window = window;
+  }
+
+  // CRC-16 protected chunks with selective retransmission, for noisy links.
+  // Blocking transfers only; used once both ends enabled it.
+  static void SetCrcFraming(bool enable) {
+    GetLinkState().crc = enable;
+  }
+
+  // Link parameters: the adapted chunk size (chunk_size) and the retry
+  // counters (last_retries, total_retries) can be read from here.
+  static LinkState& GetLinkState() {
+    static LinkState link{kWindowSize};
+    return link;
+  }
+
+  // Non-blocking variants of Write / Read. Only one transfer per port can be
+  // in progress, nullptr is returned while it is busy. Call Poll() from
+  // loop() until the returned transfer is no longer Busy().
+  template <typename MsgType>
+  static Transfer<SoftwareSerial> *BeginWrite(
+      const MsgType& msg, uint32_t timeout_ms = 0,
+      Transfer<SoftwareSerial>::Callback callback = nullptr) {
+    return internal::UARTComBase<SoftwareSerial>::BeginWrite(
+        GetSerial(), GetTransfer(), msg, timeout_ms, &GetLinkState(),
+        callback);
+  }
+
+  template <typename MsgType>
+  static Transfer<SoftwareSerial> *BeginRead(
+      uint32_t timeout_ms = 0,
+      Transfer<SoftwareSerial>::Callback callback = nullptr) {
+    return internal::UARTComBase<SoftwareSerial>::template BeginRead<MsgType>(
+        GetSerial(), GetTransfer(), timeout_ms, &GetLinkState(), callback);
+  }
+
+  static TransferStatus Poll() {
+    return GetTransfer().Poll();
+  }
+
+  // Packet mode, for fire-and-forget traffic: a reader that lost bytes or
+  // started mid-stream locks on at the next packet. Both ends have to use
+  // it, it does not mix with Write / Read on the same port.
+  template <typename MsgType>
+  static void WritePacket(const MsgType& msg) {
+    internal::UARTComBase<SoftwareSerial>::WritePacket(GetSerial(), msg);
+  }
+
+  template <typename MsgType>
+  static bool ReadPacket(MsgType& msg, bool blocking = false,
+                         uint32_t timeout_ms = 0) {
+    return internal::UARTComBase<SoftwareSerial>::ReadPacket(
+        GetSerial(), GetPacketDecoder(), msg, blocking, timeout_ms);
+  }
+
+  // Fire-and-forget streaming on top of the packet mode. Every record carries
+  // a sequence number so the reader can count what it missed in
+  // GetTelemetryStats(); the writer never waits for the reader.
+  template <typename MsgType>
+  static void WriteTelemetry(const MsgType& msg) {
+    internal::UARTComBase<SoftwareSerial>::WriteTelemetry(
+        GetSerial(), GetTelemetrySeq(), msg);
+  }
+
+  template <typename MsgType>
+  static bool ReadTelemetry(MsgType& msg, bool blocking = false,
+                            uint32_t timeout_ms = 0) {
+    return internal::UARTComBase<SoftwareSerial>::ReadTelemetry(
+        GetSerial(), GetPacketDecoder(), GetTelemetryStats(), msg, blocking,
+        timeout_ms);
+  }
+
+  static TelemetryStats& GetTelemetryStats() {
+    static TelemetryStats stats;
+    return stats;
   }
 
 private:
+  static PacketDecoder& GetPacketDecoder() {
+    static PacketDecoder decoder(kMaxPacketSize);
+    return decoder;
+  }
+
+  // One sequence for every record type written to the port, the reader
+  // counts gaps per port.
+  static uint16_t& GetTelemetrySeq() {
+    static uint16_t seq{0};
+    return seq;
+  }
+
+  static Transfer<SoftwareSerial>& GetTransfer() {
+    static Transfer<SoftwareSerial> transfer;
+    return transfer;
+  }
+
   static SoftwareSerial& GetSerial() {
     static SoftwareSerial serial(RX, TX);
     return serial;
   }
 };
 
-template <uint8_t SerialPort = 0>
+// TxBufferSize > 0 adds a ring buffer of that size used to coalesce writes,
+// see SetCoalescing().
+template <uint8_t SerialPort = 0, uint16_t TxBufferSize = 0>
 class HardwareCom final : public internal::UARTComBase<HardwareSerial> {
 public:
   static_assert(SerialPort <= 3, "Serial Port does not exist");
@@ -524,31 +1226,192 @@ public:
       }
       GetHardwareSerialPtr()->begin(baud_rate);
       while (!(*GetHardwareSerialPtr())) {}
+      if constexpr (TxBufferSize > 0) {
+        GetTxBuffer().Attach(*GetHardwareSerialPtr());
+      }
 
       return true;
     }();
     return status;
   }
 
+  // Arithmetic messages are queued when coalescing is enabled, everything
+  // else pushes the queued bytes out first to keep the order on the wire.
   template <typename MsgType>
   static void Write(const MsgType& msg, uint32_t timeout_ms = 0) {
+    if constexpr (TxBufferSize > 0 && std::is_arithmetic<MsgType>::value) {
+      if (GetTxBuffer().Enabled()) {
+        common::com::Encode(msg, GetTxBuffer());
+        GetTxBuffer().Poll();
+        return;
+      }
+    }
+    PushPending();
     internal::UARTComBase<HardwareSerial>::Write(
-        *GetHardwareSerialPtr(), msg, timeout_ms);
+        *GetHardwareSerialPtr(), msg, timeout_ms, &GetLinkState());
   }
 
   template <typename MsgType,
       typename = std::enable_if_t<std::is_arithmetic<MsgType>::value>>
   static bool Read(MsgType& msg, bool blocking = false, bool drain = false,
                    uint32_t timeout_ms = 0) {
+    PushPending();
     return internal::UARTComBase<HardwareSerial>::Read(
-        *GetHardwareSerialPtr(), msg, blocking, drain, timeout_ms);
+        *GetHardwareSerialPtr(), msg, blocking, drain, timeout_ms,
+        &GetLinkState());
+  }
+
+  // Number of chunks kept in flight for chunked transfers, 1 disables the
+  // windowed mode. Effective only once the peer advertised a window too, and
+  // capped to the chunks that fit in the peer's RX buffer together.
+  static void SetWindowSize(uint8_t window) {
+    GetLinkState().window = window;
+  }
+
+  // CRC-16 protected chunks with selective retransmission, for noisy links.
+  // Blocking transfers only; used once both ends enabled it.
+  static void SetCrcFraming(bool enable) {
+    GetLinkState().crc = enable;
+  }
+
+  // Link parameters: the adapted chunk size (chunk_size) and the retry
+  // counters (last_retries, total_retries) can be read from here.
+  static LinkState& GetLinkState() {
+    static LinkState link{kWindowSize};
+    return link;
+  }
+
+  // Non-blocking variants of Write / Read. Only one transfer per port can be
+  // in progress, nullptr is returned while it is busy. Call Poll() from
+  // loop() until the returned transfer is no longer Busy().
+  template <typename MsgType>
+  static Transfer<HardwareSerial> *BeginWrite(
+      const MsgType& msg, uint32_t timeout_ms = 0,
+      Transfer<HardwareSerial>::Callback callback = nullptr) {
+    PushPending();
+    return internal::UARTComBase<HardwareSerial>::BeginWrite(
+        *GetHardwareSerialPtr(), GetTransfer(), msg, timeout_ms,
+        &GetLinkState(), callback);
+  }
+
+  template <typename MsgType>
+  static Transfer<HardwareSerial> *BeginRead(
+      uint32_t timeout_ms = 0,
+      Transfer<HardwareSerial>::Callback callback = nullptr) {
+    PushPending();
+    return internal::UARTComBase<HardwareSerial>::template BeginRead<MsgType>(
+        *GetHardwareSerialPtr(), GetTransfer(), timeout_ms, &GetLinkState(),
+        callback);
+  }
+
+  // Also hands coalesced writes that are due to the UART.
+  static TransferStatus Poll() {
+    if constexpr (TxBufferSize > 0) {
+      GetTxBuffer().Poll();
+    }
+    return GetTransfer().Poll();
+  }
+
+  // Queued writes are handed to the UART once `threshold` bytes are pending
+  // or the oldest one waited `delay_ms` (checked on Write and Poll()).
+  // threshold 0 writes straight through again.
+  template <uint16_t N = TxBufferSize, typename = std::enable_if_t<(N > 0)>>
+  static void SetCoalescing(uint16_t threshold, uint32_t delay_ms) {
+    PushPending();
+    GetTxBuffer().Configure(threshold, delay_ms);
+  }
+
+  // Pushes the queued bytes out and waits until they are on the wire.
+  static void Flush() {
+    PushPending();
+    GetHardwareSerialPtr()->flush();
+  }
+
+  // Packet mode, for fire-and-forget traffic: a reader that lost bytes or
+  // started mid-stream locks on at the next packet. Both ends have to use
+  // it, it does not mix with Write / Read on the same port.
+  template <typename MsgType>
+  static void WritePacket(const MsgType& msg) {
+    PushPending();
+    internal::UARTComBase<HardwareSerial>::WritePacket(
+        *GetHardwareSerialPtr(), msg);
+  }
+
+  template <typename MsgType>
+  static bool ReadPacket(MsgType& msg, bool blocking = false,
+                         uint32_t timeout_ms = 0) {
+    return internal::UARTComBase<HardwareSerial>::ReadPacket(
+        *GetHardwareSerialPtr(), GetPacketDecoder(), msg, blocking,
+        timeout_ms);
+  }
+
+  // Fire-and-forget streaming on top of the packet mode. Every record carries
+  // a sequence number so the reader can count what it missed in
+  // GetTelemetryStats(); the writer never waits for the reader.
+  // Records are coalesced like arithmetic writes when enabled.
+  template <typename MsgType>
+  static void WriteTelemetry(const MsgType& msg) {
+    if constexpr (TxBufferSize > 0) {
+      if (GetTxBuffer().Enabled()) {
+        internal::UARTComBase<HardwareSerial>::EncodeTelemetry(
+            GetTxBuffer(), GetTelemetrySeq(), msg);
+        GetTxBuffer().Poll();
+        return;
+      }
+    }
+    internal::UARTComBase<HardwareSerial>::WriteTelemetry(
+        *GetHardwareSerialPtr(), GetTelemetrySeq(), msg);
+  }
+
+  template <typename MsgType>
+  static bool ReadTelemetry(MsgType& msg, bool blocking = false,
+                            uint32_t timeout_ms = 0) {
+    return internal::UARTComBase<HardwareSerial>::ReadTelemetry(
+        *GetHardwareSerialPtr(), GetPacketDecoder(), GetTelemetryStats(), msg,
+        blocking, timeout_ms);
+  }
+
+  static TelemetryStats& GetTelemetryStats() {
+    static TelemetryStats stats;
+    return stats;
   }
 
 private:
+  static PacketDecoder& GetPacketDecoder() {
+    static PacketDecoder decoder(kMaxPacketSize);
+    return decoder;
+  }
+
+  // One sequence for every record type written to the port, the reader
+  // counts gaps per port.
+  static uint16_t& GetTelemetrySeq() {
+    static uint16_t seq{0};
+    return seq;
+  }
+
+  static Transfer<HardwareSerial>& GetTransfer() {
+    static Transfer<HardwareSerial> transfer;
+    return transfer;
+  }
+
   static HardwareSerial*& GetHardwareSerialPtr() {
     static HardwareSerial* ptr;
     return ptr;
   }
+
+  using TxBufferType =
+      TxBuffer<HardwareSerial, (TxBufferSize > 0 ? TxBufferSize : 1)>;
+
+  static TxBufferType& GetTxBuffer() {
+    static TxBufferType buffer;
+    return buffer;
+  }
+
+  inline static void PushPending() {
+    if constexpr (TxBufferSize > 0) {
+      GetTxBuffer().Push();
+    }
+  }
 };
 
 }  // namespace UART
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace common::com {
+
+// CRC-16/CCITT-FALSE (polynomial 0x1021). Computed bit by bit, so no table is
+// kept in flash.
+PROGMEM constexpr uint16_t kCrc16Init = 0xFFFF;
+
+inline uint16_t Crc16Update(uint16_t crc, uint8_t data) {
+  crc ^= static_cast<uint16_t>(data) << 8;
+  for (uint8_t i{0}; i < 8; ++i) {
+    crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
+inline uint16_t Crc16(const char *data, size_t bytes,
+                      uint16_t crc = kCrc16Init) {
+  for (size_t i{0}; i < bytes; ++i) {
+    crc = Crc16Update(crc, static_cast<uint8_t>(data[i]));
+  }
+  return crc;
+}
+
+}  // namespace common::com
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <Arduino.h>
+
 namespace common::com {
 
 PROGMEM constexpr long kESP8266BaudRate = 115200;
@@ -13,4 +15,181 @@ PROGMEM constexpr long kBaudRate5 = 38400;
 PROGMEM constexpr long kBaudRate6 = 57600;
 PROGMEM constexpr long kBaudRate7 = 115200;
 
+// Chunked transfer protocol.
+PROGMEM constexpr uint8_t kStrMetadataSize = 8;
+PROGMEM constexpr uint8_t kMaxWindowSize = 8;
+
+// The high byte of the metadata chunk size holds the proposed window in its
+// low bits, kCrcFrames when the sender asks for CRC framed chunks and
+// kSizeQuery when it wants the receiver's free RX space after the ack.
+PROGMEM constexpr uint8_t kWindowMask = 0x0F;
+PROGMEM constexpr uint8_t kSizeQuery = 0x40;
+PROGMEM constexpr uint8_t kCrcFrames = 0x80;
+
+// Metadata acknowledgement: bits 0-1 are the status, high nibble is the
+// receiver's window. kSizeQueryCapable is set by receivers answering
+// kSizeQuery, kCrcCapable when the receiver accepted CRC framing. Legacy
+// senders ignore the metadata acknowledgement.
+PROGMEM constexpr uint8_t kStatusMask = 0x03;
+PROGMEM constexpr uint8_t kSizeQueryCapable = 0x04;
+PROGMEM constexpr uint8_t kCrcCapable = 0x08;
+PROGMEM constexpr uint8_t kWindowShift = 4;
+
+// A chunk has to fit in the receiver's RX buffer (Serial / SoftwareSerial).
+#if defined(SERIAL_RX_BUFFER_SIZE)
+PROGMEM constexpr uint16_t kRxBufferSize = SERIAL_RX_BUFFER_SIZE;
+#else
+PROGMEM constexpr uint16_t kRxBufferSize = 64;
+#endif
+// The ring keeps one slot free, this is what it holds.
+PROGMEM constexpr uint16_t kRxRingSize = kRxBufferSize - 1;
+
+// Adaptive chunk size: grows by kChunkSizeStep after a transfer without
+// retries and halves (down to kMinChunkSize) once more than 1 / kRetryRatio
+// of the chunks had to be resent.
+PROGMEM constexpr uint8_t kMinChunkSize = 8;
+PROGMEM constexpr uint8_t kChunkSizeStep = 8;
+PROGMEM constexpr uint8_t kRetryRatio = 4;
+
+// Windowed chunk acknowledgement: cumulative number of accepted chunks
+// modulo 128, with the top bit set when the next chunk has to be resent.
+PROGMEM constexpr uint8_t kAckCountMask = 0x7F;
+PROGMEM constexpr uint8_t kNack = 0x80;
+
+// CRC framed chunks: seq (u16) | frames left in the round (u8) | payload |
+// CRC-16 over everything before it. The receiver answers every round with
+// the bitmap of chunks it holds followed by its CRC-16. The sender confirms
+// the report holding every chunk with a lone header of seq kFinalAckSeq, no
+// chunk has that number.
+PROGMEM constexpr uint8_t kFrameHeaderSize = 3;
+PROGMEM constexpr uint16_t kFinalAckSeq = 0xFFFF;
+PROGMEM constexpr uint8_t kFrameCrcSize = 2;
+PROGMEM constexpr uint32_t kFrameTimeoutMs = 500;
+PROGMEM constexpr uint8_t kMaxFrameRetries = 5;
+// Quiet time that ends a report which failed its CRC, the rest of it may
+// still be on the line.
+PROGMEM constexpr uint32_t kReportResyncMs = 20;
+
+// Per-link transfer parameters shared by both ends of a chunked transfer.
+struct LinkState {
+  // Maximum number of chunks this side keeps in flight / accepts before an
+  // acknowledgement. 1 means stop-and-wait.
+  uint8_t window{1};
+  // Window advertised by the peer in its last metadata acknowledgement, 0 if
+  // the peer never advertised one (legacy firmware).
+  uint8_t peer_window{0};
+  // Whether this side uses / accepts CRC framed chunks, and whether the peer
+  // accepted them in its last metadata acknowledgement.
+  bool crc{false};
+  bool peer_crc{false};
+  // Whether the peer answers kSizeQuery, and the free RX space it reported.
+  bool peer_size_query{false};
+  uint8_t peer_rx_room{0};
+  // Chunk size picked for the next transfer, 0 until the first adaptation.
+  uint8_t chunk_size{0};
+  // Chunks resent during the last transfer and since startup.
+  uint16_t last_retries{0};
+  uint32_t total_retries{0};
+};
+
+// Receiver side bookkeeping of a telemetry stream (sequence numbered
+// packets without acknowledgement).
+struct TelemetryStats {
+  uint32_t received{0};
+  // Records missing between the received sequence numbers.
+  uint32_t lost{0};
+  uint16_t next_seq{0};
+
+  void Update(uint16_t seq) {
+    uint16_t gap = seq - next_seq;
+    // A jump backwards means the sender restarted, not a loss.
+    if (received && gap < 0x8000) {
+      lost += gap;
+    }
+    next_seq = seq + 1;
+    ++received;
+  }
+};
+
+// Window both sides agreed on, 0 when the transfer is stop-and-wait.
+inline uint8_t NegotiatedWindow(uint8_t proposed, uint8_t advertised) {
+  uint8_t window = proposed < advertised ? proposed : advertised;
+  if (window > kMaxWindowSize) {
+    window = kMaxWindowSize;
+  }
+  return window > 1 ? window : 0;
+}
+
+// Chunk size a sender uses on link, at most the peer's RX ring split across
+// the window the link negotiates (minus the frame overhead when chunks are
+// CRC framed), so a growing chunk never pushes a windowed link back to
+// stop-and-wait. Never below kMinChunkSize, the window shrinks instead.
+inline uint16_t ChunkSizeFor(const LinkState &link, uint16_t chunk_size,
+                             bool crc) {
+  if (link.chunk_size) {
+    chunk_size = link.chunk_size;
+  }
+  // A report larger than our own RX ring is not trusted, both ends usually
+  // run the same core. One too small for a minimum chunk is a busy moment,
+  // the ring is the limit then.
+  uint8_t overhead = crc ? kFrameHeaderSize + kFrameCrcSize : 0;
+  uint16_t room = link.peer_rx_room > overhead + kMinChunkSize &&
+                  link.peer_rx_room < kRxRingSize ? link.peer_rx_room :
+                                                    kRxRingSize;
+  uint16_t limit = room - overhead;
+  if (uint8_t window = NegotiatedWindow(link.window, link.peer_window)) {
+    uint16_t share = room / window;
+    limit = share >= overhead + kMinChunkSize ? share - overhead :
+                                                kMinChunkSize;
+  }
+  if (chunk_size > limit) {
+    chunk_size = limit;
+  }
+  return chunk_size;
+}
+
+// Records the retries of a finished transfer and adapts the chunk size.
+inline void AdaptChunkSize(LinkState &link, uint16_t chunk_size,
+                           uint16_t num_chunk, uint16_t retries, bool crc) {
+  link.last_retries = retries;
+  link.total_retries += retries;
+  if (!retries) {
+    chunk_size += kChunkSizeStep;
+  } else if (retries * kRetryRatio > num_chunk) {
+    chunk_size /= 2;
+  }
+  if (chunk_size < kMinChunkSize) {
+    chunk_size = kMinChunkSize;
+  } else if (chunk_size > std::numeric_limits<uint8_t>::max()) {
+    chunk_size = std::numeric_limits<uint8_t>::max();
+  }
+  link.chunk_size = chunk_size;
+  link.chunk_size = ChunkSizeFor(link, chunk_size, crc);
+}
+
+// Free RX space a receiver reports for kSizeQuery.
+template <typename ComType>
+uint8_t FreeRxRoom(ComType &com) {
+  size_t available = com.available();
+  size_t room = available < kRxRingSize ? kRxRingSize - available : 0;
+  return room > std::numeric_limits<uint8_t>::max() ?
+      std::numeric_limits<uint8_t>::max() : room;
+}
+
+// Free RX space of the peer: what it reported last, the whole ring until it
+// did.
+inline uint16_t PeerRxRoom(const LinkState &link) {
+  return link.peer_rx_room && link.peer_rx_room < kRxRingSize ?
+      link.peer_rx_room : kRxRingSize;
+}
+
+// Largest window not above `window` whose frames of frame_size bytes all fit
+// in room bytes. A receiver that is busy while a window arrives only reads it
+// from its RX buffer afterwards, anything that did not fit is lost.
+inline uint8_t WindowForRoom(uint8_t window, uint16_t frame_size,
+                             uint16_t room) {
+  uint16_t fit = room / frame_size;
+  return fit < window ? fit : window;
+}
+
 }  // namespace common::com
@@ -0,0 +1,304 @@
+#pragma once
+
+#include "common/com/specialized_encoding.h"
+
+namespace common::com {
+
+// Most significant bit first bit packing on top of a sink / span.
+class BitWriter {
+public:
+  // Writes the `count` low bits of bits.
+  template <typename Bits, typename Sink>
+  void Write(Bits bits, uint8_t count, Sink &sink) {
+    while (count) {
+      uint8_t take = 8 - used_ < count ? 8 - used_ : count;
+      count -= take;
+      uint8_t chunk = static_cast<uint8_t>(bits >> count) & ((1 << take) - 1);
+      byte_ |= chunk << (8 - used_ - take);
+      used_ += take;
+      if (used_ == 8) {
+        sink.Write(reinterpret_cast<const char *>(&byte_), 1);
+        byte_ = 0;
+        used_ = 0;
+      }
+    }
+  }
+
+  // Writes out the last partial byte, zero padded.
+  template <typename Sink>
+  void Flush(Sink &sink) {
+    if (used_) {
+      sink.Write(reinterpret_cast<const char *>(&byte_), 1);
+      byte_ = 0;
+      used_ = 0;
+    }
+  }
+
+private:
+  uint8_t byte_{0};
+  uint8_t used_{0};
+};
+
+class BitReader {
+public:
+  explicit BitReader(ByteSpan &span) : span_{span} {}
+
+  template <typename Bits>
+  bool Read(uint8_t count, Bits &bits) {
+    bits = 0;
+    while (count) {
+      if (!left_) {
+        if (!span_.Read(&byte_, 1)) {
+          return false;
+        }
+        left_ = 8;
+      }
+      uint8_t take = left_ < count ? left_ : count;
+      left_ -= take;
+      count -= take;
+      bits = static_cast<Bits>(bits << take) |
+             ((byte_ >> left_) & ((1 << take) - 1));
+    }
+    return true;
+  }
+
+private:
+  ByteSpan &span_;
+  uint8_t byte_{0};
+  uint8_t left_{0};
+};
+
+namespace detail {
+
+template <typename T>
+inline uint8_t LeadingZeros(T x) {
+  if constexpr (sizeof(T) <= sizeof(unsigned)) {
+    return __builtin_clz(x) - (sizeof(unsigned) - sizeof(T)) * 8;
+  } else if constexpr (sizeof(T) <= sizeof(unsigned long)) {
+    return __builtin_clzl(x) - (sizeof(unsigned long) - sizeof(T)) * 8;
+  } else {
+    return __builtin_clzll(x);
+  }
+}
+
+template <typename T>
+inline uint8_t TrailingZeros(T x) {
+  if constexpr (sizeof(T) <= sizeof(unsigned)) {
+    return __builtin_ctz(x);
+  } else if constexpr (sizeof(T) <= sizeof(unsigned long)) {
+    return __builtin_ctzl(x);
+  } else {
+    return __builtin_ctzll(x);
+  }
+}
+
+}  // namespace detail
+
+// Gorilla time series compression (Pelkonen et al., VLDB 2015): timestamps
+// as delta of delta, values XORed with the previous one so a slowly changing
+// reading takes a few bits per sample. Times are whole seconds, values
+// doubles (32 bit on AVR, so streams are only portable between platforms
+// with the same double).
+//
+// Timestamp, after the first 32 bit one, by delta of delta:
+//   0 | 10 + 7 bits | 110 + 9 bits | 1110 + 12 bits | 1111 + 32 bits
+// Value, after the first raw one, by XOR with the previous:
+//   0 (same) | 10 + bits within the previous window |
+//   11 + 5 bits leading zeros + 6 bits length + bits
+struct Gorilla {
+  using ValueBits =
+      std::conditional_t<sizeof(double) == 8, uint64_t, uint32_t>;
+  static constexpr uint8_t kValueBits = sizeof(ValueBits) * 8;
+  static constexpr uint8_t kMaxLeadingZeros = 31;
+  static constexpr uint8_t kNoWindow = 0xFF;
+
+  struct Bucket {
+    uint8_t prefix;
+    uint8_t prefix_bits;
+    uint8_t value_bits;
+  };
+  static constexpr Bucket kBuckets[] = {
+      {0b10, 2, 7}, {0b110, 3, 9}, {0b1110, 4, 12}, {0b1111, 4, 32}};
+};
+
+class GorillaEncoder {
+public:
+  template <typename Sink>
+  void Append(uint32_t sec, double value, Sink &sink) {
+    Gorilla::ValueBits bits;
+    memcpy(&bits, &value, sizeof(bits));
+    if (!count_) {
+      writer_.Write(sec, 32, sink);
+      writer_.Write(bits, Gorilla::kValueBits, sink);
+    } else {
+      AppendTime(sec, sink);
+      AppendValue(bits, sink);
+    }
+    prev_sec_ = sec;
+    prev_value_ = bits;
+    ++count_;
+  }
+
+  // Completes the stream, Reset() before appending again.
+  template <typename Sink>
+  inline void Finish(Sink &sink) {
+    writer_.Flush(sink);
+  }
+
+  inline void Reset() {
+    *this = GorillaEncoder();
+  }
+
+  inline uint32_t Count() const {
+    return count_;
+  }
+
+private:
+  template <typename Sink>
+  void AppendTime(uint32_t sec, Sink &sink) {
+    uint32_t delta = sec - prev_sec_;
+    int32_t dod = static_cast<int32_t>(delta - prev_delta_);
+    prev_delta_ = delta;
+    if (!dod) {
+      writer_.Write(0, 1, sink);
+      return;
+    }
+    for (const auto &bucket : Gorilla::kBuckets) {
+      int32_t limit = bucket.value_bits < 32 ?
+          static_cast<int32_t>(1) << (bucket.value_bits - 1) : 0;
+      if (!limit || (dod >= -limit && dod < limit)) {
+        writer_.Write(bucket.prefix, bucket.prefix_bits, sink);
+        writer_.Write(static_cast<uint32_t>(dod), bucket.value_bits, sink);
+        return;
+      }
+    }
+  }
+
+  template <typename Sink>
+  void AppendValue(Gorilla::ValueBits bits, Sink &sink) {
+    Gorilla::ValueBits x = bits ^ prev_value_;
+    if (!x) {
+      writer_.Write(0, 1, sink);
+      return;
+    }
+    uint8_t leading = detail::LeadingZeros(x);
+    uint8_t trailing = detail::TrailingZeros(x);
+    if (leading > Gorilla::kMaxLeadingZeros) {
+      leading = Gorilla::kMaxLeadingZeros;
+    }
+    if (leading_ != Gorilla::kNoWindow && leading >= leading_ &&
+        trailing >= trailing_) {
+      writer_.Write(0b10, 2, sink);
+      writer_.Write(x >> trailing_,
+                    Gorilla::kValueBits - leading_ - trailing_, sink);
+      return;
+    }
+    uint8_t length = Gorilla::kValueBits - leading - trailing;
+    writer_.Write(0b11, 2, sink);
+    writer_.Write(leading, 5, sink);
+    // 64 does not fit in 6 bits, it is stored as 0.
+    writer_.Write(length & 0x3F, 6, sink);
+    writer_.Write(x >> trailing, length, sink);
+    leading_ = leading;
+    trailing_ = trailing;
+  }
+
+  BitWriter writer_{};
+  Gorilla::ValueBits prev_value_{0};
+  uint32_t prev_sec_{0};
+  uint32_t prev_delta_{0};
+  uint32_t count_{0};
+  uint8_t leading_{Gorilla::kNoWindow};
+  uint8_t trailing_{0};
+};
+
+// Reads back the samples of a GorillaEncoder stream, the number of samples
+// is up to the container.
+class GorillaDecoder {
+public:
+  explicit GorillaDecoder(ByteSpan &span) : reader_{span} {}
+
+  bool Next(uint32_t &sec, double &value) {
+    bool ok = first_ ? reader_.Read(32, prev_sec_) &&
+                       reader_.Read(Gorilla::kValueBits, prev_value_)
+                     : NextTime() && NextValue();
+    if (!ok) {
+      return false;
+    }
+    first_ = false;
+    sec = prev_sec_;
+    memcpy(&value, &prev_value_, sizeof(value));
+    return true;
+  }
+
+private:
+  bool NextTime() {
+    uint8_t ones{0};
+    uint8_t bit{1};
+    while (ones < 4) {
+      if (!reader_.Read(1, bit)) {
+        return false;
+      }
+      if (!bit) {
+        break;
+      }
+      ++ones;
+    }
+    if (ones) {
+      uint8_t bits = Gorilla::kBuckets[ones - 1].value_bits;
+      uint32_t raw;
+      if (!reader_.Read(bits, raw)) {
+        return false;
+      }
+      // Sign extend.
+      if (bits < 32 && (raw & (static_cast<uint32_t>(1) << (bits - 1)))) {
+        raw |= ~((static_cast<uint32_t>(1) << bits) - 1);
+      }
+      prev_delta_ += raw;
+    }
+    prev_sec_ += prev_delta_;
+    return true;
+  }
+
+  bool NextValue() {
+    uint8_t bit;
+    if (!reader_.Read(1, bit)) {
+      return false;
+    }
+    if (!bit) {
+      return true;
+    }
+    if (!reader_.Read(1, bit)) {
+      return false;
+    }
+    if (bit) {
+      uint8_t length;
+      if (!reader_.Read(5, leading_) || !reader_.Read(6, length)) {
+        return false;
+      }
+      length = length ? length : 64;
+      if (leading_ + length > Gorilla::kValueBits) {
+        return false;
+      }
+      trailing_ = Gorilla::kValueBits - leading_ - length;
+    } else if (leading_ == Gorilla::kNoWindow) {
+      return false;
+    }
+    Gorilla::ValueBits x;
+    if (!reader_.Read(Gorilla::kValueBits - leading_ - trailing_, x)) {
+      return false;
+    }
+    prev_value_ ^= x << trailing_;
+    return true;
+  }
+
+  BitReader reader_;
+  Gorilla::ValueBits prev_value_{0};
+  uint32_t prev_sec_{0};
+  uint32_t prev_delta_{0};
+  uint8_t leading_{Gorilla::kNoWindow};
+  uint8_t trailing_{0};
+  bool first_{true};
+};
+
+}  // namespace common::com
@@ -0,0 +1,396 @@
+#pragma once
+
+#include "common/com/specialized_encoding.h"
+#include "common/utility/variant.h"
+
+namespace common::com {
+
+// Declarative message layout. A message lists its fields once,
+//
+//   using Schema = common::com::Schema<
+//       common::com::Field<&Msg::id>,
+//       common::com::Field<&Msg::level, uint8_t>,
+//       common::com::Field<&Msg::name>>;
+//
+// and Encode / Decode, the minimum size and the field offsets are generated
+// from it. IsEncodible picks such types up without hand written methods, the
+// integer encoding follows the type's EncodingPolicy. MessageView reads
+// single fields straight from the encoded bytes.
+
+// Per type codecs. kSize is the encoded size under FixedEncoding (the length
+// prefix for strings), kFixedLayout whether that size holds for any value.
+// Codecs of owning types also provide a ViewType read by View(), the others
+// are viewed by value.
+template <typename Type, typename = void>
+struct FieldCodec;
+
+template <typename Type>
+struct FieldCodec<Type, std::enable_if_t<std::is_arithmetic<Type>::value>> {
+  static constexpr size_t kSize = sizeof(Type);
+  static constexpr bool kFixedLayout = true;
+
+  template <typename Policy, typename Sink>
+  static inline void Encode(const Type &value, Sink &sink) {
+    if constexpr (std::is_integral<Type>::value) {
+      Policy::EncodeInt(value, sink);
+    } else {
+      common::com::Encode(value, sink);
+    }
+  }
+
+  template <typename Policy>
+  static inline bool Decode(ByteSpan &span, Type &value) {
+    if constexpr (std::is_integral<Type>::value) {
+      return Policy::DecodeInt(span, value);
+    } else {
+      return common::com::Decode(span, value);
+    }
+  }
+};
+
+template <>
+struct FieldCodec<std::string> {
+  static constexpr size_t kSize = sizeof(uint32_t);
+  static constexpr bool kFixedLayout = false;
+
+  template <typename Policy, typename Sink>
+  static inline void Encode(const std::string &value, Sink &sink) {
+    EncodeString<Policy>(value, sink);
+  }
+
+  template <typename Policy>
+  static inline bool Decode(ByteSpan &span, std::string &value) {
+    return DecodeString<Policy>(span, value);
+  }
+
+  using ViewType = StringView;
+
+  template <typename Policy>
+  static bool View(ByteSpan &span, StringView &value) {
+    uint32_t size{0};
+    if (!Policy::DecodeInt(span, size)) {
+      return false;
+    }
+    const char *ptr = span.Consume(size);
+    if (!ptr) {
+      return false;
+    }
+    value = StringView(ptr, size);
+    return true;
+  }
+};
+
+// Variants of arithmetic types: a tag (0 when empty, index + 1 otherwise)
+// followed by the value, zero padded to the largest alternative under a
+// fixed size policy.
+template <typename... Types>
+struct FieldCodec<Variant<Types...>> {
+  static_assert((std::is_arithmetic<Types>::value && ...),
+                "only arithmetic alternatives are supported");
+
+  static constexpr size_t kSlotSize =
+      common::type_traits::MaxSizeOf<Types...>::value;
+  static constexpr size_t kSize = sizeof(uint8_t) + kSlotSize;
+  static constexpr bool kFixedLayout = true;
+
+  template <typename Policy, typename Sink>
+  static void Encode(const Variant<Types...> &value, Sink &sink) {
+    common::com::Encode(static_cast<uint8_t>(
+        value.Index() < sizeof...(Types) ? value.Index() + 1 : 0), sink);
+    if constexpr (Policy::kFixedSize) {
+      char slot[kSlotSize] = {0};
+      common::Visit([&slot](const auto &alternative) {
+        memcpy(slot, &alternative, sizeof(alternative));
+      }, value);
+      sink.Write(slot, sizeof(slot));
+    } else {
+      common::Visit([&sink](const auto &alternative) {
+        FieldCodec<std::decay_t<decltype(alternative)>>::template Encode<
+            Policy>(alternative, sink);
+      }, value);
+    }
+  }
+
+  // An unknown tag leaves the variant empty. It fails the decode under a
+  // variable size policy, where the bytes of the value cannot be skipped.
+  template <typename Policy>
+  static bool Decode(ByteSpan &span, Variant<Types...> &value) {
+    uint8_t tag{0};
+    if (!common::com::Decode(span, tag)) {
+      return false;
+    }
+    value = Variant<Types...>();
+    if constexpr (Policy::kFixedSize) {
+      const char *slot = span.Consume(kSlotSize);
+      if (slot) {
+        DecodeSlot<0, Types...>(tag, slot, value);
+      }
+      return slot;
+    } else {
+      return DecodeAlternative<Policy, 0, Types...>(tag, span, value);
+    }
+  }
+
+private:
+  template <size_t Index, typename T, typename... Rest>
+  static void DecodeSlot(uint8_t tag, const char *slot,
+                         Variant<Types...> &value) {
+    if (tag == Index + 1) {
+      T alternative;
+      memcpy(&alternative, slot, sizeof(alternative));
+      value.template Emplace<T>(alternative);
+    } else if constexpr (sizeof...(Rest) > 0) {
+      DecodeSlot<Index + 1, Rest...>(tag, slot, value);
+    }
+  }
+
+  template <typename Policy, size_t Index, typename T, typename... Rest>
+  static bool DecodeAlternative(uint8_t tag, ByteSpan &span,
+                                Variant<Types...> &value) {
+    if (tag == Index + 1) {
+      T alternative;
+      if (!FieldCodec<T>::template Decode<Policy>(span, alternative)) {
+        return false;
+      }
+      value.template Emplace<T>(alternative);
+      return true;
+    } else if constexpr (sizeof...(Rest) > 0) {
+      return DecodeAlternative<Policy, Index + 1, Rest...>(tag, span, value);
+    }
+    // Without a slot the size of an unknown alternative is not known either,
+    // nothing after it can be read.
+    return !tag;
+  }
+};
+
+namespace detail {
+
+template <typename T>
+struct MemberPointerTraits;
+
+template <typename Class, typename Type>
+struct MemberPointerTraits<Type Class::*> {
+  using ClassType = Class;
+  using MemberType = Type;
+};
+
+template <typename Codec, typename Type, typename = void>
+struct CodecView : std::false_type {
+  using type = Type;
+};
+
+template <typename Codec, typename Type>
+struct CodecView<Codec, Type,
+                 common::type_traits::detail::void_t<typename Codec::ViewType>>
+    : std::true_type {
+  using type = typename Codec::ViewType;
+};
+
+}  // namespace detail
+
+// A message member, encoded as WireType (e.g. an enum as its wire integer).
+template <auto Member,
+          typename WireType = typename detail::MemberPointerTraits<
+              decltype(Member)>::MemberType>
+struct Field {
+  using MemberType =
+      typename detail::MemberPointerTraits<decltype(Member)>::MemberType;
+  using Codec = FieldCodec<WireType>;
+
+  static constexpr size_t kSize = Codec::kSize;
+  static constexpr bool kFixedLayout = Codec::kFixedLayout;
+
+  // What MessageView returns for the field.
+  using ViewType = std::conditional_t<
+      std::is_same<MemberType, WireType>::value,
+      typename detail::CodecView<Codec, WireType>::type, MemberType>;
+
+  template <typename Policy, typename Class, typename Sink>
+  static inline void Encode(const Class &msg, Sink &sink) {
+    if constexpr (std::is_same<MemberType, WireType>::value) {
+      Codec::template Encode<Policy>(msg.*Member, sink);
+    } else {
+      Codec::template Encode<Policy>(static_cast<WireType>(msg.*Member), sink);
+    }
+  }
+
+  template <typename Policy, typename Class>
+  static inline bool Decode(ByteSpan &span, Class &msg) {
+    if constexpr (std::is_same<MemberType, WireType>::value) {
+      return Codec::template Decode<Policy>(span, msg.*Member);
+    } else {
+      WireType value{};
+      if (!Codec::template Decode<Policy>(span, value)) {
+        return false;
+      }
+      msg.*Member = static_cast<MemberType>(value);
+      return true;
+    }
+  }
+
+  template <typename Policy>
+  static inline bool View(ByteSpan &span, ViewType &value) {
+    if constexpr (detail::CodecView<Codec, WireType>::value &&
+                  std::is_same<MemberType, WireType>::value) {
+      return Codec::template View<Policy>(span, value);
+    } else if constexpr (std::is_same<MemberType, WireType>::value) {
+      return Codec::template Decode<Policy>(span, value);
+    } else {
+      WireType wire{};
+      if (!Codec::template Decode<Policy>(span, wire)) {
+        return false;
+      }
+      value = static_cast<MemberType>(wire);
+      return true;
+    }
+  }
+
+  // Moves span past the field without reading it when its size is known.
+  template <typename Policy>
+  static inline bool Skip(ByteSpan &span) {
+    if constexpr (Policy::kFixedSize && kFixedLayout) {
+      return span.Consume(kSize);
+    } else {
+      ViewType value{};
+      return View<Policy>(span, value);
+    }
+  }
+
+  template <auto Other>
+  static constexpr bool Is() {
+    if constexpr (std::is_same<decltype(Other), decltype(Member)>::value) {
+      return Other == Member;
+    } else {
+      return false;
+    }
+  }
+};
+
+template <typename... Fields>
+struct Schema {
+  static constexpr size_t kNumFields = sizeof...(Fields);
+  // Encoded size under FixedEncoding with every string empty.
+  static constexpr size_t kMinSize = (Fields::kSize + ... + 0);
+  static constexpr bool kFixedLayout = (Fields::kFixedLayout && ... && true);
+
+  template <size_t Index>
+  using FieldAt = typename common::type_traits::VariadicTypeTraits<
+      Fields...>::template type<Index>;
+
+  // Position of the field declared for Member.
+  template <auto Member>
+  static constexpr size_t IndexOf() {
+    constexpr bool kMatches[] = {Fields::template Is<Member>()...};
+    for (size_t i{0}; i < kNumFields; ++i) {
+      if (kMatches[i]) {
+        return i;
+      }
+    }
+    return kNumFields;
+  }
+
+  // Offset of field Index under FixedEncoding. Only defined while every
+  // field before it has a fixed layout.
+  template <size_t Index>
+  static constexpr size_t Offset() {
+    static_assert(Index < kNumFields, "no such field");
+    static_assert(FixedPrefix(Index),
+                  "offset depends on an earlier variable size field");
+    constexpr size_t kSizes[] = {Fields::kSize...};
+    size_t offset{0};
+    for (size_t i{0}; i < Index; ++i) {
+      offset += kSizes[i];
+    }
+    return offset;
+  }
+
+  template <typename Policy, typename Class, typename Sink>
+  static inline void Encode(const Class &msg, Sink &sink) {
+    (Fields::template Encode<Policy>(msg, sink), ...);
+  }
+
+  // Stops at the first field that fails.
+  template <typename Policy, typename Class>
+  static inline bool Decode(ByteSpan &span, Class &msg) {
+    return (Fields::template Decode<Policy>(span, msg) && ...);
+  }
+
+private:
+  static constexpr bool FixedPrefix(size_t index) {
+    constexpr bool kFixed[] = {Fields::kFixedLayout...};
+    for (size_t i{0}; i < index; ++i) {
+      if (!kFixed[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+// Read-only, random access view of an encoded message. The constructor walks
+// the bytes once and records where every field starts, Get() then reads a
+// single field, strings as StringView into the buffer, so filtering on a few
+// fields neither copies nor allocates.
+template <typename MsgType>
+class MessageView {
+private:
+  using Schema = typename MsgType::Schema;
+  using Policy = typename EncodingPolicyOf<MsgType>::type;
+
+public:
+  MessageView(const char *data, size_t size) : data_{data}, size_{size} {
+    Scan(std::make_index_sequence<Schema::kNumFields>{});
+  }
+
+  explicit MessageView(const std::string &data)
+      : MessageView(data.c_str(), data.size()) {}
+  // The view points into the bytes, they have to outlive it.
+  explicit MessageView(std::string &&data) = delete;
+
+  // Value (or view) of Member, default constructed if the bytes are bad.
+  template <auto Member>
+  inline auto Get() const {
+    constexpr size_t kIndex = Schema::template IndexOf<Member>();
+    static_assert(kIndex < Schema::kNumFields, "not a field of the schema");
+    return At<kIndex>();
+  }
+
+  template <size_t Index>
+  typename Schema::template FieldAt<Index>::ViewType At() const {
+    using FieldType = typename Schema::template FieldAt<Index>;
+    typename FieldType::ViewType value{};
+    if (ok_) {
+      ByteSpan span(data_ + offsets_[Index], size_ - offsets_[Index]);
+      FieldType::template View<Policy>(span, value);
+    }
+    return value;
+  }
+
+  // Whether the bytes hold a complete message.
+  inline bool Ok() const {
+    return ok_;
+  }
+
+  // Encoded size of the message, the bytes may continue past it.
+  inline size_t Size() const {
+    return end_;
+  }
+
+private:
+  template <size_t... Indices>
+  void Scan(std::index_sequence<Indices...>) {
+    ByteSpan span(data_, size_);
+    ok_ = ((offsets_[Indices] = size_ - span.Remaining(),
+            Schema::template FieldAt<Indices>::template Skip<Policy>(span)) &&
+           ...);
+    end_ = ok_ ? size_ - span.Remaining() : 0;
+  }
+
+  const char *data_;
+  size_t size_;
+  size_t end_{0};
+  size_t offsets_[Schema::kNumFields]{};
+  bool ok_{false};
+};
+
+}  // namespace common::com
@@ -1,10 +1,295 @@
 #pragma once
 
+#include <string.h>
+
 #include "common/stl/string.h"
 #include "common/type_traits/type_traits.h"
 
+// All specialized encoding methods should be put in namespace std for ADL.
+namespace std {
+
+template<typename Type,
+    typename = std::enable_if_t<std::is_arithmetic<Type>::value>>
+inline void StringTranslate(const Type &num, std::string &data) {
+  const char *ptr = (const char *) &num;
+  data.resize(sizeof(num));
+  for (uint32_t i{0}; i < sizeof(num); i++) {
+    data[i] = ptr[i];
+  }
+}
+
+template<typename Type,
+    typename = std::enable_if_t<std::is_arithmetic<Type>::value>>
+inline void StringTranslate(const std::string &data, Type &num) {
+  char *ptr = (char *) &num;
+  for (uint32_t i{0}; i < sizeof(num); i++) {
+    ptr[i] = data[i];
+  }
+}
+
+}  // namespace std
+
 namespace common::com {
 
+// Sinks receive encoded bytes. Any type with Write(const char *, size_t) can
+// be passed to the sink based Encode(const T &, Sink &).
+
+// Counts the bytes without storing them, used to size buffers and headers.
+class CountingSink {
+public:
+  inline void Write(const char *, size_t bytes) {
+    size_ += bytes;
+  }
+
+  inline size_t Size() const {
+    return size_;
+  }
+
+private:
+  size_t size_{0};
+};
+
+// Appends to a std::string, for callers still using the string interface.
+class StringSink {
+public:
+  explicit StringSink(std::string &str) : str_{str} {}
+
+  inline void Write(const char *data, size_t bytes) {
+    str_.append(data, bytes);
+  }
+
+private:
+  std::string &str_;
+};
+
+// Writes into a caller-provided fixed buffer. Bytes beyond the capacity are
+// dropped and reported through Overflow().
+class BufferSink {
+public:
+  BufferSink(char *data, size_t capacity)
+      : data_{data}, capacity_{capacity} {}
+
+  inline void Write(const char *data, size_t bytes) {
+    if (bytes > capacity_ - size_) {
+      overflow_ = true;
+      bytes = capacity_ - size_;
+    }
+    memcpy(data_ + size_, data, bytes);
+    size_ += bytes;
+  }
+
+  inline size_t Size() const {
+    return size_;
+  }
+
+  inline bool Overflow() const {
+    return overflow_;
+  }
+
+private:
+  char *data_;
+  size_t capacity_;
+  size_t size_{0};
+  bool overflow_{false};
+};
+
+// Writes straight into the TX buffer of a Stream (Serial, SoftwareSerial,
+// Wire, ...).
+template <typename ComType>
+class StreamSink {
+public:
+  explicit StreamSink(ComType &com) : com_{com} {}
+
+  inline void Write(const char *data, size_t bytes) {
+    com_.write(reinterpret_cast<const uint8_t *>(data), bytes);
+  }
+
+private:
+  ComType &com_;
+};
+
+// Read-only cursor over encoded bytes. Decoding from a span never copies the
+// underlying buffer; a read past the end fails and marks the span as bad.
+class ByteSpan {
+public:
+  ByteSpan(const char *data, size_t size) : data_{data}, size_{size} {}
+
+  explicit ByteSpan(const std::string &data)
+      : data_{data.c_str()}, size_{data.size()} {}
+
+  bool Read(void *out, size_t bytes) {
+    const char *ptr = Consume(bytes);
+    if (ptr) {
+      memcpy(out, ptr, bytes);
+    }
+    return ptr;
+  }
+
+  // Returns a pointer to the next `bytes` bytes and skips them.
+  const char *Consume(size_t bytes) {
+    if (!ok_ || bytes > size_ - pos_) {
+      ok_ = false;
+      return nullptr;
+    }
+    const char *ptr = data_ + pos_;
+    pos_ += bytes;
+    return ptr;
+  }
+
+  inline size_t Remaining() const {
+    return size_ - pos_;
+  }
+
+  inline bool Ok() const {
+    return ok_;
+  }
+
+  // Marks the span as bad, for decoders rejecting well sized but invalid
+  // content.
+  inline void Fail() {
+    ok_ = false;
+  }
+
+private:
+  const char *data_;
+  size_t size_;
+  size_t pos_{0};
+  bool ok_{true};
+};
+
+// Non-owning view of characters inside an encoded buffer, valid as long as
+// the buffer is.
+class StringView {
+public:
+  StringView() = default;
+  StringView(const char *data, size_t size) : data_{data}, size_{size} {}
+
+  inline const char *Data() const {
+    return data_;
+  }
+
+  inline size_t Size() const {
+    return size_;
+  }
+
+  inline std::string ToString() const {
+    return std::string(data_, size_);
+  }
+
+  bool operator==(const char *str) const {
+    return strlen(str) == size_ && !memcmp(str, data_, size_);
+  }
+
+  bool operator==(const std::string &str) const {
+    return str.size() == size_ && !memcmp(str.c_str(), data_, size_);
+  }
+
+  template <typename T>
+  inline bool operator!=(const T &other) const {
+    return !(*this == other);
+  }
+
+private:
+  const char *data_{nullptr};
+  size_t size_{0};
+};
+
+// Encoding policies for integers, chosen per message type at compile time
+// (see EncodingPolicyOf). FixedEncoding copies sizeof(T) bytes as
+// StringTranslate does. CompactEncoding writes integers wider than a byte as
+// LEB128 varints, zigzag mapped when signed, so values under 128 take a
+// single byte.
+struct FixedEncoding {
+  static constexpr bool kFixedSize = true;
+
+  template <typename Type, typename Sink>
+  static inline void EncodeInt(const Type &value, Sink &sink) {
+    sink.Write(reinterpret_cast<const char *>(&value), sizeof(value));
+  }
+
+  template <typename Type>
+  static inline bool DecodeInt(ByteSpan &span, Type &value) {
+    return span.Read(&value, sizeof(value));
+  }
+};
+
+struct CompactEncoding {
+  static constexpr bool kFixedSize = false;
+
+  template <typename Type, typename Sink>
+  static void EncodeInt(const Type &value, Sink &sink) {
+    static_assert(std::is_integral<Type>::value, "integers only");
+    if constexpr (sizeof(Type) == 1) {
+      FixedEncoding::EncodeInt(value, sink);
+    } else {
+      using Unsigned = std::make_unsigned_t<Type>;
+      Unsigned bits = static_cast<Unsigned>(value);
+      if constexpr (std::is_signed<Type>::value) {
+        bits = static_cast<Unsigned>(bits << 1) ^
+               static_cast<Unsigned>(value >> (sizeof(Type) * 8 - 1));
+      }
+      char buffer[(sizeof(Type) * 8 + 6) / 7];
+      uint8_t size{0};
+      do {
+        uint8_t byte = bits & 0x7F;
+        bits >>= 7;
+        buffer[size++] = static_cast<char>(bits ? byte | 0x80 : byte);
+      } while (bits);
+      sink.Write(buffer, size);
+    }
+  }
+
+  // Fails on a truncated or overlong varint, and on one carrying bits the
+  // type does not have.
+  template <typename Type>
+  static bool DecodeInt(ByteSpan &span, Type &value) {
+    static_assert(std::is_integral<Type>::value, "integers only");
+    if constexpr (sizeof(Type) == 1) {
+      return FixedEncoding::DecodeInt(span, value);
+    } else {
+      using Unsigned = std::make_unsigned_t<Type>;
+      constexpr uint8_t kBits = sizeof(Type) * 8;
+      Unsigned bits{0};
+      for (uint8_t shift{0}; shift < kBits; shift += 7) {
+        uint8_t byte;
+        if (!span.Read(&byte, 1)) {
+          return false;
+        }
+        if (shift + 7 > kBits && (byte & 0x7F) >> (kBits - shift)) {
+          span.Fail();
+          return false;
+        }
+        bits |= static_cast<Unsigned>(static_cast<Unsigned>(byte & 0x7F)
+                                      << shift);
+        if (!(byte & 0x80)) {
+          if constexpr (std::is_signed<Type>::value) {
+            bits = (bits >> 1) ^ static_cast<Unsigned>(-(bits & 1));
+          }
+          value = static_cast<Type>(bits);
+          return true;
+        }
+      }
+      span.Fail();
+      return false;
+    }
+  }
+};
+
+// Message types opt in to a policy with `using EncodingPolicy = ...;`, the
+// default is FixedEncoding.
+template <typename T>
+class EncodingPolicyOf {
+private:
+  template <typename MsgType>
+  static FixedEncoding PolicyImpl(...);
+
+  template <typename MsgType>
+  static typename MsgType::EncodingPolicy PolicyImpl(int);
+
+public:
+  using type = decltype(PolicyImpl<std::decay_t<T>>(0));
+};
+
 template <typename T>
 class IsEncodible {
 private:
@@ -12,10 +297,28 @@ private:
   static std::false_type HasEncodingMethodImpl(...);
 
   template<typename MsgType,
-      typename = decltype(&MsgType::Encode),
-      typename = decltype(&MsgType::Decode)>
+      typename = decltype(std::declval<const MsgType &>().Encode(
+          std::declval<std::string &>())),
+      typename = decltype(std::declval<MsgType &>().Decode(
+          std::declval<const std::string &>()))>
   static std::true_type HasEncodingMethodImpl(int);
 
+  template<typename MsgType>
+  static std::false_type HasSinkEncodingMethodImpl(...);
+
+  template<typename MsgType,
+      typename = decltype(std::declval<const MsgType &>().Encode(
+          std::declval<CountingSink &>())),
+      typename = decltype(std::declval<MsgType &>().Decode(
+          std::declval<ByteSpan &>()))>
+  static std::true_type HasSinkEncodingMethodImpl(int);
+
+  template<typename MsgType>
+  static std::false_type HasSchemaImpl(...);
+
+  template<typename MsgType, typename = typename MsgType::Schema>
+  static std::true_type HasSchemaImpl(int);
+
   template<typename MsgType>
   static std::false_type HasEncodingFunctionImpl(...);
 
@@ -31,25 +334,62 @@ private:
 public:
   enum { has_encoding_function =
     decltype(HasEncodingFunctionImpl<std::decay_t<T>>(0))::value };
+  enum { has_schema = decltype(HasSchemaImpl<std::decay_t<T>>(0))::value };
+  // Types with a Schema (see schema.h) encode through it.
+  enum { has_sink_encoding_method =
+      decltype(HasSinkEncodingMethodImpl<std::decay_t<T>>(0))::value ||
+      has_schema };
   enum { has_encoding_method =
-      decltype(HasEncodingMethodImpl<std::decay_t<T>>(0))::value };
+      decltype(HasEncodingMethodImpl<std::decay_t<T>>(0))::value &&
+      !has_sink_encoding_method };
   enum { value =
-    has_encoding_function || has_encoding_method };
+    has_encoding_function || has_encoding_method || has_sink_encoding_method };
 };
 
 void Encode(...);
 void Decode(...);
 
+namespace detail {
+
+template <typename Type, typename Sink>
+inline void EncodeMessage(const Type &source, Sink &sink) {
+  if constexpr (IsEncodible<Type>::has_schema) {
+    Type::Schema::template Encode<typename EncodingPolicyOf<Type>::type>(
+        source, sink);
+  } else {
+    source.Encode(sink);
+  }
+}
+
+template <typename Type>
+inline bool DecodeMessage(ByteSpan &span, Type &source) {
+  if constexpr (IsEncodible<Type>::has_schema) {
+    return Type::Schema::template Decode<
+        typename EncodingPolicyOf<Type>::type>(span, source) && span.Ok();
+  } else {
+    source.Decode(span);
+    return span.Ok();
+  }
+}
+
+}  // namespace detail
+
 template <typename Type,
     typename = std::enable_if_t<IsEncodible<Type>::has_encoding_function>>
 inline void Encode(const Type &source, std::string &data) {
   StringTranslate(source, data);
 }
 
+// The string Decode() overloads return false when data is too short or
+// does not decode, types with only a string Decode() method cannot tell.
 template <typename Type,
     typename = std::enable_if_t<IsEncodible<Type>::has_encoding_function>>
-inline void Decode(const std::string &data, Type &source) {
+inline bool Decode(const std::string &data, Type &source) {
+  if (data.size() < sizeof(source)) {
+    return false;
+  }
   StringTranslate(data, source);
+  return true;
 }
 
 template <typename Type,
@@ -62,32 +402,88 @@ inline void Encode(const Type &source, std::string &data) {
 template <typename Type,
     typename = std::enable_if_t<IsEncodible<Type>::has_encoding_method>,
     typename = std::nullptr_t>
-inline void Decode(const std::string &data, Type &source) {
+inline bool Decode(const std::string &data, Type &source) {
   source.Decode(data);
+  return true;
 }
 
-} // namespace common::com
-
-// All specialized encoding methods should be put in namespace std for ADL.
-namespace std {
+// Sink based encoding. Arithmetic types are copied byte by byte as in
+// StringTranslate, message types provide Encode(Sink &) / Decode(ByteSpan &).
+template <typename Type, typename Sink,
+    typename = std::enable_if_t<std::is_arithmetic<Type>::value>,
+    typename = decltype(std::declval<Sink &>().Write(nullptr, 0))>
+inline void Encode(const Type &source, Sink &sink) {
+  sink.Write(reinterpret_cast<const char *>(&source), sizeof(source));
+}
 
-template<typename Type,
+template <typename Type,
     typename = std::enable_if_t<std::is_arithmetic<Type>::value>>
-inline void StringTranslate(const Type &num, std::string &data) {
-  const char *ptr = (const char *) &num;
-  data.resize(sizeof(num));
-  for (uint32_t i{0}; i < sizeof(num); i++) {
-    data[i] = ptr[i];
-  }
+inline bool Decode(ByteSpan &span, Type &source) {
+  return span.Read(&source, sizeof(source));
 }
 
-template<typename Type,
-    typename = std::enable_if_t<std::is_arithmetic<Type>::value>>
-inline void StringTranslate(const std::string &data, Type &num) {
-  char *ptr = (char *) &num;
-  for (uint32_t i{0}; i < sizeof(num); i++) {
-    ptr[i] = data[i];
+template <typename Type, typename Sink,
+    typename = std::enable_if_t<IsEncodible<Type>::has_sink_encoding_method>,
+    typename = decltype(std::declval<Sink &>().Write(nullptr, 0)),
+    typename = std::nullptr_t>
+inline void Encode(const Type &source, Sink &sink) {
+  detail::EncodeMessage(source, sink);
+}
+
+template <typename Type,
+    typename = std::enable_if_t<IsEncodible<Type>::has_sink_encoding_method>,
+    typename = std::nullptr_t>
+inline bool Decode(ByteSpan &span, Type &source) {
+  return detail::DecodeMessage(span, source);
+}
+
+// The string interface of sink encodable types sizes the output once and
+// encodes in place instead of splicing temporaries.
+template <typename Type,
+    typename = std::enable_if_t<IsEncodible<Type>::has_sink_encoding_method>,
+    typename = std::nullptr_t, typename = std::nullptr_t>
+inline void Encode(const Type &source, std::string &data) {
+  CountingSink counter;
+  detail::EncodeMessage(source, counter);
+  data.clear();
+  data.reserve(counter.Size());
+  StringSink sink(data);
+  detail::EncodeMessage(source, sink);
+}
+
+template <typename Type,
+    typename = std::enable_if_t<IsEncodible<Type>::has_sink_encoding_method>,
+    typename = std::nullptr_t, typename = std::nullptr_t>
+inline bool Decode(const std::string &data, Type &source) {
+  ByteSpan span(data);
+  return detail::DecodeMessage(span, source);
+}
+
+// Strings are encoded as a uint32_t length, written with Policy, followed by
+// the characters.
+template <typename Policy = FixedEncoding, typename Sink>
+inline void EncodeString(const char *str, size_t size, Sink &sink) {
+  Policy::EncodeInt(static_cast<uint32_t>(size), sink);
+  sink.Write(str, size);
+}
+
+template <typename Policy = FixedEncoding, typename Sink>
+inline void EncodeString(const std::string &str, Sink &sink) {
+  EncodeString<Policy>(str.c_str(), str.size(), sink);
+}
+
+template <typename Policy = FixedEncoding>
+inline bool DecodeString(ByteSpan &span, std::string &str) {
+  uint32_t size{0};
+  if (!Policy::DecodeInt(span, size)) {
+    return false;
+  }
+  const char *ptr = span.Consume(size);
+  if (!ptr) {
+    return false;
   }
+  str.assign(ptr, size);
+  return true;
 }
 
-}  // namespace std
+} // namespace common::com
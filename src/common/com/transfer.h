@@ -0,0 +1,807 @@
+#pragma once
+
+#include <Arduino.h>
+#include <SoftwareSerial.h>
+
+#include "common/com/crc.h"
+#include "common/com/defs.h"
+#include "common/com/specialized_encoding.h"
+#include "common/utility/utility.h"
+
+namespace common::com {
+
+enum class TransferStatus : uint8_t {
+  IDLE = 0,
+  IN_PROGRESS = 1,
+  DONE = 2,
+  TIMEOUT = 3,
+};
+
+// Whether availableForWrite() of a stream tells its free TX space.
+// SoftwareSerial has no TX buffer and always reports 0, its write() takes
+// the byte's time on the line instead.
+template <typename ComType>
+struct ReportsWriteRoom : std::true_type {};
+
+template <>
+struct ReportsWriteRoom<SoftwareSerial> : std::false_type {};
+
+// The Com wire protocol: raw transfers, and chunked ones (stop-and-wait,
+// windowed or CRC framed with selective retransmission) after a metadata
+// handshake. A transfer is started with BeginWrite / BeginRead and advanced
+// by calling Poll() from loop(); Poll() never waits for the peer, it only
+// moves the bytes that are already available. The blocking Com::Write /
+// Com::Read run the same state machine until it finishes.
+template <typename ComType>
+class Transfer {
+public:
+  using Callback = void (*)(Transfer &);
+
+  Transfer() = default;
+  Transfer(const Transfer &) = delete;
+  Transfer &operator=(const Transfer &) = delete;
+
+  // timeout_ms bounds the time without progress, 0 waits forever.
+  bool BeginWrite(ComType &com, std::string data, uint16_t chunk_size,
+                  uint32_t timeout_ms, LinkState *link = nullptr,
+                  Callback callback = nullptr) {
+    if (Busy()) {
+      return false;
+    }
+    data_ = common::move(data);
+    StartWrite(com, data_.c_str(), data_.size(), chunk_size, timeout_ms, link,
+               callback);
+    return true;
+  }
+
+  // Same without a copy, data has to stay valid until the transfer finished.
+  bool BeginWrite(ComType &com, const char *data, size_t bytes,
+                  uint16_t chunk_size, uint32_t timeout_ms,
+                  LinkState *link = nullptr, Callback callback = nullptr) {
+    if (Busy()) {
+      return false;
+    }
+    StartWrite(com, data, bytes, chunk_size, timeout_ms, link, callback);
+    return true;
+  }
+
+  // Reads `bytes` raw bytes when chunk_size is 0, a chunked message otherwise.
+  bool BeginRead(ComType &com, size_t bytes, uint16_t chunk_size,
+                 uint32_t timeout_ms, LinkState *link = nullptr,
+                 Callback callback = nullptr) {
+    if (Busy()) {
+      return false;
+    }
+    Start(com, chunk_size, timeout_ms, link, callback);
+    data_.clear();
+    if (!chunk_size) {
+      data_.resize(bytes);
+      state_ = State::READ_RAW;
+      return true;
+    }
+    state_ = State::READ_METADATA;
+    return true;
+  }
+
+  TransferStatus Poll() {
+    if (!Busy()) {
+      return status_;
+    }
+    bool progress{false};
+    switch (state_) {
+      case State::WRITE_RAW: {
+        progress = WritePending(out_, out_size_);
+        if (offset_ == out_size_) {
+          Finish(TransferStatus::DONE);
+        }
+        break;
+      }
+      case State::WRITE_METADATA: {
+        progress = WritePending(pending_.c_str(), pending_.size());
+        if (offset_ == pending_.size()) {
+          offset_ = 0;
+          state_ = State::WAIT_METADATA_ACK;
+        }
+        break;
+      }
+      case State::WAIT_METADATA_ACK: {
+        if (static_cast<size_t>(com_->available()) >= 1u + query_) {
+          progress = true;
+          ReadMetadataAck();
+        }
+        break;
+      }
+      case State::WRITE_CHUNKS: {
+        progress = PollWriteChunks();
+        break;
+      }
+      case State::WRITE_FRAMES: {
+        progress = WritePending(pending_.c_str(), pending_.size());
+        if (offset_ == pending_.size()) {
+          pending_.clear();
+          state_ = State::WAIT_REPORT;
+        }
+        break;
+      }
+      case State::WAIT_REPORT: {
+        progress = Fill(pending_, bitmap_.size() + kFrameCrcSize);
+        if (pending_.size() == bitmap_.size() + kFrameCrcSize) {
+          ReadReport();
+        }
+        break;
+      }
+      case State::SKIP_REPORT: {
+        progress = com_->available();
+        Drain();
+        break;
+      }
+      case State::READ_RAW: {
+        progress = ReadAvailable(0, data_.size());
+        if (offset_ == data_.size()) {
+          Finish(TransferStatus::DONE);
+        }
+        break;
+      }
+      case State::READ_METADATA: {
+        if (static_cast<size_t>(com_->available()) >= kStrMetadataSize) {
+          progress = true;
+          ReadMetadata();
+        }
+        break;
+      }
+      case State::READ_CHUNKS: {
+        progress = PollReadChunks();
+        break;
+      }
+      case State::READ_FRAMES:
+      case State::READ_FINAL_ACK: {
+        progress = PollReadFrames();
+        break;
+      }
+    }
+
+    uint32_t timeout_ms = StateTimeout();
+    if (progress) {
+      last_progress_ms_ = millis();
+    } else if (Busy() && timeout_ms &&
+               millis() - last_progress_ms_ >= timeout_ms) {
+      last_progress_ms_ = millis();
+      OnTimeout();
+    }
+    return status_;
+  }
+
+  inline TransferStatus Status() const {
+    return status_;
+  }
+
+  inline bool Busy() const {
+    return status_ == TransferStatus::IN_PROGRESS;
+  }
+
+  // Payload received by a finished read, can be moved out.
+  inline std::string &Data() {
+    return data_;
+  }
+
+  inline const std::string &Data() const {
+    return data_;
+  }
+
+  template <typename MsgType>
+  bool Get(MsgType &msg) const {
+    if (status_ != TransferStatus::DONE) {
+      return false;
+    }
+    return common::com::Decode(data_, msg);
+  }
+
+private:
+  enum class State : uint8_t {
+    WRITE_RAW,
+    WRITE_METADATA,
+    WAIT_METADATA_ACK,
+    WRITE_CHUNKS,
+    WRITE_FRAMES,
+    WAIT_REPORT,
+    SKIP_REPORT,
+    READ_RAW,
+    READ_METADATA,
+    READ_CHUNKS,
+    READ_FRAMES,
+    // Every chunk is in, the final report waits for the sender's ack.
+    READ_FINAL_ACK,
+  };
+
+  // Consecutive timeouts the receiver reports, and NACKs the sender takes,
+  // before giving up.
+  static PROGMEM constexpr const uint8_t kMaxRetries{3};
+
+  void Start(ComType &com, uint16_t chunk_size, uint32_t timeout_ms,
+             LinkState *link, Callback callback) {
+    com_ = &com;
+    chunk_size_ = chunk_size;
+    timeout_ms_ = timeout_ms;
+    link_ = link;
+    callback_ = callback;
+    window_ = 0;
+    crc_ = false;
+    query_ = false;
+    repeated_ = false;
+    num_chunk_ = 0;
+    base_ = 0;
+    next_ = 0;
+    last_acked_ = 0;
+    resent_ = 0;
+    offset_ = 0;
+    retries_ = 0;
+    pending_.clear();
+    status_ = TransferStatus::IN_PROGRESS;
+    last_progress_ms_ = millis();
+  }
+
+  void StartWrite(ComType &com, const char *data, size_t bytes,
+                  uint16_t chunk_size, uint32_t timeout_ms, LinkState *link,
+                  Callback callback) {
+    Start(com, chunk_size, timeout_ms, link, callback);
+    out_ = data;
+    out_size_ = bytes;
+    if (!chunk_size) {
+      state_ = State::WRITE_RAW;
+      return;
+    }
+
+    // A window / CRC framing / size query is only proposed to a peer that
+    // advertised it before, so legacy receivers never see the high byte of
+    // the chunk size. The chunk size only adapts on such links too.
+    if (link_ && chunk_size <= std::numeric_limits<uint8_t>::max()) {
+      crc_ = link_->crc && link_->peer_crc;
+      query_ = link_->peer_size_query;
+      if (query_) {
+        chunk_size_ = ChunkSizeFor(*link_, chunk_size, crc_);
+      }
+      window_ = NegotiatedWindow(
+          WindowForRoom(link_->window, chunk_size_ + FrameOverhead(),
+                        PeerRxRoom(*link_)),
+          link_->peer_window);
+    }
+    num_chunk_ = ChunkCount(bytes, chunk_size_);
+    StringSink sink(pending_);
+    uint8_t proposal =
+        window_ | (crc_ ? kCrcFrames : 0) | (query_ ? kSizeQuery : 0);
+    common::com::Encode(
+        static_cast<uint16_t>(chunk_size_ | (uint16_t{proposal} << 8)), sink);
+    common::com::Encode(num_chunk_, sink);
+    common::com::Encode(static_cast<uint32_t>(bytes), sink);
+    state_ = State::WRITE_METADATA;
+  }
+
+  void Finish(TransferStatus status) {
+    status_ = status;
+    if (callback_) {
+      (*callback_)(*this);
+    }
+  }
+
+  // Ends a chunked write, adapting the chunk size of the link to how it went.
+  void FinishWrite(TransferStatus status) {
+    if (query_) {
+      AdaptChunkSize(*link_, chunk_size_, num_chunk_,
+                     status == TransferStatus::DONE ? resent_ : num_chunk_,
+                     crc_);
+    }
+    Finish(status);
+  }
+
+  inline uint8_t FrameOverhead() const {
+    return crc_ ? kFrameHeaderSize + kFrameCrcSize : 0;
+  }
+
+  // No progress for that long is a timeout, 0 never times out. CRC framing
+  // recovers from lost frames and reports by timing out, so it always does,
+  // the receiver well before the sender gives up on the report.
+  uint32_t StateTimeout() const {
+    if (state_ == State::WAIT_REPORT) {
+      return 2 * kFrameTimeoutMs;
+    }
+    if (state_ == State::SKIP_REPORT) {
+      return kReportResyncMs;
+    }
+    if (state_ == State::READ_FRAMES || state_ == State::READ_FINAL_ACK) {
+      return kFrameTimeoutMs;
+    }
+    return timeout_ms_;
+  }
+
+  // Bytes write() takes without waiting for the TX buffer to drain. Streams
+  // that do not report their free space are fed one byte per call.
+  size_t WriteRoom() {
+    if constexpr (ReportsWriteRoom<ComType>::value) {
+      int room = com_->availableForWrite();
+      return room > 0 ? room : 0;
+    } else {
+      return 1;
+    }
+  }
+
+  // Writes as much of buffer (from offset_) as the TX buffer takes, nothing
+  // while it is full.
+  bool WritePending(const char *buffer, size_t size) {
+    size_t bytes = std::min(WriteRoom(), size - offset_);
+    if (!bytes) {
+      return false;
+    }
+    com_->write(buffer + offset_, bytes);
+    offset_ += bytes;
+    return bytes > 0;
+  }
+
+  // Reads what is available of the expected_size bytes stored at idx.
+  bool ReadAvailable(size_t idx, size_t expected_size) {
+    size_t bytes = std::min(static_cast<size_t>(com_->available()),
+                            expected_size - offset_);
+    if (!bytes) {
+      return false;
+    }
+    com_->readBytes(&data_[idx + offset_], bytes);
+    offset_ += bytes;
+    return true;
+  }
+
+  // Appends what is available to buffer until it holds size bytes.
+  bool Fill(std::string &buffer, size_t size) {
+    bool progress{false};
+    while (buffer.size() < size && com_->available()) {
+      buffer += static_cast<char>(com_->read());
+      progress = true;
+    }
+    return progress;
+  }
+
+  void Drain() {
+    while (com_->available()) {
+      com_->read();
+    }
+  }
+
+  inline static uint32_t ChunkCount(uint32_t bytes, uint16_t chunk_size) {
+    return bytes ? 1 + (bytes - 1) / chunk_size : 0;
+  }
+
+  size_t ChunkSize(uint16_t chunk, size_t bytes) const {
+    size_t idx = static_cast<size_t>(chunk) * chunk_size_;
+    return std::min(static_cast<size_t>(chunk_size_), bytes - idx);
+  }
+
+  inline static bool TestBit(const std::string &bitmap, uint16_t i) {
+    return static_cast<uint8_t>(bitmap[i / 8]) & (1 << (i % 8));
+  }
+
+  inline static void SetBit(std::string &bitmap, uint16_t i) {
+    bitmap[i / 8] |= static_cast<char>(1 << (i % 8));
+  }
+
+  void ReadMetadataAck() {
+    uint8_t ack = com_->read();
+    uint8_t advertised = ack >> kWindowShift;
+    if (link_) {
+      link_->peer_window = advertised;
+      link_->peer_crc = ack & kCrcCapable;
+      link_->peer_size_query = ack & kSizeQueryCapable;
+      if (query_) {
+        link_->peer_rx_room = com_->read();
+      }
+    }
+    // The receiver refuses chunks its RX ring cannot hold. Older receivers
+    // also answer 2 to a chunk size above their own and read on, so only a
+    // chunk that large ends the transfer here.
+    if ((ack & kStatusMask) == 2 && chunk_size_ >= kRxBufferSize) {
+      FinishWrite(TransferStatus::TIMEOUT);
+      return;
+    }
+    crc_ = crc_ && (ack & kCrcCapable);
+    if (crc_) {
+      // A round is as many frames as the window, one without a window.
+      uint8_t round = window_ ? NegotiatedWindow(window_, advertised) : 0;
+      window_ = round ? round : 1;
+      bitmap_.assign((num_chunk_ + 7) / 8, '\0');
+      StartRound();
+      return;
+    }
+    if (window_) {
+      window_ = NegotiatedWindow(window_, advertised);
+    }
+    state_ = State::WRITE_CHUNKS;
+  }
+
+  // Stop-and-wait (acknowledgement 0 accepts a chunk, anything else asks for
+  // it again) and go-back-N (cumulative count, kNack resumes from the first
+  // chunk not accepted).
+  bool PollWriteChunks() {
+    bool progress{false};
+    // Acknowledgements first, they may open up the window. More NACKs in a
+    // row than the receiver sends before giving up mean it is not reading
+    // this transfer anymore.
+    while (com_->available() && base_ < num_chunk_) {
+      progress = true;
+      uint8_t ack = com_->read();
+      bool nack = window_ ? ack & kNack : ack != 0;
+      retries_ = nack ? retries_ + 1 : 0;
+      if (retries_ > kMaxRetries) {
+        FinishWrite(TransferStatus::TIMEOUT);
+        return progress;
+      }
+      if (window_) {
+        base_ += static_cast<uint8_t>((ack - base_) & kAckCountMask);
+        if (ack & kNack) {
+          resent_ += next_ - base_;
+          next_ = base_;
+          offset_ = 0;
+        }
+      } else if (ack == 0) {
+        ++base_;
+      } else {
+        ++resent_;
+        next_ = base_;
+        offset_ = 0;
+      }
+    }
+    if (base_ >= num_chunk_) {
+      FinishWrite(TransferStatus::DONE);
+      return progress;
+    }
+
+    uint8_t window = window_ ? window_ : 1;
+    if (next_ < num_chunk_ && next_ - base_ < window) {
+      size_t idx = static_cast<size_t>(next_) * chunk_size_;
+      size_t cur_chunk_size = ChunkSize(next_, out_size_);
+      size_t bytes = std::min(WriteRoom(), cur_chunk_size - offset_);
+      if (!bytes) {
+        return progress;
+      }
+      com_->write(out_ + idx + offset_, bytes);
+      offset_ += bytes;
+      progress = true;
+      if (offset_ == cur_chunk_size) {
+        offset_ = 0;
+        ++next_;
+      }
+    }
+    return progress;
+  }
+
+  // Selective repeat over CRC framed chunks: every round sends up to window_
+  // chunks the receiver does not hold yet, and its bitmap report tells which
+  // of them have to go again. Gives up once the receiver stopped making
+  // progress for kMaxFrameRetries rounds.
+  void StartRound() {
+    uint8_t count{0};
+    for (uint16_t i{0}; i < num_chunk_ && count < window_; ++i) {
+      if (!TestBit(bitmap_, i)) {
+        round_[count++] = i;
+      }
+    }
+    if (!count) {
+      if (num_chunk_) {
+        StreamSink<ComType> sink(*com_);
+        common::com::Encode(kFinalAckSeq, sink);
+        common::com::Encode(uint8_t{0}, sink);
+      }
+      FinishWrite(TransferStatus::DONE);
+      return;
+    }
+    // A report left over from an idle gap is not the answer to this round.
+    Drain();
+    pending_.clear();
+    for (uint8_t k{0}; k < count; ++k) {
+      // Chunks go out in order, so one below next_ was sent before.
+      if (round_[k] < next_) {
+        ++resent_;
+      } else {
+        next_ = round_[k] + 1;
+      }
+      AppendFrame(round_[k], count - 1 - k);
+    }
+    round_size_ = count;
+    offset_ = 0;
+    state_ = State::WRITE_FRAMES;
+  }
+
+  // seq (u16) | frames left in the round (u8) | payload | CRC-16.
+  void AppendFrame(uint16_t seq, uint8_t left) {
+    size_t idx = static_cast<size_t>(seq) * chunk_size_;
+    size_t start = pending_.size();
+    StringSink sink(pending_);
+    common::com::Encode(seq, sink);
+    common::com::Encode(left, sink);
+    pending_.append(out_ + idx, ChunkSize(seq, out_size_));
+    common::com::Encode(
+        Crc16(pending_.c_str() + start, pending_.size() - start), sink);
+  }
+
+  void ReadReport() {
+    uint16_t crc;
+    memcpy(&crc, pending_.c_str() + bitmap_.size(), kFrameCrcSize);
+    if (crc != Crc16(pending_.c_str(), bitmap_.size())) {
+      // A lost byte shifted it, starting the next round now would read the
+      // rest of it as the next report.
+      pending_.clear();
+      state_ = State::SKIP_REPORT;
+      return;
+    }
+    bool progress{false};
+    for (uint8_t k{0}; k < round_size_; ++k) {
+      progress |= TestBit(pending_, round_[k]);
+    }
+    for (size_t i{0}; i < bitmap_.size(); ++i) {
+      bitmap_[i] |= pending_[i];
+    }
+    NextRound(progress);
+  }
+
+  void NextRound(bool progress) {
+    retries_ = progress ? 0 : retries_ + 1;
+    if (retries_ > kMaxFrameRetries) {
+      FinishWrite(TransferStatus::TIMEOUT);
+      return;
+    }
+    StartRound();
+  }
+
+  void ReadMetadata() {
+    char metadata[kStrMetadataSize];
+    size_t read = com_->readBytes(metadata, kStrMetadataSize);
+    uint16_t sender_chunk_size{0};
+    uint32_t data_len{0};
+    ByteSpan span(metadata, read);
+    if (!common::com::Decode(span, sender_chunk_size) ||
+        !common::com::Decode(span, num_chunk_) ||
+        !common::com::Decode(span, data_len)) {
+      // Short, the sender times out waiting for the ack.
+      Drain();
+      Finish(TransferStatus::TIMEOUT);
+      return;
+    }
+
+    uint8_t advertised =
+        link_ ? NegotiatedWindow(link_->window, kMaxWindowSize) : 0;
+    if (link_) {
+      uint8_t proposal = sender_chunk_size >> 8;
+      window_ = NegotiatedWindow(proposal & kWindowMask, advertised);
+      crc_ = link_->crc && (proposal & kCrcFrames);
+      query_ = proposal & kSizeQuery;
+      sender_chunk_size &= std::numeric_limits<uint8_t>::max();
+    }
+
+    // Chunks up to the RX ring size are fine on links that negotiate it, a
+    // larger one never fits and the transfer is refused.
+    uint8_t rx_room = link_ ? FreeRxRoom(*com_) : 0;
+    bool refused = sender_chunk_size >= kRxBufferSize;
+    uint8_t status = refused || (sender_chunk_size > chunk_size_ &&
+                                 sender_chunk_size > rx_room) ? 2 : 0;
+    if (link_) {
+      status |= kSizeQueryCapable | (link_->crc ? kCrcCapable : 0);
+    }
+    chunk_size_ = sender_chunk_size;
+    com_->write(static_cast<uint8_t>(status | (advertised << kWindowShift)));
+    if (query_) {
+      com_->write(rx_room);
+    }
+
+    // Unprotected bytes, a corrupted length must not size the buffer.
+    if (refused || !sender_chunk_size ||
+        num_chunk_ != ChunkCount(data_len, sender_chunk_size)) {
+      Drain();
+      Finish(TransferStatus::TIMEOUT);
+      return;
+    }
+    data_.resize(data_len);
+    offset_ = 0;
+    if (!num_chunk_) {
+      Finish(TransferStatus::DONE);
+      return;
+    }
+    if (crc_) {
+      bitmap_.assign((num_chunk_ + 7) / 8, '\0');
+      next_ = num_chunk_;
+      frame_size_ = 0;
+      state_ = State::READ_FRAMES;
+      return;
+    }
+    state_ = State::READ_CHUNKS;
+  }
+
+  bool PollReadChunks() {
+    size_t idx = static_cast<size_t>(base_) * chunk_size_;
+    if (!ReadAvailable(idx, ChunkSize(base_, data_.size()))) {
+      return false;
+    }
+    if (offset_ < ChunkSize(base_, data_.size())) {
+      return true;
+    }
+    offset_ = 0;
+    retries_ = 0;
+    ++base_;
+    // Windows are acknowledged every window / 2 chunks (and the last one) so
+    // the sender never stalls on a full window.
+    if (!window_) {
+      com_->write(uint8_t(0));
+    } else if (base_ - last_acked_ >= window_ / 2 || base_ == num_chunk_) {
+      last_acked_ = base_;
+      com_->write(static_cast<uint8_t>(base_ & kAckCountMask));
+    }
+    if (base_ == num_chunk_) {
+      Finish(TransferStatus::DONE);
+    }
+    return true;
+  }
+
+  // Receiving side of the CRC framed rounds. Frames failing the CRC are
+  // dropped and a duplicate never overwrites a chunk already accepted. The
+  // bitmap report goes out after the last frame of a round, or once the line
+  // has been idle for the frame timeout when that frame was lost. base_
+  // counts the chunks accepted, next_ is the missing count last reported.
+  // Once every chunk is in, frames the sender repeats because the final
+  // report was lost are answered again until its ack arrives.
+  bool PollReadFrames() {
+    size_t size = frame_size_ ?
+        kFrameHeaderSize + frame_size_ + kFrameCrcSize : kFrameHeaderSize;
+    bool progress = Fill(pending_, size);
+    if (pending_.size() < size) {
+      return progress;
+    }
+    uint16_t seq{0};
+    uint8_t left{0};
+    ByteSpan span(pending_);
+    if (!common::com::Decode(span, seq) || !common::com::Decode(span, left)) {
+      // Truncated, dropped like a frame failing its CRC.
+      pending_.clear();
+      frame_size_ = 0;
+      return true;
+    }
+    if (!frame_size_) {
+      if (seq == kFinalAckSeq && state_ == State::READ_FINAL_ACK) {
+        pending_.clear();
+        Finish(TransferStatus::DONE);
+        return true;
+      }
+      frame_size_ = seq < num_chunk_ ? ChunkSize(seq, data_.size()) : 0;
+      if (!frame_size_) {
+        // Out of sync, the idle gap ends the round.
+        Drain();
+        pending_.clear();
+      }
+      return true;
+    }
+
+    uint16_t crc;
+    memcpy(&crc, pending_.c_str() + size - kFrameCrcSize, kFrameCrcSize);
+    if (crc == Crc16(pending_.c_str(), size - kFrameCrcSize)) {
+      if (!TestBit(bitmap_, seq)) {
+        memcpy(&data_[static_cast<size_t>(seq) * chunk_size_],
+               pending_.c_str() + kFrameHeaderSize, frame_size_);
+        SetBit(bitmap_, seq);
+        ++base_;
+      }
+      repeated_ = state_ == State::READ_FINAL_ACK;
+      if (!left) {
+        SendReport();
+      }
+    }
+    pending_.clear();
+    frame_size_ = 0;
+    return true;
+  }
+
+  void SendReport() {
+    uint16_t missing = num_chunk_ - base_;
+    retries_ = missing && missing == next_ ? retries_ + 1 : 0;
+    if (retries_ > kMaxFrameRetries) {
+      Finish(TransferStatus::TIMEOUT);
+      return;
+    }
+    next_ = missing;
+    repeated_ = false;
+    com_->write(bitmap_.c_str(), bitmap_.size());
+    StreamSink<ComType> sink(*com_);
+    common::com::Encode(Crc16(bitmap_.c_str(), bitmap_.size()), sink);
+    if (!missing) {
+      state_ = State::READ_FINAL_ACK;
+    }
+  }
+
+  void OnTimeout() {
+    switch (state_) {
+      case State::WAIT_REPORT:
+      case State::SKIP_REPORT: {
+        NextRound(false);
+        return;
+      }
+      case State::READ_FRAMES: {
+        Drain();
+        pending_.clear();
+        frame_size_ = 0;
+        SendReport();
+        return;
+      }
+      case State::READ_FINAL_ACK: {
+        Drain();
+        pending_.clear();
+        frame_size_ = 0;
+        if (repeated_) {
+          // The last frame of the repeated round was lost.
+          SendReport();
+          return;
+        }
+        // The ack was lost. Three quiet frame timeouts outlast the 2 the
+        // sender waits for a report before it repeats a round.
+        if (++retries_ > 2) {
+          Finish(TransferStatus::DONE);
+        }
+        return;
+      }
+      case State::READ_CHUNKS: {
+        break;
+      }
+      case State::READ_METADATA: {
+        // What arrived of it would be read as the start of the next one.
+        Drain();
+        Finish(TransferStatus::TIMEOUT);
+        return;
+      }
+      default: {
+        Finish(TransferStatus::TIMEOUT);
+        return;
+      }
+    }
+    if (++retries_ > kMaxRetries) {
+      Finish(TransferStatus::TIMEOUT);
+      return;
+    }
+    // Drop the partial chunk and ask the sender to resend it, windows go
+    // back to the first chunk that was not accepted.
+    Drain();
+    offset_ = 0;
+    if (window_) {
+      last_acked_ = base_;
+      com_->write(static_cast<uint8_t>((base_ & kAckCountMask) | kNack));
+    } else {
+      com_->write(uint8_t(1));
+    }
+  }
+
+  ComType *com_{nullptr};
+  LinkState *link_{nullptr};
+  Callback callback_{nullptr};
+  // Payload of a write, pointing into data_ when the transfer owns it.
+  const char *out_{nullptr};
+  size_t out_size_{0};
+  // Owned payload of a write, payload of a read.
+  std::string data_{};
+  // Metadata and frames being written, report or frame being read.
+  std::string pending_{};
+  // CRC framing: chunks the receiver holds.
+  std::string bitmap_{};
+  uint32_t timeout_ms_{0};
+  uint32_t last_progress_ms_{0};
+  size_t offset_{0};
+  uint16_t chunk_size_{0};
+  uint16_t num_chunk_{0};
+  uint16_t base_{0};
+  uint16_t next_{0};
+  uint16_t last_acked_{0};
+  uint16_t resent_{0};
+  uint16_t frame_size_{0};
+  uint16_t round_[kMaxWindowSize]{};
+  uint8_t round_size_{0};
+  uint8_t window_{0};
+  uint8_t retries_{0};
+  bool crc_{false};
+  bool query_{false};
+  // A frame arrived after the final report.
+  bool repeated_{false};
+  State state_{State::READ_RAW};
+  TransferStatus status_{TransferStatus::IDLE};
+};
+
+}  // namespace common::com
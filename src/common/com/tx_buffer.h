@@ -0,0 +1,75 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "common/utility/ring_buffer.h"
+
+namespace common::com {
+
+// Nagle-style write coalescing in front of a Stream: writes are queued and
+// handed to the stream in one go once `threshold` bytes are pending or the
+// oldest pending byte waited `delay_ms`, instead of one flush() per message.
+// It is a sink, so messages are encoded straight into it.
+template <typename ComType, uint16_t Capacity>
+class TxBuffer {
+public:
+  inline void Attach(ComType &com) {
+    com_ = &com;
+  }
+
+  // threshold 0 disables coalescing.
+  void Configure(uint16_t threshold, uint32_t delay_ms) {
+    threshold_ = threshold < Capacity ? threshold : Capacity;
+    delay_ms_ = delay_ms;
+  }
+
+  inline bool Enabled() const {
+    return threshold_ && com_;
+  }
+
+  // Queues bytes, pushing the oldest ones out when the buffer is full.
+  void Write(const char *data, size_t bytes) {
+    if (buffer_.Empty()) {
+      since_ms_ = millis();
+    }
+    for (size_t i{0}; i < bytes; ++i) {
+      if (buffer_.Full()) {
+        Push();
+        since_ms_ = millis();
+      }
+      buffer_.PushBack(data[i]);
+    }
+  }
+
+  // Pushes the pending bytes if the size or time threshold is reached.
+  void Poll() {
+    if (!buffer_.Empty() && (buffer_.Size() >= threshold_ ||
+                             millis() - since_ms_ >= delay_ms_)) {
+      Push();
+    }
+  }
+
+  // Moves every pending byte into the stream's own (interrupt driven) TX
+  // buffer. Only blocks while that one is full, never waits for the line.
+  void Push() {
+    while (!buffer_.Empty()) {
+      uint16_t bytes;
+      const char *data = buffer_.FrontSpan(bytes);
+      com_->write(reinterpret_cast<const uint8_t *>(data), bytes);
+      buffer_.Consume(bytes);
+    }
+  }
+
+  inline uint16_t Pending() const {
+    return buffer_.Size();
+  }
+
+private:
+  RingBuffer<char, Capacity> buffer_{};
+  ComType *com_{nullptr};
+  uint32_t delay_ms_{0};
+  uint32_t since_ms_{0};
+  uint16_t threshold_{0};
+};
+
+}  // namespace common::com
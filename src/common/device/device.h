@@ -5,7 +5,7 @@
 
 #include "common/event/defs.h"
 #include "common/stl/string.h"
-#include "common/utility/Variant.h"
+#include "common/utility/variant.h"
 
 namespace common::device {
 
@@ -21,24 +21,25 @@ public:
   virtual ~Sensor() = default;
 
   virtual bool UpdateReading() = 0;
-  virtual std::string GetDataType(uint8_t datatype_idx = 0) const = 0;
+  virtual Symbol GetDataType(uint8_t datatype_idx = 0) const = 0;
   virtual bool IsValid(uint8_t datatype_idx = 0) const = 0;
-  virtual std::string GetUnit(uint8_t datatype_idx = 0) const = 0;
+  virtual Symbol GetUnit(uint8_t datatype_idx = 0) const = 0;
   virtual DeviceDataType GetReading(uint8_t datatype_idx = 0) const = 0;
-  virtual std::string GetSensorType() const = 0;
+  virtual Symbol GetSensorType() const = 0;
 
+  // Copies handles only, the texts are interned once per sensor.
   SensorReading GenerateSensorReading(uint8_t datatype_idx = 0) const {
     SensorReading reading;
     reading.time = t_;
     reading.sensor_id = id_;
     reading.sensor_type = GetSensorType();
     reading.reading = GetReading(datatype_idx);
-    reading.data_type = GetDataType();
+    reading.data_type = GetDataType(datatype_idx);
     reading.unit = GetUnit(datatype_idx);
     return reading;
   }
 
-  inline const std::string &GetId() const { return id_; }
+  inline Symbol GetId() const { return id_; }
 
   inline common::Time GetTime() const { return t_; }
 
@@ -47,7 +48,7 @@ public:
 protected:
   static constexpr uint8_t kWaitTime{5};
   common::Time t_{common::Time::FromSec(0)};
-  std::string id_{""};
+  Symbol id_{};
 };
 
 class Executor {
@@ -60,7 +61,7 @@ public:
   Executor &operator=(Executor &&) = default;
   virtual ~Executor() = default;
 
-  inline const std::string &GetId() const { return id_; }
+  inline Symbol GetId() const { return id_; }
 
   inline common::Time GetTime() const { return t_; }
 
@@ -73,7 +74,7 @@ public:
 
 protected:
   common::Time t_{common::Time::FromSec(0)};
-  std::string id_{""};
+  Symbol id_{};
 };
 
 } // namespace common::device
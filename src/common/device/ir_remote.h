@@ -14,10 +14,10 @@ public:
   ~IRNecRemote() = default;
 
   bool UpdateReading() override;
-  std::string GetDataType(uint8_t datatype_idx = 0) const override;
+  Symbol GetDataType(uint8_t datatype_idx = 0) const override;
   bool IsValid(uint8_t datatype_idx = 0) const override;
-  std::string GetSensorType() const override;
-  std::string GetUnit(uint8_t datatype_idx = 0) const override;
+  Symbol GetSensorType() const override;
+  Symbol GetUnit(uint8_t datatype_idx = 0) const override;
   DeviceDataType GetReading(uint8_t datatype_idx = 0) const override;
   void Clear() override;
 
@@ -73,13 +73,15 @@ bool IRNecRemote<_PIN>::UpdateReading() {
 }
 
 template <uint8_t _PIN>
-std::string IRNecRemote<_PIN>::GetSensorType() const {
-  return kSensorType;
+Symbol IRNecRemote<_PIN>::GetSensorType() const {
+  static const Symbol kSymbol = Symbol::Static(kSensorType);
+  return kSymbol;
 }
 
 template <uint8_t _PIN>
-std::string IRNecRemote<_PIN>::GetDataType(uint8_t) const {
-  return kDataType;
+Symbol IRNecRemote<_PIN>::GetDataType(uint8_t) const {
+  static const Symbol kSymbol = Symbol::Static(kDataType);
+  return kSymbol;
 }
 
 template <uint8_t _PIN>
@@ -93,8 +95,8 @@ DeviceDataType IRNecRemote<_PIN>::GetReading(uint8_t) const {
 }
 
 template <uint8_t _PIN>
-std::string IRNecRemote<_PIN>::GetUnit(uint8_t) const {
-  return "";
+Symbol IRNecRemote<_PIN>::GetUnit(uint8_t) const {
+  return Symbol();
 }
 
 template <uint8_t _PIN>
@@ -33,24 +33,27 @@ bool GY302::UpdateReading() {
   return data_ >= 0.0;
 }
 
-std::string GY302::GetDataType(uint8_t) const {
-  return kDataType;
+Symbol GY302::GetDataType(uint8_t) const {
+  static const Symbol kSymbol = Symbol::Static(kDataType);
+  return kSymbol;
 }
 
 bool GY302::IsValid(uint8_t) const {
   return !isnan(data_) && t_.Sec() > 0 && data_ >= 0.0;
 }
 
-std::string GY302::GetUnit(uint8_t) const {
-  return kUnitName;
+Symbol GY302::GetUnit(uint8_t) const {
+  static const Symbol kSymbol = Symbol::Static(kUnitName);
+  return kSymbol;
 }
 
 DeviceDataType GY302::GetReading(uint8_t) const {
   return DeviceDataType{double(data_)};
 }
 
-std::string GY302::GetSensorType() const {
-  return kSensorType;
+Symbol GY302::GetSensorType() const {
+  static const Symbol kSymbol = Symbol::Static(kSensorType);
+  return kSymbol;
 }
 
 
@@ -25,10 +25,12 @@ bool DHT22::UpdateReading() {
   return true;
 }
 
-std::string DHT22::GetDataType(uint8_t datatype) const {
-  const char* p = reinterpret_cast<const char*>(
-      pgm_read_ptr(kDataType + datatype));
-  return p;
+Symbol DHT22::GetDataType(uint8_t datatype) const {
+  static const Symbol kSymbols[] = {
+      Symbol::Static(reinterpret_cast<const char *>(pgm_read_ptr(kDataType))),
+      Symbol::Static(
+          reinterpret_cast<const char *>(pgm_read_ptr(kDataType + 1)))};
+  return kSymbols[datatype];
 }
 
 bool DHT22::IsValid(uint8_t datatype_idx) const {
@@ -39,14 +41,19 @@ DeviceDataType DHT22::GetReading(uint8_t datatype_idx) const {
   return DeviceDataType(double(data_[datatype_idx]));
 }
 
-std::string DHT22::GetSensorType() const {
-  return kSensorType;
+Symbol DHT22::GetSensorType() const {
+  static const Symbol kSymbol = Symbol::Static(kSensorType);
+  return kSymbol;
 }
 
-std::string DHT22::GetUnit(uint8_t datatype_idx) const {
-  const char* p = reinterpret_cast<const char*>(
-      pgm_read_ptr(kUnitName + datatype_idx));
-  return p + (!datatype_idx);  // A hack for wide char °
+Symbol DHT22::GetUnit(uint8_t datatype_idx) const {
+  static const Symbol kSymbols[] = {
+      // A hack for wide char °
+      Symbol::Static(
+          reinterpret_cast<const char *>(pgm_read_ptr(kUnitName)) + 1),
+      Symbol::Static(
+          reinterpret_cast<const char *>(pgm_read_ptr(kUnitName + 1)))};
+  return kSymbols[datatype_idx];
 }
 
 DHT22::~DHT22() {
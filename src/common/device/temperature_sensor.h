@@ -17,11 +17,11 @@ public:
   };
 
   bool UpdateReading() override;
-  std::string GetDataType(uint8_t datatype_idx = 0) const override;
+  Symbol GetDataType(uint8_t datatype_idx = 0) const override;
   bool IsValid(uint8_t datatype_idx = 0) const override;
-  std::string GetUnit(uint8_t datatype_idx = 0) const override;
+  Symbol GetUnit(uint8_t datatype_idx = 0) const override;
   DeviceDataType GetReading(uint8_t datatype_idx = 0) const override;
-  std::string GetSensorType() const override;
+  Symbol GetSensorType() const override;
 
 private:
   static PROGMEM const char *const kSensorType;
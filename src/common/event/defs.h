@@ -3,10 +3,78 @@
 #include <inttypes.h>
 #include <ArduinoJson.h>
 
+#include "common/com/schema.h"
+#include "common/com/specialized_encoding.h"
 #include "common/stl/string.h"
 #include "common/time/time.h"
+#include "common/utility/symbol.h"
 #include "common/utility/variant.h"
 
+// Wire encoding of Event and SensorReading. Both ends of a link must agree,
+// FixedEncoding keeps the layout existing peers expect.
+#ifndef COMMON_EVENT_ENCODING
+#define COMMON_EVENT_ENCODING common::com::FixedEncoding
+#endif
+
+#ifndef COMMON_SENSOR_READING_ENCODING
+#define COMMON_SENSOR_READING_ENCODING common::com::FixedEncoding
+#endif
+
+namespace common::com {
+
+// Times travel as whole seconds.
+template <>
+struct FieldCodec<Time> {
+  static constexpr size_t kSize = sizeof(uint32_t);
+  static constexpr bool kFixedLayout = true;
+
+  template <typename Policy, typename Sink>
+  static inline void Encode(const Time &value, Sink &sink) {
+    common::com::Encode(value.Sec(), sink);
+  }
+
+  template <typename Policy>
+  static inline bool Decode(ByteSpan &span, Time &value) {
+    uint32_t sec{0};
+    if (!common::com::Decode(span, sec)) {
+      return false;
+    }
+    value = Time::FromSec(sec);
+    return true;
+  }
+};
+
+// Symbols travel as their text, exactly like a std::string, handles are only
+// meaningful on the device that interned them. Decoding looks the text up
+// and keeps a private copy when it is not interned, see Symbol::Decode().
+template <>
+struct FieldCodec<Symbol> {
+  static constexpr size_t kSize = sizeof(uint32_t);
+  static constexpr bool kFixedLayout = false;
+
+  template <typename Policy, typename Sink>
+  static inline void Encode(const Symbol &value, Sink &sink) {
+    Policy::EncodeInt(static_cast<uint32_t>(value.Size()), sink);
+    value.Write(sink);
+  }
+
+  template <typename Policy>
+  static inline bool Decode(ByteSpan &span, Symbol &value) {
+    StringView text;
+    return View<Policy>(span, text) &&
+           Symbol::Decode(text.Data(), text.Size(), value);
+  }
+
+  using ViewType = StringView;
+
+  template <typename Policy>
+  static inline bool View(ByteSpan &span, StringView &value) {
+    return FieldCodec<std::string>::View<Policy>(span, value);
+  }
+};
+
+}  // namespace common::com
+
 namespace common {
 
 enum LogLevel : int8_t {
@@ -29,14 +97,23 @@ std::string ToString(LogLevel item);
 std::string ToString(Error item);
 
 struct Event {
+  using EncodingPolicy = COMMON_EVENT_ENCODING;
+
   Time time{Time::FromSec(0)};
 
   LogLevel level{LOGLEVEL_INFO};
   uint8_t error_code{0};
-  std::string source_name{""};
+  Symbol source_name{};
 
   std::string event_msg{""};
 
+  using Schema = common::com::Schema<
+      common::com::Field<&Event::time>,
+      common::com::Field<&Event::level, uint8_t>,
+      common::com::Field<&Event::error_code>,
+      common::com::Field<&Event::source_name>,
+      common::com::Field<&Event::event_msg>>;
+
   void Encode(std::string& msg) const;
   void Decode(const std::string& msg);
   DynamicJsonDocument ToJson() const;
@@ -45,19 +122,33 @@ struct Event {
 using DeviceDataType= Variant<double, int>;
 
 struct SensorReading {
+  using EncodingPolicy = COMMON_SENSOR_READING_ENCODING;
+
   Time time{Time::FromSec(0)};
 
-  std::string sensor_id{""};
-  std::string sensor_type{""};
+  Symbol sensor_id{};
+  Symbol sensor_type{};
 
-  std::string data_type{""};
+  Symbol data_type{};
 
   DeviceDataType reading;
-  std::string unit{""};
+  Symbol unit{};
+
+  using Schema = common::com::Schema<
+      common::com::Field<&SensorReading::time>,
+      common::com::Field<&SensorReading::reading>,
+      common::com::Field<&SensorReading::sensor_id>,
+      common::com::Field<&SensorReading::sensor_type>,
+      common::com::Field<&SensorReading::data_type>,
+      common::com::Field<&SensorReading::unit>>;
 
   void Encode(std::string &msg) const;
   void Decode(const std::string& msg);
   DynamicJsonDocument ToJson() const;
 };
 
+// Zero copy access to encoded messages, e.g. to route on a few fields.
+using EventView = common::com::MessageView<Event>;
+using SensorReadingView = common::com::MessageView<SensorReading>;
+
 }  // namespace common
@@ -0,0 +1,132 @@
+#include "common/event/sensor_reading_batch.h"
+
+namespace common {
+
+uint8_t SensorReadingBatch::Intern(const Symbol &symbol) {
+  for (size_t i{0}; i < dictionary_.size(); ++i) {
+    if (dictionary_[i] == symbol) {
+      return i;
+    }
+  }
+  if (dictionary_.size() == kMaxStrings) {
+    return kMaxStrings;
+  }
+  dictionary_.push_back(symbol);
+  return dictionary_.size() - 1;
+}
+
+bool SensorReadingBatch::Add(const SensorReading &reading) {
+  if (times_.size() == kMaxReadings) {
+    return false;
+  }
+  size_t dictionary_size = dictionary_.size();
+  Keys keys{Intern(reading.sensor_id), Intern(reading.sensor_type),
+            Intern(reading.data_type), Intern(reading.unit)};
+  if (keys.sensor_id == kMaxStrings || keys.sensor_type == kMaxStrings ||
+      keys.data_type == kMaxStrings || keys.unit == kMaxStrings) {
+    dictionary_.resize(dictionary_size);
+    return false;
+  }
+  times_.push_back(reading.time.Sec());
+  keys_.push_back(keys);
+  readings_.push_back(reading.reading);
+  return true;
+}
+
+void SensorReadingBatch::Clear() {
+  dictionary_.clear();
+  times_.clear();
+  keys_.clear();
+  readings_.clear();
+}
+
+SensorReading SensorReadingBatch::Get(size_t i) const {
+  SensorReading reading;
+  reading.time = Time::FromSec(times_[i]);
+  reading.sensor_id = dictionary_[keys_[i].sensor_id];
+  reading.sensor_type = dictionary_[keys_[i].sensor_type];
+  reading.data_type = dictionary_[keys_[i].data_type];
+  reading.unit = dictionary_[keys_[i].unit];
+  reading.reading = readings_[i];
+  return reading;
+}
+
+bool SensorReadingBatch::DecodeKeys(uint8_t Keys::*key,
+                                    common::com::ByteSpan &span) {
+  const char *column = span.Consume(keys_.size());
+  if (!column) {
+    return false;
+  }
+  for (size_t i{0}; i < keys_.size(); ++i) {
+    uint8_t index = static_cast<uint8_t>(column[i]);
+    if (index >= dictionary_.size()) {
+      return false;
+    }
+    keys_[i].*key = index;
+  }
+  return true;
+}
+
+// Leaves the batch empty and the span bad on malformed input.
+void SensorReadingBatch::Decode(common::com::ByteSpan &span) {
+  Clear();
+  uint16_t count{0};
+  uint8_t dictionary_size{0};
+  bool ok = Policy::DecodeInt(span, count) &&
+            common::com::Decode(span, dictionary_size) &&
+            // Every string takes at least one byte, every reading five.
+            span.Remaining() >= dictionary_size + count * size_t{5};
+  if (ok) {
+    dictionary_.resize(dictionary_size);
+  }
+  for (size_t i{0}; ok && i < dictionary_.size(); ++i) {
+    ok = common::com::FieldCodec<Symbol>::Decode<Policy>(span, dictionary_[i]);
+  }
+  if (ok && count) {
+    ok = DecodeColumns(count, span);
+  }
+  if (!ok || !span.Ok()) {
+    Clear();
+    span.Fail();
+  }
+}
+
+bool SensorReadingBatch::DecodeColumns(uint16_t count,
+                                       common::com::ByteSpan &span) {
+  times_.resize(count);
+  bool ok = common::com::Decode(span, times_[0]);
+  for (size_t i{1}; ok && i < count; ++i) {
+    int32_t delta{0};
+    ok = Policy::DecodeInt(span, delta);
+    times_[i] = times_[i - 1] + static_cast<uint32_t>(delta);
+  }
+
+  keys_.resize(count);
+  ok = ok && DecodeKeys(&Keys::sensor_id, span) &&
+       DecodeKeys(&Keys::sensor_type, span) &&
+       DecodeKeys(&Keys::data_type, span) && DecodeKeys(&Keys::unit, span);
+
+  const char *tags = ok ? span.Consume(count) : nullptr;
+  ok = tags;
+  for (size_t i{0}; ok && i < count; ++i) {
+    ok = static_cast<uint8_t>(tags[i]) <= DeviceDataType::Size();
+  }
+  readings_.resize(count);
+  for (size_t i{0}; ok && i < count; ++i) {
+    if (tags[i] == 1) {
+      double value{0};
+      ok = common::com::Decode(span, value);
+      readings_[i].Emplace<double>(value);
+    }
+  }
+  for (size_t i{0}; ok && i < count; ++i) {
+    if (tags[i] == 2) {
+      int value{0};
+      ok = Policy::DecodeInt(span, value);
+      readings_[i].Emplace<int>(value);
+    }
+  }
+  return ok;
+}
+
+}  // namespace common
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <vector>
+
+#include "common/event/defs.h"
+
+namespace common {
+
+// SensorReadings stored and encoded as columns: the symbols go to a shared
+// dictionary and every reading keeps four one byte keys, timestamps are
+// zigzag varint deltas and readings are packed per type (tags, then the
+// doubles, then the ints as varints). A batch of readings from a handful of
+// sensors encodes to a fraction of the readings encoded one by one.
+//
+// Layout: count | dictionary | first sec | sec deltas | key columns | tags |
+// doubles | ints, counts and sizes as varints.
+class SensorReadingBatch {
+public:
+  static constexpr uint8_t kMaxStrings = 255;
+  static constexpr uint16_t kMaxReadings = 0xFFFF;
+
+  // Dictionary indices of a reading's strings.
+  struct Keys {
+    uint8_t sensor_id;
+    uint8_t sensor_type;
+    uint8_t data_type;
+    uint8_t unit;
+  };
+
+  // Fails, leaving the batch unchanged, once the dictionary or the batch is
+  // full.
+  bool Add(const SensorReading &reading);
+
+  void Clear();
+
+  // Materializes the i-th reading.
+  SensorReading Get(size_t i) const;
+
+  inline size_t Size() const {
+    return times_.size();
+  }
+
+  inline bool Empty() const {
+    return times_.empty();
+  }
+
+  // Column access, the same order as Add().
+  inline const std::vector<uint32_t> &Times() const {
+    return times_;
+  }
+
+  inline const std::vector<Keys> &KeyColumn() const {
+    return keys_;
+  }
+
+  inline const std::vector<DeviceDataType> &Readings() const {
+    return readings_;
+  }
+
+  inline const Symbol &String(uint8_t key) const {
+    return dictionary_[key];
+  }
+
+  template <typename Sink>
+  void Encode(Sink &sink) const;
+  void Decode(common::com::ByteSpan &span);
+
+private:
+  using Policy = common::com::CompactEncoding;
+
+  // Index of symbol in the dictionary, added if missing. kMaxStrings when
+  // full.
+  uint8_t Intern(const Symbol &symbol);
+
+  template <typename Sink>
+  void EncodeKeys(uint8_t Keys::*key, Sink &sink) const;
+  bool DecodeKeys(uint8_t Keys::*key, common::com::ByteSpan &span);
+  bool DecodeColumns(uint16_t count, common::com::ByteSpan &span);
+
+  std::vector<Symbol> dictionary_{};
+  std::vector<uint32_t> times_{};
+  std::vector<Keys> keys_{};
+  std::vector<DeviceDataType> readings_{};
+};
+
+template <typename Sink>
+void SensorReadingBatch::Encode(Sink &sink) const {
+  Policy::EncodeInt(static_cast<uint16_t>(times_.size()), sink);
+  common::com::Encode(static_cast<uint8_t>(dictionary_.size()), sink);
+  for (const auto &symbol : dictionary_) {
+    common::com::FieldCodec<Symbol>::Encode<Policy>(symbol, sink);
+  }
+  if (times_.empty()) {
+    return;
+  }
+
+  common::com::Encode(times_[0], sink);
+  for (size_t i{1}; i < times_.size(); ++i) {
+    Policy::EncodeInt(static_cast<int32_t>(times_[i] - times_[i - 1]), sink);
+  }
+
+  EncodeKeys(&Keys::sensor_id, sink);
+  EncodeKeys(&Keys::sensor_type, sink);
+  EncodeKeys(&Keys::data_type, sink);
+  EncodeKeys(&Keys::unit, sink);
+
+  for (const auto &reading : readings_) {
+    common::com::Encode(static_cast<uint8_t>(
+        reading.Index() < DeviceDataType::Size() ? reading.Index() + 1 : 0),
+        sink);
+  }
+  for (const auto &reading : readings_) {
+    if (const double *value = reading.GetIf<double>()) {
+      common::com::Encode(*value, sink);
+    }
+  }
+  for (const auto &reading : readings_) {
+    if (const int *value = reading.GetIf<int>()) {
+      Policy::EncodeInt(*value, sink);
+    }
+  }
+}
+
+template <typename Sink>
+void SensorReadingBatch::EncodeKeys(uint8_t Keys::*key, Sink &sink) const {
+  for (const auto &keys : keys_) {
+    common::com::Encode(keys.*key, sink);
+  }
+}
+
+}  // namespace common
@@ -0,0 +1,58 @@
+#include "common/event/sensor_reading_series.h"
+
+namespace common {
+
+bool SensorReadingSeries::Matches(const SensorReading &reading) const {
+  return Empty() || (metadata_.sensor_id == reading.sensor_id &&
+                     metadata_.data_type == reading.data_type);
+}
+
+void SensorReadingSeries::Add(const SensorReading &reading) {
+  if (count_) {
+    Clear();
+  }
+  if (Empty()) {
+    metadata_.sensor_id = reading.sensor_id;
+    metadata_.sensor_type = reading.sensor_type;
+    metadata_.data_type = reading.data_type;
+    metadata_.unit = reading.unit;
+  }
+  double value{0};
+  common::Visit([&value](const auto &alternative) {
+    value = alternative;
+  }, reading.reading);
+  common::com::StringSink sink(stream_);
+  encoder_.Append(reading.time.Sec(), value, sink);
+}
+
+void SensorReadingSeries::Clear() {
+  metadata_ = SensorReading();
+  encoder_.Reset();
+  stream_.clear();
+  count_ = 0;
+}
+
+// Leaves the series empty and the span bad on malformed input. A decoded
+// series is read only, Add() starts a new one.
+void SensorReadingSeries::Decode(common::com::ByteSpan &span) {
+  Clear();
+  uint32_t count{0};
+  uint32_t size{0};
+  const char *stream{nullptr};
+  using Codec = common::com::FieldCodec<Symbol>;
+  bool ok = Codec::Decode<Policy>(span, metadata_.sensor_id) &&
+            Codec::Decode<Policy>(span, metadata_.sensor_type) &&
+            Codec::Decode<Policy>(span, metadata_.data_type) &&
+            Codec::Decode<Policy>(span, metadata_.unit) &&
+            Policy::DecodeInt(span, count) && Policy::DecodeInt(span, size) &&
+            (stream = span.Consume(size));
+  if (!ok) {
+    Clear();
+    span.Fail();
+    return;
+  }
+  stream_.assign(stream, size);
+  count_ = count;
+}
+
+}  // namespace common
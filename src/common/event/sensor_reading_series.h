@@ -0,0 +1,99 @@
+#pragma once
+
+#include "common/com/gorilla.h"
+#include "common/event/defs.h"
+
+namespace common {
+
+// Readings of a single sensor (sensor_id and data_type) compressed as a
+// Gorilla stream: the strings once, then about a bit per sample for a
+// reading that keeps its value and a regular period. Integer readings come
+// back as doubles.
+//
+// Layout: sensor_id | sensor_type | data_type | unit | count | stream size |
+// stream, counts and sizes as varints.
+class SensorReadingSeries {
+public:
+  // Whether reading belongs to this series, any reading does while empty.
+  bool Matches(const SensorReading &reading) const;
+
+  // The first reading sets the symbols of the series.
+  void Add(const SensorReading &reading);
+
+  void Clear();
+
+  inline uint32_t Size() const {
+    return encoder_.Count() ? encoder_.Count() : count_;
+  }
+
+  inline bool Empty() const {
+    return !Size();
+  }
+
+  // Symbols of the series, the reading is left empty.
+  inline const SensorReading &Metadata() const {
+    return metadata_;
+  }
+
+  // Calls fn(uint32_t sec, double value) for every sample, false if the
+  // stream is corrupted.
+  template <typename Fn>
+  bool ForEach(Fn fn) const;
+
+  template <typename Sink>
+  void Encode(Sink &sink) const;
+  void Decode(common::com::ByteSpan &span);
+
+private:
+  using Policy = common::com::CompactEncoding;
+
+  SensorReading metadata_{};
+  common::com::GorillaEncoder encoder_{};
+  // Whole bytes of the stream, the encoder holds the partial last one.
+  std::string stream_{};
+  // Number of samples of a decoded series, which has no encoder state.
+  uint32_t count_{0};
+};
+
+template <typename Fn>
+bool SensorReadingSeries::ForEach(Fn fn) const {
+  std::string stream;
+  common::com::StringSink sink(stream);
+  sink.Write(stream_.c_str(), stream_.size());
+  common::com::GorillaEncoder encoder = encoder_;
+  encoder.Finish(sink);
+
+  common::com::ByteSpan span(stream);
+  common::com::GorillaDecoder decoder(span);
+  for (uint32_t i{0}; i < Size(); ++i) {
+    uint32_t sec;
+    double value;
+    if (!decoder.Next(sec, value)) {
+      return false;
+    }
+    fn(sec, value);
+  }
+  return true;
+}
+
+template <typename Sink>
+void SensorReadingSeries::Encode(Sink &sink) const {
+  using Codec = common::com::FieldCodec<Symbol>;
+  Codec::Encode<Policy>(metadata_.sensor_id, sink);
+  Codec::Encode<Policy>(metadata_.sensor_type, sink);
+  Codec::Encode<Policy>(metadata_.data_type, sink);
+  Codec::Encode<Policy>(metadata_.unit, sink);
+  Policy::EncodeInt(Size(), sink);
+
+  // The pending bits are flushed by a copy, the series can keep growing.
+  common::com::CountingSink pending;
+  common::com::GorillaEncoder encoder = encoder_;
+  encoder.Finish(pending);
+  Policy::EncodeInt(static_cast<uint32_t>(stream_.size() + pending.Size()),
+                    sink);
+  sink.Write(stream_.c_str(), stream_.size());
+  encoder = encoder_;
+  encoder.Finish(sink);
+}
+
+}  // namespace common
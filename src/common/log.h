@@ -1,15 +1,70 @@
 #pragma once
 
+#include "common/binary_log.h"
 #include "common/event/defs.h"
+#include "common/log_limiter.h"
 #include "common/stream_handler/lcd_handler.h"
 #include "common/stream_handler/file_handler.h"
 #include "common/stream_handler/serial_handler.h"
 #include "common/stl/string.h"
+#include "common/utility/format.h"
+#include "common/utility/ring_buffer.h"
 #include "common/utility/utility.h"
 
+#ifdef COMMON_LOG_THREAD
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+// Log calls below this level are compiled out, e.g.
+// -DCOMMON_LOG_MIN_LEVEL=common::LOGLEVEL_INFO. Debug is dropped by default
+// when NDEBUG is defined.
+#ifndef COMMON_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define COMMON_LOG_MIN_LEVEL common::LOGLEVEL_INFO
+#else
+#define COMMON_LOG_MIN_LEVEL common::LOGLEVEL_DEBUG
+#endif
+#endif
+
+// Messages a Log queues for Pump(), see LogQueuePolicy.
+#ifndef COMMON_LOG_QUEUE_SIZE
+#define COMMON_LOG_QUEUE_SIZE 8
+#endif
+
 namespace common {
 
+enum class LogQueuePolicy : uint8_t {
+  // Handlers run in the caller.
+  kSync,
+  // Messages wait for Log::Pump(), a full queue drops its oldest message.
+  kDropOldest,
+  // Same, but a full queue drops the message being logged.
+  kDropNewest,
+};
+
+struct LogQueueStats {
+  uint32_t queued{0};
+  uint32_t delivered{0};
+  uint32_t dropped{0};
+  uint16_t max_pending{0};
+};
+
 namespace detail {
+
+// The queue is only shared with a thread on hosts built with
+// COMMON_LOG_THREAD.
+#ifdef COMMON_LOG_THREAD
+using LogMutex = std::mutex;
+using LogLock = std::lock_guard<std::mutex>;
+#else
+struct LogMutex {};
+struct LogLock {
+  explicit LogLock(LogMutex &) {}
+};
+#endif
+
 void FormatImpl(std::string &msg, const std::string &item) {
   auto pos = msg.find("%%");
   if (pos != std::string::npos) {
@@ -54,10 +109,19 @@ std::string Format(const char *msg, const Args &...args) {
   return msg_str;
 }
 
+// Compile time checked, see COMMON_FORMAT.
+template<typename Literal, typename ...Args>
+std::string Format(FormatString<Literal> msg, const Args &...args) {
+  return common::Format(msg, args...);
+}
+
 } // namespace detail
 
 class Log {
 public:
+  // Calls below it compile to nothing, their arguments aside.
+  static constexpr LogLevel kMinLevel = COMMON_LOG_MIN_LEVEL;
+
   Log() = delete;
   explicit Log(const char* name) : name_{name} {
     Init();
@@ -67,116 +131,415 @@ public:
     Init();
   }
 
-  ~Log() = default;
+  ~Log() {
+#ifdef COMMON_LOG_THREAD
+    StopWorker();
+#endif
+  }
 
   void AddStreamHandler(StreamHandler *handler, LogLevel level) {
     handlers_.push_back(std::make_pair(handler, level));
+    if (level < min_level_) {
+      min_level_ = level;
+    }
   }
 
   void AddStructuredStreamHandler(StreamHandler *handler) {
     structured_handlers_.push_back(handler);
   }
 
-  template <typename ...Args>
-  void Debug(const std::string& msg) {
-    LogImpl(msg, 0, LogLevel::LOGLEVEL_DEBUG);
+  // Whether a message of this level reaches any handler. Nothing is
+  // formatted, allocated or timestamped for the others, check it before
+  // computing costly arguments.
+  inline bool Enabled(LogLevel level) const {
+    return level >= kMinLevel && level >= min_level_;
+  }
+
+  // msg is a std::string or a C string with `%%` placeholders, or a
+  // COMMON_FORMAT string whose placeholder / argument count mismatch does
+  // not compile.
+  template <typename Msg, typename ...Args>
+  void Debug(const Msg& msg, const Args&... args) {
+    LogImpl<LogLevel::LOGLEVEL_DEBUG>(0, msg, args...);
+  }
+
+  template <typename Msg, typename ...Args>
+  void Info(const Msg& msg, const Args&... args) {
+    LogImpl<LogLevel::LOGLEVEL_INFO>(0, msg, args...);
+  }
+
+  template <typename Msg, typename ...Args>
+  void Warn(uint8_t error_code, const Msg& msg, const Args&... args) {
+    LogImpl<LogLevel::LOGLEVEL_WARN>(error_code, msg, args...);
+  }
+
+  template <typename Msg, typename ...Args>
+  void Error(uint8_t error_code, const Msg& msg, const Args&... args) {
+    LogImpl<LogLevel::LOGLEVEL_ERROR>(error_code, msg, args...);
+  }
+
+  template <typename Msg, typename ...Args>
+  void Fatal(uint8_t error_code, const Msg& msg, const Args&... args) {
+    LogImpl<LogLevel::LOGLEVEL_FATAL>(error_code, msg, args...);
+  }
+
+  // Repeats of a message (same template and error code) within window_ms
+  // of its first occurrence are counted instead of logged, a "repeated N
+  // more times" message follows once the window closes. 0 turns it off.
+  void SetCoalesceWindow(uint16_t window_ms) {
+    detail::LogLock lock(mutex_);
+    limiter_.SetWindow(window_ms);
   }
 
-  template <typename ...Args>
-  void Info(const std::string& msg) {
-    LogImpl(msg, 0, LogLevel::LOGLEVEL_INFO);
+  // At most burst messages at once, refilled at per_minute, the others are
+  // counted and reported once there is room again. A burst of 0 turns it
+  // off.
+  void SetRateLimit(uint8_t burst, uint16_t per_minute) {
+    detail::LogLock lock(mutex_);
+    limiter_.SetRate(burst, per_minute, millis());
   }
 
-  template <typename ...Args>
-  void Warn(uint8_t error_code, const std::string& msg) {
-    LogImpl(msg, error_code, LogLevel::LOGLEVEL_WARN);
+  LogLimitStats GetLimitStats() const {
+    detail::LogLock lock(mutex_);
+    return limiter_.GetStats();
   }
 
-  template <typename ...Args>
-  void Error(uint8_t error_code, const std::string& msg) {
-    LogImpl(msg, error_code, LogLevel::LOGLEVEL_ERROR);
+  // COMMON_FORMAT messages then go to the handlers' LogBinary() as binary
+  // records, unformatted (see binary_log.h), other messages stay text.
+  void SetBinary(bool binary) {
+    detail::LogLock lock(mutex_);
+    binary_ = binary;
   }
 
-  template <typename ...Args>
-  void Fatal(uint8_t error_code, const std::string& msg) {
-    LogImpl(msg, error_code, LogLevel::LOGLEVEL_FATAL);
+  // Queues messages for Pump() instead of running the handlers in the
+  // caller, a slow handler (serial at 9600 baud, an SD append) then no longer
+  // stalls the control loop. Going back to kSync delivers what is pending.
+  // Structured logging always runs in the caller.
+  void SetQueuePolicy(LogQueuePolicy policy) {
+    if (policy == LogQueuePolicy::kSync) {
+      Pump();
+    }
+    // A worker may be draining the queue.
+    detail::LogLock lock(mutex_);
+    if (policy == LogQueuePolicy::kSync) {
+      queue_.reset();
+    } else if (!queue_.get()) {
+      queue_.reset(new Queue());
+    }
+    policy_ = policy;
   }
 
-  template <typename ...Args>
-  void Debug(const std::string& msg, const Args&... args) {
-    LogImpl(msg, 0, LogLevel::LOGLEVEL_DEBUG, args...);
+  // Delivers queued messages, to be called from loop(). Stops once the
+  // queue is empty or budget_us is spent (0 for no limit), at least one
+  // message is delivered. Returns the number delivered. Flood control
+  // summaries that are due go out first, without Pump() they wait for the
+  // next message.
+  uint16_t Pump(uint32_t budget_us = 0) {
+    if (Limiting()) {
+      EmitSummaries(millis());
+    }
+    uint32_t start = micros();
+    uint16_t count{0};
+    Event event;
+    while (PopQueued(event)) {
+      Deliver(event);
+      ++count;
+      if (budget_us && micros() - start >= budget_us) {
+        break;
+      }
+    }
+    return count;
   }
 
-  template <typename ...Args>
-  void Info(const std::string& msg, const Args&... args) {
-    LogImpl(msg, 0, LogLevel::LOGLEVEL_INFO, args...);
+  uint16_t Pending() const {
+    detail::LogLock lock(mutex_);
+    return queue_.get() ? queue_->Size() : 0;
   }
 
-  template <typename ...Args>
-  void Warn(uint8_t error_code, const std::string& msg, const Args&... args) {
-    LogImpl(msg, error_code, LogLevel::LOGLEVEL_WARN, args...);
+  LogQueueStats GetQueueStats() const {
+    detail::LogLock lock(mutex_);
+    return stats_;
   }
 
-  template <typename ...Args>
-  void Error(uint8_t error_code, const std::string& msg, const Args&... args) {
-    LogImpl(msg, error_code, LogLevel::LOGLEVEL_ERROR, args...);
+#ifdef COMMON_LOG_THREAD
+  // Drains the queue from a thread instead of Pump(), set a queue policy
+  // first. Handlers then run on that thread.
+  void StartWorker() {
+    if (!worker_.joinable()) {
+      running_ = true;
+      worker_ = std::thread([this] { Work(); });
+    }
   }
 
-  template <typename ...Args>
-  void Fatal(uint8_t error_code, const std::string& msg, const Args&... args) {
-    LogImpl(msg, error_code, LogLevel::LOGLEVEL_FATAL, args...);
+  // Delivers what is left and joins the thread.
+  void StopWorker() {
+    {
+      detail::LogLock lock(mutex_);
+      running_ = false;
+    }
+    wake_.notify_one();
+    if (worker_.joinable()) {
+      worker_.join();
+    }
   }
+#endif
 
   void LogStructured(const SensorReading &msg) {
+    detail::LogLock lock(handler_mutex_);
     for (auto handler : structured_handlers_) {
       handler->LogStructured(msg);
     }
   }
 
+  void LogStructured(const SensorReadingBatch &batch) {
+    detail::LogLock lock(handler_mutex_);
+    for (auto handler : structured_handlers_) {
+      handler->LogStructured(batch);
+    }
+  }
+
   void LogEvent(const Event &msg) {
-    for (auto& handler : handlers_) {
-      if (msg.level >= handler.second) {
-        handler.first->Log(msg);
-      }
+    if (!Enabled(msg.level)) {
+      return;
+    }
+    Event event(msg);
+    if (!Enqueue(event)) {
+      Deliver(event);
     }
   }
 
 private:
   void Init() {
+    source_ = Symbol(name_);
     txt_logger_.reset(new FileHandler("log", name_));
     serial_logger_.reset(new SerialHandler());
-    handlers_.push_back(
-        std::make_pair(txt_logger_.get(), LogLevel::LOGLEVEL_INFO));
+    AddStreamHandler(txt_logger_.get(), LogLevel::LOGLEVEL_INFO);
     structured_handlers_.push_back(txt_logger_.get());
-    handlers_.push_back(
-        std::make_pair(serial_logger_.get(), LogLevel::LOGLEVEL_INFO));
+    AddStreamHandler(serial_logger_.get(), LogLevel::LOGLEVEL_INFO);
     structured_handlers_.push_back(serial_logger_.get());
   }
 
-  template <typename ...Args, uint8_t N = sizeof...(Args)>
-  void LogImpl(const std::string& msg, uint8_t error_code, LogLevel level) {
-    Event event{Time::Now(), level, error_code, name_, common::move(msg)};
+  template <LogLevel Level, typename Msg, typename ...Args>
+  void LogImpl(uint8_t error_code, const Msg& msg, const Args&... args) {
+    if constexpr (Level >= kMinLevel) {
+      if (Level < min_level_) {
+        return;
+      }
+      if (Limiting() && !Admit(Level, error_code, msg)) {
+        return;
+      }
+      Emit(Level, error_code, msg, args...);
+    }
+  }
+
+  template <typename Msg, typename ...Args>
+  void Emit(LogLevel level, uint8_t error_code, const Msg& msg,
+            const Args&... args) {
+    if constexpr (IsFormatString<Msg>::value) {
+      if (Binary()) {
+        DispatchBinary(level, error_code, msg, args...);
+        return;
+      }
+    }
+    Dispatch(level, error_code, MakeMessage(msg, args...));
+  }
+
+  // The settings are read under the lock, a worker thread's Pump() reads
+  // them too.
+  bool Limiting() const {
+    detail::LogLock lock(mutex_);
+    return limiter_.Active();
+  }
+
+  bool Binary() const {
+    detail::LogLock lock(mutex_);
+    return binary_;
+  }
+
+  // Flood control, before anything is formatted. Due summaries go first.
+  template <typename Msg>
+  bool Admit(LogLevel level, uint8_t error_code, const Msg& msg) {
+    uint32_t now = millis();
+    EmitSummaries(now);
+    detail::LogLock lock(mutex_);
+    return limiter_.Admit(TemplateId(msg), error_code, level,
+                          TemplateFormat(msg), now);
+  }
+
+  void EmitSummaries(uint32_t now_ms) {
+    LogLimiter::Summary summary;
+    while (true) {
+      {
+        detail::LogLock lock(mutex_);
+        if (!limiter_.NextSummary(now_ms, summary)) {
+          return;
+        }
+      }
+      if (summary.rate_limited) {
+        Emit(summary.level, 0,
+             COMMON_FORMAT("%% messages dropped by the rate limit"),
+             summary.count);
+      } else if (summary.format) {
+        Emit(summary.level, summary.error_code,
+             COMMON_FORMAT("repeated %% more times: %%"), summary.count,
+             summary.format);
+      } else {
+        Emit(summary.level, summary.error_code,
+             COMMON_FORMAT("message %% repeated %% more times"), summary.id,
+             summary.count);
+      }
+    }
+  }
+
+  template <typename Literal>
+  static uint16_t TemplateId(FormatString<Literal>) {
+    return FormatString<Literal>::kId;
+  }
+
+  static uint16_t TemplateId(const char* msg) {
+    return detail::FormatId(msg);
+  }
+
+  static uint16_t TemplateId(const std::string& msg) {
+    return detail::FormatId(msg.c_str());
+  }
+
+  // Only format string literals outlive the call.
+  template <typename Literal>
+  static const char* TemplateFormat(FormatString<Literal> msg) {
+    return msg.Data();
+  }
+
+  template <typename Msg>
+  static const char* TemplateFormat(const Msg&) {
+    return nullptr;
+  }
+
+  // Binary records skip the queue, they are cheap to write.
+  template <typename Literal, typename ...Args>
+  void DispatchBinary(LogLevel level, uint8_t error_code,
+                      FormatString<Literal> msg, const Args&... args) {
+    Time time = Time::Now();
+    std::string record =
+        BinaryLogRecord(msg, level, error_code, time, args...);
+    detail::LogLock lock(handler_mutex_);
     for (auto &handler : handlers_) {
       if (handler.second <= level) {
+        handler.first->LogBinary(time, record);
+      }
+    }
+  }
+
+  template <typename Literal, typename ...Args>
+  static std::string MakeMessage(FormatString<Literal> msg,
+                                 const Args&... args) {
+    return common::Format(msg, args...);
+  }
+
+  template <typename Msg, typename ...Args>
+  static std::string MakeMessage(const Msg& msg, const Args&... args) {
+    std::string result(msg);
+    if constexpr (sizeof...(Args) > 0) {
+      detail::FormatImpl(result, args...);
+    }
+    return result;
+  }
+
+  void Dispatch(LogLevel level, uint8_t error_code, std::string msg) {
+    Event event{Time::Now(), level, error_code, source_, common::move(msg)};
+    if (!Enqueue(event)) {
+      Deliver(event);
+    }
+  }
+
+  void Deliver(const Event &event) {
+    detail::LogLock lock(handler_mutex_);
+    for (auto &handler : handlers_) {
+      if (handler.second <= event.level) {
         handler.first->Log(event);
       }
     }
   }
 
-  template <typename ...Args, uint8_t N = sizeof...(Args)>
-  void LogImpl(std::string msg, uint8_t error_code,
-               LogLevel level, const Args&... args) {
-    if (sizeof...(Args) || msg.find("%%") != std::string::npos) {
-      detail::FormatImpl(msg, args...);
+  // Moves event into the queue, false if there is no queue (any more).
+  bool Enqueue(Event &event) {
+    {
+      detail::LogLock lock(mutex_);
+      if (!queue_.get()) {
+        return false;
+      }
+      if (queue_->Full()) {
+        ++stats_.dropped;
+        if (policy_ == LogQueuePolicy::kDropNewest) {
+          return true;
+        }
+        queue_->PopFront();
+      }
+      queue_->PushBack(common::move(event));
+      ++stats_.queued;
+      if (queue_->Size() > stats_.max_pending) {
+        stats_.max_pending = queue_->Size();
+      }
+    }
+#ifdef COMMON_LOG_THREAD
+    wake_.notify_one();
+#endif
+    return true;
+  }
+
+  bool PopQueued(Event &event) {
+    detail::LogLock lock(mutex_);
+    if (!queue_.get() || queue_->Empty()) {
+      return false;
     }
-    LogImpl(msg, error_code, level);
+    event = common::move(queue_->Front());
+    queue_->PopFront();
+    ++stats_.delivered;
+    return true;
   }
 
+#ifdef COMMON_LOG_THREAD
+  void Work() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      wake_.wait(lock, [this] {
+        return !running_ || (queue_.get() && !queue_->Empty());
+      });
+      bool running = running_;
+      lock.unlock();
+      Pump();
+      if (!running) {
+        return;
+      }
+      lock.lock();
+    }
+  }
+#endif
+
   std::vector<std::pair<StreamHandler*, LogLevel>> handlers_{};
   std::vector<StreamHandler*> structured_handlers_{};
   std::auto_ptr<FileHandler> txt_logger_{nullptr};
   std::auto_ptr<SerialHandler> serial_logger_{nullptr};
   std::string name_;
+  Symbol source_{};
+  // Lowest level any handler accepts.
+  LogLevel min_level_{LogLevel::LOGLEVEL_SIZE};
+
+  using Queue = RingBuffer<Event, COMMON_LOG_QUEUE_SIZE>;
+  std::auto_ptr<Queue> queue_{nullptr};
+  LogQueuePolicy policy_{LogQueuePolicy::kSync};
+  bool binary_{false};
+  LogLimiter limiter_{};
+  LogQueueStats stats_{};
+  mutable detail::LogMutex mutex_{};
+  // Handlers run one at a time: binary records and structured logging stay
+  // in the caller while a worker delivers the queue.
+  detail::LogMutex handler_mutex_{};
+#ifdef COMMON_LOG_THREAD
+  std::condition_variable wake_{};
+  std::thread worker_{};
+  bool running_{false};
+#endif
 };
 
 }  // namespace common
@@ -0,0 +1,92 @@
+#include "common/log_limiter.h"
+
+namespace common {
+
+void LogLimiter::SetWindow(uint16_t window_ms) {
+  window_ms_ = window_ms;
+  if (!window_ms_) {
+    for (auto &slot : slots_) {
+      slot = Slot{};
+    }
+  }
+}
+
+void LogLimiter::SetRate(uint8_t burst, uint16_t per_minute,
+                         uint32_t now_ms) {
+  burst_ = burst;
+  per_minute_ = per_minute;
+  tokens_ = burst * kToken;
+  refill_ms_ = now_ms;
+  rate_limited_ = 0;
+}
+
+bool LogLimiter::TakeToken(uint32_t now_ms) {
+  if (!burst_) {
+    return true;
+  }
+  uint32_t elapsed = now_ms - refill_ms_;
+  uint32_t full = burst_ * kToken;
+  // Saturates instead of overflowing after a long idle time.
+  tokens_ = per_minute_ && elapsed >= (full - tokens_) / per_minute_
+                ? full
+                : tokens_ + elapsed * per_minute_;
+  refill_ms_ = now_ms;
+  if (tokens_ < kToken) {
+    return false;
+  }
+  tokens_ -= kToken;
+  return true;
+}
+
+bool LogLimiter::Admit(uint16_t id, uint8_t error_code, LogLevel level,
+                       const char *format, uint32_t now_ms) {
+  Slot *free_slot{nullptr};
+  for (uint8_t i{0}; window_ms_ && i < kSlots; ++i) {
+    Slot &slot = slots_[i];
+    bool open = slot.used && now_ms - slot.start_ms < window_ms_;
+    if (open && slot.id == id && slot.error_code == error_code) {
+      ++slot.count;
+      ++stats_.coalesced;
+      return false;
+    }
+    // A closed window is only reused once its summary went out.
+    if (!free_slot && !open && !slot.count) {
+      free_slot = &slot;
+    }
+  }
+
+  if (!TakeToken(now_ms)) {
+    ++rate_limited_;
+    ++stats_.rate_limited;
+    if (level > rate_limited_level_ || rate_limited_ == 1) {
+      rate_limited_level_ = level;
+    }
+    return false;
+  }
+  if (free_slot) {
+    *free_slot = Slot{format, now_ms, 0, id, error_code, level, true};
+  }
+  return true;
+}
+
+bool LogLimiter::NextSummary(uint32_t now_ms, Summary &summary) {
+  for (auto &slot : slots_) {
+    if (slot.count && now_ms - slot.start_ms >= window_ms_) {
+      if (!TakeToken(now_ms)) {
+        return false;
+      }
+      summary = Summary{slot.format, slot.id,    slot.error_code,
+                        slot.level,  slot.count, false};
+      slot = Slot{};
+      return true;
+    }
+  }
+  if (rate_limited_ && TakeToken(now_ms)) {
+    summary = Summary{nullptr, 0, 0, rate_limited_level_, rate_limited_, true};
+    rate_limited_ = 0;
+    return true;
+  }
+  return false;
+}
+
+}  // namespace common
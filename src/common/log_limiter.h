@@ -0,0 +1,90 @@
+#pragma once
+
+#include "common/event/defs.h"
+
+// Messages whose repeats are coalesced at the same time, more distinct
+// messages within a window are logged as they come.
+#ifndef COMMON_LOG_COALESCE_SLOTS
+#define COMMON_LOG_COALESCE_SLOTS 4
+#endif
+
+namespace common {
+
+struct LogLimitStats {
+  uint32_t coalesced{0};
+  uint32_t rate_limited{0};
+};
+
+// Flood control of a Log, both parts are off until configured.
+//
+// Coalescing: repeats of a message, the same template (format string, not
+// the formatted text) and error code, within a window of its first
+// occurrence are counted instead of logged. A summary is due once the
+// window closes.
+//
+// Rate limit: a token bucket of `burst` messages refilled at `per_minute`.
+// Repeats being coalesced take no token. Messages past the limit are
+// counted, a summary is due once a token is back.
+class LogLimiter {
+public:
+  static constexpr uint8_t kSlots = COMMON_LOG_COALESCE_SLOTS;
+
+  struct Summary {
+    // The format string when it is a literal, nullptr otherwise.
+    const char *format;
+    uint16_t id;
+    uint8_t error_code;
+    LogLevel level;
+    uint32_t count;
+    bool rate_limited;
+  };
+
+  // 0 turns coalescing off.
+  void SetWindow(uint16_t window_ms);
+  // A burst of 0 turns the rate limit off.
+  void SetRate(uint8_t burst, uint16_t per_minute, uint32_t now_ms);
+
+  inline bool Active() const {
+    return window_ms_ || burst_;
+  }
+
+  // Whether the message goes out, it is counted otherwise.
+  bool Admit(uint16_t id, uint8_t error_code, LogLevel level,
+             const char *format, uint32_t now_ms);
+
+  // Pops a due summary, false once there is none. Summaries take a token.
+  bool NextSummary(uint32_t now_ms, Summary &summary);
+
+  inline const LogLimitStats &GetStats() const {
+    return stats_;
+  }
+
+private:
+  // Tokens are kept in 1 / 60000 units, so per_minute of them are refilled
+  // every millisecond.
+  static constexpr uint32_t kToken = 60000;
+
+  struct Slot {
+    const char *format;
+    uint32_t start_ms;
+    uint32_t count;
+    uint16_t id;
+    uint8_t error_code;
+    LogLevel level;
+    bool used;
+  };
+
+  bool TakeToken(uint32_t now_ms);
+
+  Slot slots_[kSlots]{};
+  LogLimitStats stats_{};
+  uint32_t tokens_{0};
+  uint32_t refill_ms_{0};
+  uint32_t rate_limited_{0};
+  LogLevel rate_limited_level_{LogLevel::LOGLEVEL_DEBUG};
+  uint16_t window_ms_{0};
+  uint16_t per_minute_{0};
+  uint8_t burst_{0};
+};
+
+}  // namespace common
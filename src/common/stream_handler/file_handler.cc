@@ -18,10 +18,15 @@ void FileHandler::CreateDefaultFileHanderData() {
 }
 
 void FileHandler::LogImpl(const std::string &msg) {
+  LogImpl(msg.c_str(), msg.size());
+}
+
+void FileHandler::LogImpl(const char *data, size_t size) {
   if (!filesystem::Exists(file_path_.directory())) {
     filesystem::mkdir(file_path_.directory());
   }
   auto file = SD.open(file_path_.c_str(), O_RDWR | O_CREAT | O_APPEND);
+  file.write(reinterpret_cast<const uint8_t *>(data), size);
   file.flush();
   file.close();
 }
@@ -38,33 +43,104 @@ void FileHandler::Log(const std::string &msg) {
   lock = false;
 }
 
-void FileHandler::CheckAndRotate(const Time &t, bool structured) {
+void FileHandler::CheckAndRotate(const Time &t, const char *kind) {
   auto t_str = t.ToString();
   if (auto current_hour = t_str.substr(sizeof "-MM-DDT" - 1, 2);
-      current_hour_ != current_hour) {
+      current_hour_ != current_hour || current_kind_ != kind) {
     // Rotate
     current_hour_ = common::move(current_hour);
+    current_kind_ = kind;
     file_path_ = filesystem::Path(base_path_);
     file_path_ /= t_str.substr(1, 5);
     file_path_ /= current_hour_;
     if (!filesystem::Exists(file_path_.c_str())) {
       filesystem::mkdir(file_path_.c_str());
     }
-    file_path_ /= structured ? (name_ + ".s" + current_hour_) :
-                               (name_ + "." + current_hour_);
+    file_path_ /= name_ + "." + kind + current_hour_;
   }
 }
 
 void FileHandler::Log(const Event &msg) {
-  CheckAndRotate(msg.time, false);
+  CheckAndRotate(msg.time, kText);
   LogImpl(GenerateTextLogFromEvent(msg));
 }
 
 void FileHandler::LogStructured(const SensorReading &msg) {
-  CheckAndRotate(msg.time, true);
+  if (format_ == StructuredFormat::kSeries) {
+    LogSeries(msg);
+    return;
+  }
+  CheckAndRotate(msg.time, kStructured);
   std::string json_str;
   serializeJson(msg.ToJson(), json_str);
   LogImpl(json_str);
 }
 
+void FileHandler::LogBinary(const Time &time, const std::string &record) {
+  CheckAndRotate(time, kBinary);
+  LogImpl(record);
+}
+
+void FileHandler::LogStructured(const SensorReadingBatch &batch) {
+  if (batch.Empty()) {
+    return;
+  }
+  CheckAndRotate(Time::FromSec(batch.Times()[0]), kBatch);
+  std::string record;
+  common::com::CountingSink counter;
+  batch.Encode(counter);
+  record.reserve(sizeof(uint32_t) + counter.Size());
+  common::com::StringSink sink(record);
+  common::com::Encode(static_cast<uint32_t>(counter.Size()), sink);
+  batch.Encode(sink);
+  LogImpl(record);
+}
+
+void FileHandler::SetStructuredFormat(StructuredFormat format,
+                                      uint16_t block_size) {
+  Flush();
+  format_ = format;
+  block_size_ = block_size ? block_size : 1;
+}
+
+void FileHandler::Flush() {
+  for (auto &series : series_) {
+    if (!series.Empty()) {
+      WriteSeries(series, Time::Now());
+    }
+  }
+  series_.clear();
+}
+
+void FileHandler::LogSeries(const SensorReading &msg) {
+  // The series of the sensor, else a written out one is reused.
+  SensorReadingSeries *series{nullptr};
+  for (auto &candidate : series_) {
+    if (candidate.Matches(msg) && (!series || !candidate.Empty())) {
+      series = &candidate;
+    }
+  }
+  if (!series) {
+    series_.emplace_back();
+    series = &series_.back();
+  }
+  series->Add(msg);
+  if (series->Size() >= block_size_) {
+    WriteSeries(*series, msg.time);
+  }
+}
+
+void FileHandler::WriteSeries(SensorReadingSeries &series, const Time &t) {
+  CheckAndRotate(t, kSeries);
+  std::string record;
+  common::com::CountingSink counter;
+  series.Encode(counter);
+  record.reserve(sizeof(uint32_t) + counter.Size());
+  common::com::StringSink sink(record);
+  common::com::Encode(static_cast<uint32_t>(counter.Size()), sink);
+  series.Encode(sink);
+  LogImpl(record);
+  series.Clear();
+}
+
 }  // namespace common
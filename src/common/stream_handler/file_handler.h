@@ -1,7 +1,9 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
+#include "common/event/sensor_reading_series.h"
 #include "common/filesystem/filesystem.h"
 #include "common/stream_handler/stream_handler.h"
 #include "common/type_traits/type_traits.h"
@@ -11,6 +13,15 @@ namespace common {
 
 class FileHandler final : public StreamHandler {
 public:
+  // How single structured readings are stored.
+  enum class StructuredFormat : uint8_t {
+    // One JSON document per reading.
+    kJson,
+    // Per sensor blocks of Gorilla compressed samples (SensorReadingSeries),
+    // each prefixed by its uint32_t encoded size.
+    kSeries,
+  };
+
   FileHandler() = delete;
   FileHandler(const std::string &base_path, const std::string &name = "");
   FileHandler(const char *base_path, const char *name = "");
@@ -24,17 +35,40 @@ public:
   void Log(const std::string &msg) override;
   void Log(const Event &msg) override;
   void LogStructured(const SensorReading &msg) override;
+  // Appended in its encoded form, prefixed by the uint32_t encoded size.
+  void LogStructured(const SensorReadingBatch &batch) override;
+  // Records are appended back to back, to files of their own.
+  void LogBinary(const Time &time, const std::string &record) override;
+
+  // In kSeries a block is written once it holds block_size readings.
+  void SetStructuredFormat(StructuredFormat format, uint16_t block_size = 64);
+  // Writes out the partially filled blocks.
+  void Flush();
 
 private:
-  void CheckAndRotate(const Time &t, bool structured);
+  // File kinds, part of the file extension.
+  static constexpr const char *kText = "";
+  static constexpr const char *kStructured = "s";
+  static constexpr const char *kBatch = "b";
+  static constexpr const char *kSeries = "g";
+  static constexpr const char *kBinary = "d";
+
+  void CheckAndRotate(const Time &t, const char *kind);
   void CreateDefaultFileHanderData();
 
   void LogImpl(const std::string &msg);
+  void LogImpl(const char *data, size_t size);
+  void LogSeries(const SensorReading &msg);
+  void WriteSeries(SensorReadingSeries &series, const Time &t);
 
   std::string current_hour_{""};
+  const char *current_kind_{nullptr};
   filesystem::Path base_path_{""};
   std::string name_{""};
   filesystem::Path file_path_{""};
+  std::vector<SensorReadingSeries> series_{};
+  uint16_t block_size_{64};
+  StructuredFormat format_{StructuredFormat::kJson};
 };
 
 } // namespace common
@@ -79,18 +79,17 @@ public:
     std::string metadata = ToString(msg.level);
     Log(ToString(msg.level).substr(0, 1) + " " +
         std::to_string(msg.error_code) + " " +
-        msg.source_name,
+        msg.source_name.ToString(),
         msg.event_msg);
   }
 
+  using StreamHandler::LogStructured;
   void LogStructured(const SensorReading &msg) override {
     std::string data = "0";
-    if (msg.reading.HoldsAlternative<double>()) {
-      data = std::to_string(*msg.reading.GetIf<double>());
-    } else if (msg.reading.HoldsAlternative<int>()) {
-      data = std::to_string(*msg.reading.GetIf<int>());
-    }
-    Log(msg.sensor_id, data + msg.unit);
+    common::Visit([&data](const auto &value) {
+      data = std::to_string(value);
+    }, msg.reading);
+    Log(msg.sensor_id.ToString(), data + msg.unit.ToString());
   }
 
 private:
@@ -14,4 +14,11 @@ void SerialHandler::LogStructured(const SensorReading &msg) {
   Serial.println(json_str.c_str());
 }
 
+// Records are written as is, COBS framing lets tools/binary_log.py pick
+// them out of the text lines.
+void SerialHandler::LogBinary(const Time &, const std::string &record) {
+  Serial.write(reinterpret_cast<const uint8_t *>(record.c_str()),
+               record.size());
+}
+
 } // namespace common
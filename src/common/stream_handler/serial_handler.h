@@ -9,9 +9,11 @@ public:
   SerialHandler() = default;
   ~SerialHandler() = default;
 
+  using StreamHandler::LogStructured;
   void Log(const std::string&) override;
   void Log(const Event&) override;
   void LogStructured(const SensorReading&) override;
+  void LogBinary(const Time&, const std::string&) override;
 
 };
 
@@ -3,6 +3,7 @@
 #include <Arduino.h>
 #include "common/stl/string.h"
 #include "common/event/defs.h"
+#include "common/event/sensor_reading_batch.h"
 
 namespace common {
 
@@ -11,6 +12,15 @@ public:
   virtual void Log(const std::string&) {};
   virtual void Log(const Event&) {};
   virtual void LogStructured(const SensorReading&) {};
+  // Logs the readings one by one unless the handler stores batches as is.
+  virtual void LogStructured(const SensorReadingBatch &batch) {
+    for (size_t i{0}; i < batch.Size(); ++i) {
+      LogStructured(batch.Get(i));
+    }
+  }
+  // A framed binary log record (see binary_log.h), dropped by handlers that
+  // only show text.
+  virtual void LogBinary(const Time &, const std::string &) {};
   virtual ~StreamHandler() = default;
 
 protected:
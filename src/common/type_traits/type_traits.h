@@ -95,6 +95,21 @@ public:
   using type = typename GetElementTypeImpl<Index, Args...>::type;
 };
 
+// Smallest unsigned integer able to hold every value in [0, N].
+template <size_t N>
+using SmallestUnsigned = std::conditional_t<
+    (N <= std::numeric_limits<uint8_t>::max()), uint8_t,
+    std::conditional_t<(N <= std::numeric_limits<uint16_t>::max()),
+                       uint16_t, uint32_t>>;
+
+template <typename ...Args>
+struct MaxSizeOf : std::integral_constant<size_t, 0> {};
+
+template <typename T0, typename ...TN>
+struct MaxSizeOf<T0, TN...> : std::integral_constant<
+    size_t, (sizeof(T0) > MaxSizeOf<TN...>::value ?
+             sizeof(T0) : MaxSizeOf<TN...>::value)> {};
+
 // TODO: move to unit test
 using VariantTestType =
     common::type_traits::VariadicTypeTraits<int, bool, std::string>;
@@ -105,6 +120,12 @@ static_assert(std::is_same<VariantTestType::type<0>, int>::value,
               "the first is not int");
 static_assert(std::is_same<VariantTestType::type<2>, std::string>::value,
               "the last is not std::string");
+static_assert(std::is_same<SmallestUnsigned<2>, uint8_t>::value,
+              "2 does not fit in uint8_t");
+static_assert(std::is_same<SmallestUnsigned<256>, uint16_t>::value,
+              "256 fits in uint8_t");
+static_assert(MaxSizeOf<uint8_t, uint32_t, uint16_t>::value == 4,
+              "max size is not 4");
 
 
 }  // namespace common::type_traits
@@ -0,0 +1,101 @@
+#include "common/utility/format.h"
+
+#include <math.h>
+
+namespace common::detail {
+
+namespace {
+
+struct AppendSink {
+  std::string &msg;
+
+  inline void Write(const char *data, size_t size) {
+    msg.append(data, size);
+  }
+};
+
+}  // namespace
+
+void FormatArg::AppendTo(std::string &msg) const {
+  if (data_) {
+    msg.append(data_, size_);
+  } else {
+    AppendSink sink{msg};
+    symbol_->Write(sink);
+  }
+}
+
+template <typename Unsigned>
+void FormatArg::PrintInteger(bool negative, Unsigned value) {
+  char *end = buffer_ + kBufferSize;
+  char *p = end;
+  do {
+    *--p = '0' + value % 10;
+    value /= 10;
+  } while (value);
+  if (negative) {
+    *--p = '-';
+  }
+  data_ = p;
+  size_ = end - p;
+}
+
+template void FormatArg::PrintInteger(bool, uint32_t);
+template void FormatArg::PrintInteger(bool, uint64_t);
+
+void FormatArg::PrintFloat(double value) {
+  static constexpr uint16_t kScale = 10000;
+  if (isnan(value)) {
+    data_ = "nan";
+  } else if (isinf(value)) {
+    data_ = "inf";
+  } else if (value > 4294967040.0 || value < -4294967040.0) {
+    data_ = "ovf";
+  }
+  if (data_) {
+    size_ = 3;
+    return;
+  }
+
+  bool negative = value < 0;
+  value = (negative ? -value : value) + 0.5 / kScale;
+  uint32_t integer = static_cast<uint32_t>(value);
+  uint16_t fraction =
+      static_cast<uint16_t>((value - integer) * kScale) % kScale;
+  char *end = buffer_ + kBufferSize;
+  char *p = end;
+  for (uint16_t scale{1}; scale < kScale; scale *= 10) {
+    *--p = '0' + fraction % 10;
+    fraction /= 10;
+  }
+  *--p = '.';
+  do {
+    *--p = '0' + integer % 10;
+    integer /= 10;
+  } while (integer);
+  if (negative) {
+    *--p = '-';
+  }
+  data_ = p;
+  size_ = end - p;
+}
+
+std::string FormatArgs(const char *str, size_t length, const size_t *offsets,
+                       const FormatArg *args, size_t count) {
+  size_t size = length - 2 * count;
+  for (size_t i{0}; i < count; ++i) {
+    size += args[i].Size();
+  }
+  std::string msg;
+  msg.reserve(size);
+  size_t begin{0};
+  for (size_t i{0}; i < count; ++i) {
+    msg.append(str + begin, offsets[i] - begin);
+    args[i].AppendTo(msg);
+    begin = offsets[i] + 2;
+  }
+  msg.append(str + begin, length - begin);
+  return msg;
+}
+
+}  // namespace common::detail
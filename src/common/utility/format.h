@@ -0,0 +1,167 @@
+#pragma once
+
+#include "common/stl/string.h"
+#include "common/utility/symbol.h"
+
+// Format string parsed at compile time, the placeholder count is checked
+// against the arguments:
+//
+//   log.Info(COMMON_FORMAT("%% readings from %%"), count, sensor_id);
+//
+// Same `%%` placeholders as common::detail::Format.
+#define COMMON_FORMAT(str)                                                   \
+  [] {                                                                       \
+    struct Literal {                                                         \
+      static constexpr const char *Get() {                                   \
+        return str;                                                          \
+      }                                                                      \
+    };                                                                       \
+    return ::common::FormatString<Literal>();                                \
+  }()
+
+namespace common {
+
+namespace detail {
+
+constexpr size_t FormatLength(const char *str) {
+  size_t length{0};
+  while (str[length]) {
+    ++length;
+  }
+  return length;
+}
+
+// Non overlapping `%%`, left to right.
+constexpr size_t FormatPlaceholders(const char *str, size_t *offsets) {
+  size_t count{0};
+  for (size_t i{0}; str[i]; ++i) {
+    if (str[i] == '%' && str[i + 1] == '%') {
+      if (offsets) {
+        offsets[count] = i;
+      }
+      ++count;
+      ++i;
+    }
+  }
+  return count;
+}
+
+// FNV-1a of the format string folded to 16 bits, the id of binary log
+// records (see binary_log.h).
+constexpr uint16_t FormatId(const char *str) {
+  uint32_t hash{2166136261u};
+  for (size_t i{0}; str[i]; ++i) {
+    hash = (hash ^ static_cast<uint8_t>(str[i])) * 16777619u;
+  }
+  return static_cast<uint16_t>((hash >> 16) ^ (hash & 0xFFFF));
+}
+
+template <size_t Count>
+struct FormatOffsets {
+  // One extra slot, arrays can't be empty.
+  size_t value[Count + 1];
+};
+
+template <size_t Count>
+constexpr FormatOffsets<Count> ParseFormat(const char *str) {
+  FormatOffsets<Count> offsets{};
+  FormatPlaceholders(str, offsets.value);
+  return offsets;
+}
+
+// An argument ready to be copied out: text by reference, numbers printed
+// to a small buffer. Integers print like std::to_string, floating points
+// with 4 rounded decimals, and "nan", "inf" or "ovf" past 32 bit integer
+// parts as Arduino's Print does.
+class FormatArg {
+public:
+  FormatArg(const char *str) : data_{str}, size_{strlen(str)} {}
+  FormatArg(const std::string &str) : data_{str.c_str()}, size_{str.size()} {}
+  FormatArg(const Symbol &symbol) : symbol_{&symbol}, size_{symbol.Size()} {}
+
+  template <typename T,
+            std::enable_if_t<std::is_integral<T>::value, bool> = true>
+  FormatArg(T value) {
+    // 64 bit divisions are slow on AVR.
+    using Unsigned =
+        std::conditional_t<sizeof(T) <= sizeof(uint32_t), uint32_t, uint64_t>;
+    Unsigned magnitude = static_cast<Unsigned>(value);
+    bool negative{false};
+    if constexpr (std::is_signed<T>::value) {
+      negative = value < 0;
+    }
+    PrintInteger(negative, negative ? 0 - magnitude : magnitude);
+  }
+
+  template <typename T,
+            std::enable_if_t<std::is_floating_point<T>::value, bool> = true>
+  FormatArg(T value) {
+    PrintFloat(value);
+  }
+
+  // data_ may point into buffer_.
+  FormatArg(const FormatArg &) = delete;
+  FormatArg &operator=(const FormatArg &) = delete;
+
+  inline size_t Size() const {
+    return size_;
+  }
+
+  void AppendTo(std::string &msg) const;
+
+private:
+  // Digits of a uint64_t, its sign and a terminator.
+  static constexpr size_t kBufferSize = 22;
+
+  template <typename Unsigned>
+  void PrintInteger(bool negative, Unsigned value);
+  void PrintFloat(double value);
+
+  const char *data_{nullptr};
+  const Symbol *symbol_{nullptr};
+  size_t size_{0};
+  char buffer_[kBufferSize];
+};
+
+// Formats str, whose placeholders are at offsets, with args in one pass.
+std::string FormatArgs(const char *str, size_t length, const size_t *offsets,
+                       const FormatArg *args, size_t count);
+
+}  // namespace detail
+
+// A format string literal, see COMMON_FORMAT.
+template <typename Literal>
+struct FormatString {
+  static constexpr size_t kLength = detail::FormatLength(Literal::Get());
+  static constexpr size_t kArgs =
+      detail::FormatPlaceholders(Literal::Get(), nullptr);
+  static constexpr detail::FormatOffsets<kArgs> kOffsets =
+      detail::ParseFormat<kArgs>(Literal::Get());
+  static constexpr uint16_t kId = detail::FormatId(Literal::Get());
+
+  static constexpr const char *Data() {
+    return Literal::Get();
+  }
+};
+
+template <typename T>
+struct IsFormatString : std::false_type {};
+
+template <typename Literal>
+struct IsFormatString<FormatString<Literal>> : std::true_type {};
+
+template <typename Literal, typename... Args>
+std::string Format(FormatString<Literal>, const Args &...args) {
+  using Str = FormatString<Literal>;
+  static_assert(Str::kArgs == sizeof...(Args),
+                "number of arguments does not match the format string");
+  if constexpr (sizeof...(Args) > 0) {
+    const detail::FormatArg converted[] = {detail::FormatArg(args)...};
+    return detail::FormatArgs(Str::Data(), Str::kLength, Str::kOffsets.value,
+                              converted, sizeof...(Args));
+  } else {
+    return std::string(Str::Data(), Str::kLength);
+  }
+}
+
+}  // namespace common
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <ArxTypeTraits.h>
+
+#include "common/utility/utility.h"
+
+namespace common {
+
+// Fixed capacity FIFO stored in place. PushBack fails when full, the caller
+// decides what to drop.
+template <typename T, uint16_t Capacity>
+class RingBuffer {
+public:
+  static_assert(Capacity > 0, "capacity must be positive");
+  static constexpr uint16_t kCapacity = Capacity;
+
+  bool PushBack(const T &value) {
+    if (Full()) {
+      return false;
+    }
+    data_[(head_ + size_) % Capacity] = value;
+    ++size_;
+    return true;
+  }
+
+  bool PushBack(T &&value) {
+    if (Full()) {
+      return false;
+    }
+    data_[(head_ + size_) % Capacity] = common::move(value);
+    ++size_;
+    return true;
+  }
+
+  void PopFront() {
+    if (size_) {
+      head_ = (head_ + 1) % Capacity;
+      --size_;
+    }
+  }
+
+  inline T &Front() {
+    return data_[head_];
+  }
+
+  inline const T &Front() const {
+    return data_[head_];
+  }
+
+  // i-th element from the front.
+  inline T &operator[](uint16_t i) {
+    return data_[(head_ + i) % Capacity];
+  }
+
+  inline const T &operator[](uint16_t i) const {
+    return data_[(head_ + i) % Capacity];
+  }
+
+  // Contiguous elements starting at the front, the rest wraps around.
+  inline const T *FrontSpan(uint16_t &size) const {
+    size = Capacity - head_ < size_ ? Capacity - head_ : size_;
+    return data_ + head_;
+  }
+
+  // Drops the `count` elements at the front.
+  void Consume(uint16_t count) {
+    count = count < size_ ? count : size_;
+    head_ = (head_ + count) % Capacity;
+    size_ -= count;
+  }
+
+  inline void Clear() {
+    head_ = 0;
+    size_ = 0;
+  }
+
+  inline uint16_t Size() const {
+    return size_;
+  }
+
+  inline bool Empty() const {
+    return !size_;
+  }
+
+  inline bool Full() const {
+    return size_ == Capacity;
+  }
+
+private:
+  T data_[Capacity];
+  uint16_t head_{0};
+  uint16_t size_{0};
+};
+
+}  // namespace common
@@ -0,0 +1,241 @@
+#include "common/utility/symbol.h"
+
+namespace common {
+
+namespace {
+
+// avr-libc compares RAM against flash only.
+bool EqualFlash(const char *a, const char *b) {
+  if (a == b) {
+    return true;
+  }
+  for (;; ++a, ++b) {
+    uint8_t c = pgm_read_byte(a);
+    if (c != pgm_read_byte(b)) {
+      return false;
+    }
+    if (!c) {
+      return true;
+    }
+  }
+}
+
+}  // namespace
+
+Symbol::Entry Symbol::table_[Symbol::kCapacity];
+Symbol::Handle Symbol::size_{0};
+uint8_t Symbol::decode_interns_{0};
+
+Symbol::Symbol(const char *str) {
+  size_t size = strlen(str);
+  if (!Intern(str, size, *this)) {
+    AssignCopy(str, size);
+  }
+}
+
+Symbol::Symbol(const std::string &str) {
+  if (!Intern(str.c_str(), str.size(), *this) &&
+      !memchr(str.c_str(), '\0', str.size())) {
+    AssignCopy(str.c_str(), str.size());
+  }
+}
+
+Symbol::Symbol(const Symbol &other) : handle_{other.handle_} {
+  if (other.text_) {
+    text_ = Copy(other.text_, strlen(other.text_));
+  }
+}
+
+Symbol::Symbol(Symbol &&other) noexcept
+    : text_{other.text_}, handle_{other.handle_} {
+  other.text_ = nullptr;
+  other.handle_ = 0;
+}
+
+Symbol &Symbol::operator=(const Symbol &other) {
+  if (this != &other) {
+    if (other.text_) {
+      AssignCopy(other.text_, strlen(other.text_));
+    } else {
+      Assign(other.handle_);
+    }
+  }
+  return *this;
+}
+
+Symbol &Symbol::operator=(Symbol &&other) noexcept {
+  if (this != &other) {
+    delete[] text_;
+    text_ = other.text_;
+    handle_ = other.handle_;
+    other.text_ = nullptr;
+    other.handle_ = 0;
+  }
+  return *this;
+}
+
+Symbol::~Symbol() {
+  delete[] text_;
+}
+
+bool Symbol::Intern(const char *str, size_t size, Symbol &symbol) {
+  // Entries are C strings, a decoded text with a '\0' in it cannot be one.
+  if (memchr(str, '\0', size)) {
+    return false;
+  }
+  Handle handle = Find(str, size);
+  if (!handle && size) {
+    if (size_ == kCapacity) {
+      return false;
+    }
+    handle = Add(Copy(str, size), false);
+  }
+  symbol.Assign(handle);
+  return true;
+}
+
+bool Symbol::Decode(const char *str, size_t size, Symbol &symbol) {
+  if (memchr(str, '\0', size)) {
+    return false;
+  }
+  Handle handle = Find(str, size);
+  if (handle || !size) {
+    symbol.Assign(handle);
+  } else if (decode_interns_ && size_ < kCapacity) {
+    --decode_interns_;
+    symbol.Assign(Add(Copy(str, size), false));
+  } else {
+    symbol.AssignCopy(str, size);
+  }
+  return true;
+}
+
+void Symbol::InternDecoded(uint8_t limit) {
+  decode_interns_ = limit;
+}
+
+Symbol Symbol::Static(const char *str) {
+  size_t size = strlen(str);
+  Handle handle = Find(str, size);
+  if (handle || !size || size_ < kCapacity) {
+    return Symbol(handle || !size ? handle : Add(str, false));
+  }
+  Symbol symbol;
+  symbol.AssignCopy(str, size);
+  return symbol;
+}
+
+Symbol Symbol::Flash(const char *str) {
+  if (!pgm_read_byte(str)) {
+    return Symbol();
+  }
+  Handle handle = FindFlash(str);
+  if (handle || size_ < kCapacity) {
+    return Symbol(handle ? handle : Add(str, true));
+  }
+  // Only a private copy is read out of flash.
+  size_t size = strlen_P(str);
+  Symbol symbol;
+  symbol.text_ = new char[size + 1];
+  memcpy_P(symbol.text_, str, size + 1);
+  return symbol;
+}
+
+size_t Symbol::Count() {
+  return size_;
+}
+
+size_t Symbol::Size() const {
+  if (text_) {
+    return strlen(text_);
+  }
+  if (Empty()) {
+    return 0;
+  }
+  const Entry &entry = GetEntry();
+  return entry.flash ? strlen_P(entry.str) : strlen(entry.str);
+}
+
+std::string Symbol::ToString() const {
+  if (text_) {
+    return std::string(text_);
+  }
+  std::string text(Size(), '\0');
+  if (!text.empty()) {
+    const Entry &entry = GetEntry();
+    if (entry.flash) {
+      memcpy_P(&text[0], entry.str, text.size());
+    } else {
+      memcpy(&text[0], entry.str, text.size());
+    }
+  }
+  return text;
+}
+
+bool Symbol::operator==(const char *str) const {
+  if (text_) {
+    return !strcmp(str, text_);
+  }
+  if (Empty()) {
+    return !*str;
+  }
+  const Entry &entry = GetEntry();
+  return entry.flash ? !strcmp_P(str, entry.str) : !strcmp(str, entry.str);
+}
+
+Symbol::Handle Symbol::Find(const char *str, size_t size) {
+  for (Handle i{0}; size && i < size_; ++i) {
+    const Entry &entry = table_[i];
+    bool equal = entry.flash
+        ? strlen_P(entry.str) == size && !memcmp_P(str, entry.str, size)
+        : strlen(entry.str) == size && !memcmp(str, entry.str, size);
+    if (equal) {
+      return i + 1;
+    }
+  }
+  return 0;
+}
+
+Symbol::Handle Symbol::FindFlash(const char *str) {
+  for (Handle i{0}; i < size_; ++i) {
+    const Entry &entry = table_[i];
+    if (entry.flash ? EqualFlash(entry.str, str)
+                    : !strcmp_P(entry.str, str)) {
+      return i + 1;
+    }
+  }
+  return 0;
+}
+
+// Only called while the table has room.
+Symbol::Handle Symbol::Add(const char *str, bool flash) {
+  table_[size_] = Entry{str, flash};
+  return ++size_;
+}
+
+char *Symbol::Copy(const char *str, size_t size) {
+  char *copy = new char[size + 1];
+  memcpy(copy, str, size);
+  copy[size] = '\0';
+  return copy;
+}
+
+void Symbol::Assign(Handle handle) {
+  delete[] text_;
+  text_ = nullptr;
+  handle_ = handle;
+}
+
+void Symbol::AssignCopy(const char *str, size_t size) {
+  char *copy = size ? Copy(str, size) : nullptr;
+  delete[] text_;
+  text_ = copy;
+  handle_ = 0;
+}
+
+// At least one side is a private copy, the other may be in flash.
+bool Symbol::EqualText(const Symbol &other) const {
+  return text_ ? other == text_ : *this == other.text_;
+}
+
+}  // namespace common
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <avr/pgmspace.h>
+
+#include "common/stl/string.h"
+
+// Number of distinct strings the symbol table holds, at most 255.
+#ifndef COMMON_MAX_SYMBOLS
+#define COMMON_MAX_SYMBOLS 32
+#endif
+
+namespace common {
+
+// Interned string: a one byte handle into a global table, so readings and
+// events copy a byte instead of a std::string and compare by handle. A text
+// is stored once whatever registers it, equal texts always share a handle.
+//
+// Constants register through Static() / Flash(), which keep a pointer to
+// the text (a literal, or a PROGMEM / PSTR string) instead of a copy. Other
+// texts are copied to the heap the first time they are interned and never
+// released. The text is only materialized by ToString() / Write(), at the
+// JSON, LCD and wire edges.
+//
+// A text that is not interned is kept as a private heap copy owned by the
+// Symbol instead (Interned() is false), copied with it like a std::string:
+// decoded texts missing from the table (see Decode()) and texts registered
+// once the table is full. The table never fills up with what other nodes
+// send, and no text is lost.
+class Symbol {
+public:
+  using Handle = uint8_t;
+  static constexpr size_t kCapacity = COMMON_MAX_SYMBOLS;
+  static_assert(kCapacity <= 0xFF, "handles are a byte, 0 is the empty text");
+
+  // The empty text.
+  Symbol() = default;
+
+  // Interns a copy of str, a private copy once the table is full (see
+  // Interned()). A std::string holding a '\0' gives the empty symbol.
+  Symbol(const char *str);
+  Symbol(const std::string &str);
+
+  Symbol(const Symbol &other);
+  Symbol(Symbol &&other) noexcept;
+  Symbol &operator=(const Symbol &other);
+  Symbol &operator=(Symbol &&other) noexcept;
+  ~Symbol();
+
+  // Returns false, leaving symbol untouched, when the table is full or the
+  // text holds a '\0'.
+  static bool Intern(const char *str, size_t size, Symbol &symbol);
+
+  // A text read off the wire: the handle of an equal interned text, or a
+  // private copy, so it only fails (leaving symbol untouched) on a '\0'.
+  // Texts are not added to the table unless InternDecoded() allows it. A
+  // text already interned takes no allocation.
+  static bool Decode(const char *str, size_t size, Symbol &symbol);
+
+  // Lets Decode() intern up to limit texts missing from the table, for a
+  // node that keeps seeing the same few names. 0, the default, interns
+  // none. Past the limit or the capacity decoded texts are private copies.
+  // Interning writes the table: not while decoding from an ISR.
+  static void InternDecoded(uint8_t limit);
+
+  // Registers a string of static storage duration without copying it, a
+  // private copy once the table is full.
+  static Symbol Static(const char *str);
+  // Same for a string stored in flash.
+  static Symbol Flash(const char *str);
+
+  // 0 for the empty text and for texts that are not interned.
+  inline Handle GetHandle() const {
+    return handle_;
+  }
+
+  // False for a private copy.
+  inline bool Interned() const {
+    return !text_;
+  }
+
+  // Number of texts interned so far.
+  static size_t Count();
+
+  inline bool Empty() const {
+    return !handle_ && !text_;
+  }
+
+  size_t Size() const;
+  std::string ToString() const;
+
+  // Writes the text (without the terminator) to a sink.
+  template <typename Sink>
+  void Write(Sink &sink) const;
+
+  // Interned symbols compare by handle, private copies by text.
+  inline bool operator==(const Symbol &other) const {
+    return !text_ && !other.text_ ? handle_ == other.handle_
+                                  : EqualText(other);
+  }
+
+  inline bool operator!=(const Symbol &other) const {
+    return !(*this == other);
+  }
+
+  bool operator==(const char *str) const;
+
+  inline bool operator==(const std::string &str) const {
+    return *this == str.c_str();
+  }
+
+  template <typename T>
+  inline bool operator!=(const T &other) const {
+    return !(*this == other);
+  }
+
+private:
+  struct Entry {
+    const char *str;
+    bool flash;
+  };
+
+  explicit Symbol(Handle handle) : handle_{handle} {}
+
+  // Handle of an interned text equal to str, 0 if missing.
+  static Handle Find(const char *str, size_t size);
+  // Same for a string stored in flash, compared where it is.
+  static Handle FindFlash(const char *str);
+  static Handle Add(const char *str, bool flash);
+  // Heap copy of str with a terminator.
+  static char *Copy(const char *str, size_t size);
+
+  // Becomes the interned text handle, or a private copy of str.
+  void Assign(Handle handle);
+  void AssignCopy(const char *str, size_t size);
+
+  bool EqualText(const Symbol &other) const;
+
+  inline const Entry &GetEntry() const {
+    return table_[handle_ - 1];
+  }
+
+  static Entry table_[kCapacity];
+  static Handle size_;
+  // Texts Decode() may still intern.
+  static uint8_t decode_interns_;
+
+  // Set for a private copy, handle_ is 0 then.
+  char *text_{nullptr};
+  Handle handle_{0};
+};
+
+template <typename Sink>
+void Symbol::Write(Sink &sink) const {
+  if (text_) {
+    sink.Write(text_, strlen(text_));
+    return;
+  }
+  if (Empty()) {
+    return;
+  }
+  const Entry &entry = GetEntry();
+  if (!entry.flash) {
+    sink.Write(entry.str, strlen(entry.str));
+    return;
+  }
+  char chunk[16];
+  const char *str = entry.str;
+  for (size_t left = strlen_P(str); left;) {
+    size_t size = left < sizeof(chunk) ? left : sizeof(chunk);
+    memcpy_P(chunk, str, size);
+    sink.Write(chunk, size);
+    str += size;
+    left -= size;
+  }
+}
+
+}  // namespace common
@@ -1,180 +1,127 @@
 #pragma once
 
+#include <new>
+#include <avr/pgmspace.h>
+
 #include "common/type_traits/type_traits.h"
 
 namespace common {
 
-#define VARIANT_USE_BINARY_SEARCH
-
 namespace detail {
 
-#ifdef VARIANT_USE_BINARY_SEARCH
-template <size_t StartIndex, size_t EndIndex, typename ...Types,
-    typename = std::enable_if_t<!(StartIndex <= EndIndex)>>
-bool Destroy(...) {
-  return false;
-}
-
-template <size_t StartIndex, size_t EndIndex, typename ...Types,
-          typename = std::enable_if_t<StartIndex <= EndIndex>,
-          typename TypeList = common::type_traits::VariadicTypeTraits<Types...>,
-          typename CurType = typename TypeList::template type<StartIndex>>
-bool Destroy(size_t index, void *data) {
-  constexpr size_t mid = (StartIndex + EndIndex) / 2;
-  if (mid == index) {
-    auto ptr = reinterpret_cast<CurType *>(data);
-    delete ptr;
-    return true;
-  }
-  if constexpr (mid == StartIndex) {
-    return Destroy<StartIndex + 1, EndIndex, Types...>(index, data);
-  }
-  return index > mid ? Destroy<mid, EndIndex, Types...>(index, data) :
-                       Destroy<StartIndex, mid, Types...>(index, data);
-}
+// Operations applied on the in-place storage of a Variant once the active
+// alternative is resolved. `data` is the storage being written to / destroyed
+// and `other` is the storage of the source Variant (if any).
+struct VariantDestroyOp {
+  template <typename T>
+  static void Apply(void *data, void *) {
+    reinterpret_cast<T *>(data)->~T();
+  }
+};
 
-template <size_t StartIndex, size_t EndIndex, typename ...Types,
-    typename = std::enable_if_t<!(StartIndex <= EndIndex)>>
-void *Copy(...) {
-  return nullptr;
-}
+struct VariantCopyOp {
+  template <typename T>
+  static void Apply(void *data, void *other) {
+    new (data) T(*reinterpret_cast<const T *>(other));
+  }
+};
 
-template <size_t StartIndex, size_t EndIndex, typename ...Types,
-    typename = std::enable_if_t<StartIndex <= EndIndex>,
-    typename TypeList = common::type_traits::VariadicTypeTraits<Types...>,
-    typename CurType = typename TypeList::template type<StartIndex>>
-void *Copy(size_t index, const void *data) {
-  constexpr size_t mid = (StartIndex + EndIndex) / 2;
-  if (mid == index) {
-    return reinterpret_cast<void *>(
-        new CurType{*reinterpret_cast<const CurType *>(data)});
-  }
-  if constexpr (mid == StartIndex) {
-    return Copy<StartIndex + 1, EndIndex, Types...>(index, data);
-  }
-  return index > mid ? Copy<mid, EndIndex, Types...>(index, data) :
-         Copy<StartIndex, mid, Types...>(index, data);
-}
+struct VariantMoveOp {
+  template <typename T>
+  static void Apply(void *data, void *other) {
+    new (data) T(std::move(*reinterpret_cast<T *>(other)));
+  }
+};
 
-#else
-template <size_t Index, typename ...Types,
-    typename TypeList = common::type_traits::VariadicTypeTraits<Types...>,
-    typename = std::enable_if_t<Index >= TypeList::N>>
-bool Destroy(...) {
-  return false;
-}
+// Jump table holding Op::Apply<T> for every alternative, indexed by the
+// alternative index. Lives in flash.
+template <typename Op, typename... Types>
+struct StorageOpTable {
+  using FunctionPtrType = void (*)(void *, void *);
+  static PROGMEM constexpr const FunctionPtrType kTable[] = {
+      &Op::template Apply<Types>...};
+
+  static void Dispatch(size_t index, void *data, void *other) {
+    auto op = reinterpret_cast<FunctionPtrType>(pgm_read_ptr(kTable + index));
+    (*op)(data, other);
+  }
+};
 
-template <size_t Index, typename ...Types,
-          typename TypeList = common::type_traits::VariadicTypeTraits<Types...>,
-          typename = std::enable_if_t<Index < TypeList::N>>
-bool Destroy(size_t index, void *data) {
-  using CurType = typename TypeList::template type<Index>;
-  if (data && Index == index) {
-    auto ptr = reinterpret_cast<CurType *>(data);
-    delete ptr;
-    return true;
-  }
-  return Destroy<Index + 1, Types...>(index, data);
+// Constructs the first alternative that is constructible from args in place.
+template <size_t Index, typename TypeList, typename IndexType,
+          typename... Args>
+bool Construct(void *data, IndexType &index, Args&&... args) {
+  if constexpr (Index >= TypeList::N) {
+    return false;
+  } else {
+    using CurType = typename TypeList::template type<Index>;
+    if constexpr (
+        common::type_traits::is_constructible<CurType, Args...>::value) {
+      new (data) CurType(std::forward<Args>(args)...);
+      index = static_cast<IndexType>(Index);
+      return true;
+    } else {
+      return Construct<Index + 1, TypeList>(
+          data, index, std::forward<Args>(args)...);
+    }
+  }
 }
 
-template <size_t Index, typename ...Types,
-    typename TypeList = common::type_traits::VariadicTypeTraits<Types...>,
-    typename = std::enable_if_t<Index >= TypeList::N>>
-void *Copy(...) {
-  return false;
-}
+template <typename VariantType, typename... Args>
+struct IsSelf : std::false_type {};
 
-template <size_t Index, typename ...Types,
-          typename TypeList = common::type_traits::VariadicTypeTraits<Types...>,
-          typename = std::enable_if_t<Index < TypeList::N>>
-void *Copy(size_t index, const void *data) {
-  using CurType = typename TypeList::template type<Index>;
-  if (data && Index == index) {
-    return reinterpret_cast<void *>(
-        new CurType{*reinterpret_cast<const CurType *>(data)});
-    return ptr;
-  }
-  return Destroy<Index + 1, Types...>(index, data);
-}
-#endif
+template <typename VariantType, typename Arg>
+struct IsSelf<VariantType, Arg>
+    : std::is_same<VariantType, std::decay_t<Arg>> {};
 
-template <size_t Index, typename... Args>
-void *Construct(Args&&... args) {
-  return nullptr;
-}
-
-template <size_t Index, typename... Types, typename... Args,
-          typename TypeList = common::type_traits::VariadicTypeTraits<Types...>,
-          typename CurType = typename TypeList::template type<Index>,
-          typename = std::enable_if_t<
-              common::type_traits::is_constructible<CurType, Args...>::value>>
-void *Construct(size_t &index, Args&&... args) {
-  index = Index;
-  return reinterpret_cast<void *>(new CurType{std::forward<Args>(args)...});
-}
-
-template <size_t Index,  typename... Types, typename... Args,
-    typename TypeList = common::type_traits::VariadicTypeTraits<Types...>,
-    typename CurType = typename TypeList::template type<Index>,
-    typename = std::enable_if_t<
-        !common::type_traits::is_constructible<CurType, Args...>::value>,
-    typename = std::nullptr_t>
-void *Construct(size_t &index, Args&&... args) {
-  return Construct<Index + 1, Args..., Types...>(
-      index, std::forward<Args>(args)...);
-}
+struct VariantAccess;
 
 }  //namespace detail.
 
-// Simplified verison of std::variant
+// Simplified verison of std::variant. The active alternative lives in an
+// aligned in-place buffer sized to the largest type, so no heap allocation is
+// made for construction, copy, move or Emplace. A moved-from Variant is
+// valueless: Index() returns npos (size_t max) until it is assigned again.
+// Moves are noexcept, alternatives must not throw when moved.
 template <class... Types>
 class Variant {
 private:
   using TypeList = common::type_traits::VariadicTypeTraits<Types...>;
+  using IndexType = common::type_traits::SmallestUnsigned<TypeList::N>;
+
+  static constexpr IndexType kNPos = std::numeric_limits<IndexType>::max();
+  static constexpr size_t kStorageSize =
+      common::type_traits::MaxSizeOf<Types...>::value;
 
 public:
   Variant() = default;
 
-  Variant(const Variant &other)  {
-    *this = other;
+  Variant(const Variant &other) {
+    CopyFrom(other);
   }
 
-  Variant(Variant &&other) {
-    *this = std::move(other);
+  Variant(Variant &&other) noexcept {
+    MoveFrom(other);
   }
 
   Variant &operator=(const Variant &other) {
-#ifdef VARIANT_USE_BINARY_SEARCH
-    data_ = detail::Copy<0, TypeList::N - 1, Types...>(
-        other.index_, other.data_);
-#else
-    data_ = detail::Copy<0, Types...>(other.index_, other.data_);
-#endif
-    if (data_) {
-      index_ = other.index_;
+    if (this != &other) {
+      Reset();
+      CopyFrom(other);
     }
     return *this;
   };
 
-  Variant &operator=(Variant &&other) {
-    this->~Variant();
-    data_ = other.data_;
-    index_ = other.index_;
-    other.data_ = nullptr;
-    other.index_ = std::numeric_limits<size_t>::max();
+  Variant &operator=(Variant &&other) noexcept {
+    if (this != &other) {
+      Reset();
+      MoveFrom(other);
+    }
     return *this;
   };
 
   ~Variant() {
-    if (index_ < TypeList::N && data_) {
-#ifdef VARIANT_USE_BINARY_SEARCH
-      detail::Destroy<0, TypeList::N - 1, Types...>(index_, data_);
-#else
-      detail::Destroy<0, Types...>(index_, data_);
-#endif
-      index_ = std::numeric_limits<size_t>::max();
-      data_ = nullptr;
-    }
+    Reset();
   }
 
   template <
@@ -182,20 +129,24 @@ public:
       size_t Index = TypeList::template GetIndex<T>(),
       typename = std::enable_if_t<TypeList::template Has<T>()>>
   explicit Variant(T&& arg) {
-    index_ = Index;
-    data_ = reinterpret_cast<void *>(
-        new typename TypeList::template type<Index>{std::forward<T>(arg)});
+    new (Data()) typename TypeList::template type<Index>(std::forward<T>(arg));
+    index_ = static_cast<IndexType>(Index);
   }
 
-  template <typename... Args>
+  template <typename... Args,
+            typename = std::enable_if_t<
+                !detail::IsSelf<Variant, Args...>::value>>
   explicit Variant(Args&&... args) {
-    data_ = detail::Construct<0, Types...>(index_, std::forward<Args>(args)...);
+    detail::Construct<0, TypeList>(Data(), index_, std::forward<Args>(args)...);
   }
 
-  constexpr size_t Index() const noexcept {
-    return index_;
+  static constexpr size_t Size() noexcept {
+    return TypeList::N;
   }
 
+  constexpr size_t Index() const noexcept {
+    return index_ == kNPos ? std::numeric_limits<size_t>::max() : index_;
+  }
 
   template <typename T, size_t Index = TypeList::template GetIndex<T>()>
   bool HoldsAlternative() const {
@@ -204,12 +155,12 @@ public:
 
   template <typename T, size_t Index = TypeList::template GetIndex<T>()>
   T *GetIf() {
-    return index_ == Index ? reinterpret_cast<T *>(data_) : nullptr;
+    return index_ == Index ? reinterpret_cast<T *>(Data()) : nullptr;
   }
 
   template <typename T, size_t Index = TypeList::template GetIndex<T>()>
   const T *GetIf() const {
-    return index_ == Index ? reinterpret_cast<T *>(data_) : nullptr;
+    return index_ == Index ? reinterpret_cast<const T *>(Data()) : nullptr;
   }
 
   template <typename T, typename... Args,
@@ -217,20 +168,188 @@ public:
                 common::type_traits::is_constructible<T, Args...>::value>,
             size_t Index = TypeList::template GetIndex<T>()>
   void Emplace(Args&&... args) {
-    if (data_) {
-      this->~Variant();
-    }
-    index_ = Index;
-    data_ = reinterpret_cast<void *>(
-        new typename TypeList::template type<Index>(
-            std::forward<Args>(args)...));
+    Reset();
+    new (Data()) typename TypeList::template type<Index>(
+        std::forward<Args>(args)...);
+    index_ = static_cast<IndexType>(Index);
   }
 
 private:
+  friend struct detail::VariantAccess;
+
   static_assert(TypeList::N > 0, "must have at least 1 type");
+  static_assert(TypeList::N < kNPos, "too many types");
+
+  inline void *Data() {
+    return reinterpret_cast<void *>(data_);
+  }
+
+  inline const void *Data() const {
+    return reinterpret_cast<const void *>(data_);
+  }
+
+  void Reset() {
+    if (index_ != kNPos) {
+      detail::StorageOpTable<detail::VariantDestroyOp, Types...>::Dispatch(
+          index_, Data(), nullptr);
+      index_ = kNPos;
+    }
+  }
+
+  void CopyFrom(const Variant &other) {
+    if (other.index_ != kNPos) {
+      detail::StorageOpTable<detail::VariantCopyOp, Types...>::Dispatch(
+          other.index_, Data(), const_cast<void *>(other.Data()));
+      index_ = other.index_;
+    }
+  }
+
+  // Moves the active alternative out of other and leaves it valueless.
+  void MoveFrom(Variant &other) noexcept {
+    if (other.index_ != kNPos) {
+      detail::StorageOpTable<detail::VariantMoveOp, Types...>::Dispatch(
+          other.index_, Data(), other.Data());
+      index_ = other.index_;
+      other.Reset();
+    }
+  }
+
+  alignas(Types...) unsigned char data_[kStorageSize];
+  IndexType index_ = kNPos;
+};
+
+namespace detail {
 
-  void *data_{nullptr};
-  size_t index_ = std::numeric_limits<size_t>::max();
+struct VariantAccess {
+  template <typename VariantType>
+  using TypeList = typename std::decay_t<VariantType>::TypeList;
+
+  template <typename VariantType>
+  static constexpr size_t Size() {
+    return TypeList<VariantType>::N;
+  }
+
+  template <typename VariantType>
+  static bool Valueless(const VariantType &variant) {
+    return variant.index_ == VariantType::kNPos;
+  }
+
+  template <typename VariantType>
+  static size_t Index(const VariantType &variant) {
+    return variant.index_;
+  }
+
+  template <size_t Index, typename VariantType,
+            typename T = typename TypeList<VariantType>::template type<Index>>
+  static T &Get(VariantType &variant) {
+    return *reinterpret_cast<T *>(variant.Data());
+  }
+
+  template <size_t Index, typename VariantType,
+            typename T = typename TypeList<VariantType>::template type<Index>>
+  static const T &Get(const VariantType &variant) {
+    return *reinterpret_cast<const T *>(variant.Data());
+  }
 };
 
+// Index of the K-th variant's alternative encoded in a flattened (row-major)
+// index over all alternatives of Variants.
+template <typename... Variants>
+constexpr size_t AlternativeIndex(size_t flat_index, size_t k) {
+  constexpr size_t sizes[] = {VariantAccess::Size<Variants>()...};
+  size_t stride{1};
+  for (size_t i = sizeof...(Variants); i > k + 1; --i) {
+    stride *= sizes[i - 1];
+  }
+  return (flat_index / stride) % sizes[k];
+}
+
+template <size_t FlatIndex, typename R, typename Visitor,
+          typename... Variants>
+struct VisitEntry {
+  static R Apply(Visitor &visitor, Variants &... variants) {
+    return Call(std::index_sequence_for<Variants...>{}, visitor, variants...);
+  }
+
+private:
+  template <size_t... Ks>
+  static R Call(std::index_sequence<Ks...>,
+                Visitor &visitor, Variants &... variants) {
+    return visitor(VariantAccess::Get<
+        AlternativeIndex<std::decay_t<Variants>...>(FlatIndex, Ks)>(
+            variants)...);
+  }
+};
+
+template <typename R, typename Visitor, typename Sequence,
+          typename... Variants>
+struct VisitTable;
+
+// One entry per combination of alternatives, so dispatch is a single indexed
+// load regardless of how many alternatives the variants hold.
+template <typename R, typename Visitor, size_t... FlatIndices,
+          typename... Variants>
+struct VisitTable<R, Visitor, std::index_sequence<FlatIndices...>,
+                  Variants...> {
+  using FunctionPtrType = R (*)(Visitor &, Variants &...);
+  static PROGMEM constexpr const FunctionPtrType kTable[] = {
+      &VisitEntry<FlatIndices, R, Visitor, Variants...>::Apply...};
+
+  static R Dispatch(size_t flat_index,
+                    Visitor &visitor, Variants &... variants) {
+    auto entry = reinterpret_cast<FunctionPtrType>(
+        pgm_read_ptr(kTable + flat_index));
+    return (*entry)(visitor, variants...);
+  }
+};
+
+template <typename... Variants>
+struct NumCombinations : std::integral_constant<size_t, 1> {};
+
+template <typename V0, typename... VN>
+struct NumCombinations<V0, VN...> : std::integral_constant<
+    size_t, VariantAccess::Size<V0>() * NumCombinations<VN...>::value> {};
+
+// Combined row-major alternative index, false if any variant is valueless.
+inline bool FlatIndex(size_t &) {
+  return true;
+}
+
+template <typename V0, typename... VN>
+bool FlatIndex(size_t &flat_index, const V0 &variant, const VN &... variants) {
+  if (VariantAccess::Valueless(variant)) {
+    return false;
+  }
+  flat_index = flat_index * VariantAccess::Size<V0>() +
+               VariantAccess::Index(variant);
+  return FlatIndex(flat_index, variants...);
+}
+
+}  // namespace detail
+
+// Calls visitor with the active alternative of every variant. The call is
+// resolved through a compile-time table of function pointers indexed by the
+// combined alternative index, instead of branching on HoldsAlternative. All
+// combinations must return the same type. If any variant is valueless the
+// visitor is not called and a value-initialized result is returned, so
+// visitors returning a reference are not accepted: there would be nothing to
+// refer to.
+template <typename Visitor, typename... Variants,
+          typename R = decltype(std::declval<Visitor &>()(
+              detail::VariantAccess::Get<0>(std::declval<Variants &>())...)),
+          typename = std::enable_if_t<!std::is_reference<R>::value>>
+R Visit(Visitor &&visitor, Variants &&... variants) {
+  using Table = detail::VisitTable<
+      R, std::remove_reference_t<Visitor>,
+      std::make_index_sequence<
+          detail::NumCombinations<std::decay_t<Variants>...>::value>,
+      std::remove_reference_t<Variants>...>;
+
+  size_t flat_index{0};
+  if (!detail::FlatIndex(flat_index, variants...)) {
+    return R();
+  }
+  return Table::Dispatch(flat_index, visitor, variants...);
+}
+
 }  // namespace common
@@ -0,0 +1,47 @@
+// Bytes and time per message of the text a COMMON_FORMAT call formats
+// against the binary record it stores instead. The record also carries the
+// level, error code and time, the text does not.
+#include "common/binary_log.h"
+
+#include <string>
+
+#include "common/log.h"
+#include "test.h"
+
+namespace {
+
+constexpr size_t kN = 300000;
+
+template <typename Str, typename... Args>
+void Run(const char *name, Str str, const Args &...args) {
+  const common::Time time = common::Time::FromSec(1700000000);
+  size_t text_bytes{0};
+  size_t record_bytes{0};
+  double text_ns = test::NsPerOp(kN, [&](size_t) {
+    std::string msg = common::Format(str, args...);
+    text_bytes = msg.size();
+    test::Use(msg);
+  });
+  double record_ns = test::NsPerOp(kN, [&](size_t) {
+    std::string record = common::BinaryLogRecord(
+        str, common::LOGLEVEL_INFO, 0, time, args...);
+    record_bytes = record.size();
+    test::Use(record);
+  });
+  printf("%-16s %5zu %7.1f %6zu %7.1f\n", name, text_bytes, text_ns,
+         record_bytes, record_ns);
+}
+
+}  // namespace
+
+int main() {
+  printf("args              text (B, ns)  record (B, ns)\n");
+  Run("int, double", COMMON_FORMAT("pump %% reads %% kPa"), 3, 101.325);
+  Run("int16, float", COMMON_FORMAT("pump %% reads %% kPa"), int16_t{3},
+      101.325f);
+  Run("4 x int", COMMON_FORMAT("flow %% ml in %% s, %% of %% runs"), 1250,
+      60, 7, 10);
+  Run("string", COMMON_FORMAT("sensor %% lost"),
+      std::string("greenhouse-dht-1"));
+  return 0;
+}
@@ -0,0 +1,101 @@
+// Poll cycle over 12 slaves at 100 kHz, 8 bytes from each, with loop()
+// doing 200 us of other work per turn. Blocking RequestFrom calls against
+// the BusScheduler run with a Poll() budget per loop(). Reports the time a
+// whole cycle takes, the longest loop() turn and the share of the cycle the
+// bus is busy.
+#include "common/com/bus_scheduler.h"
+
+#include "test.h"
+
+namespace {
+
+namespace I2C = common::com::I2C;
+
+constexpr uint8_t kSlaves = 12;
+constexpr uint8_t kFirst = 0x20;
+constexpr uint8_t kBytes = 8;
+constexpr uint32_t kWorkUs = 200;
+constexpr int kCycles = 10;
+
+class Slave : public sim::I2cDevice {
+public:
+  void OnReceive(const uint8_t *, size_t) override {}
+  size_t OnRequest(uint8_t *data, size_t quantity) override {
+    memset(data, 0x5A, quantity);
+    return quantity;
+  }
+};
+
+struct Result {
+  uint64_t longest_turn_us{0};
+  uint64_t start_us{0};
+
+  void Turn(uint64_t turn_start_us) {
+    uint64_t turn = sim::Now() - turn_start_us;
+    longest_turn_us = turn > longest_turn_us ? turn : longest_turn_us;
+    sim::Advance(kWorkUs);
+  }
+
+  void Print(const char *mode) const {
+    uint64_t cycle_us = (sim::Now() - start_us) / kCycles;
+    printf("%-16s %8llu %10llu %6.0f%%\n", mode,
+           static_cast<unsigned long long>(cycle_us),
+           static_cast<unsigned long long>(longest_turn_us),
+           100.0 * Wire.BusUs() / (sim::Now() - start_us));
+  }
+};
+
+void Start(Result &result) {
+  sim::Reset();
+  Wire.ResetCounters();
+  result = Result();
+}
+
+void Blocking() {
+  Result result;
+  Start(result);
+  for (int cycle{0}; cycle < kCycles; ++cycle) {
+    uint64_t turn_start = sim::Now();
+    for (uint8_t i{0}; i < kSlaves; ++i) {
+      std::string reply;
+      I2C::Request::RequestFrom(kFirst + i, kBytes, reply, 10);
+    }
+    result.Turn(turn_start);
+  }
+  result.Print("blocking");
+}
+
+void Scheduled(uint32_t budget_us) {
+  Result result;
+  Start(result);
+  I2C::BusScheduler<kSlaves, kSlaves> scheduler;
+  scheduler.Begin(10000);
+  for (int cycle{0}; cycle < kCycles; ++cycle) {
+    for (uint8_t i{0}; i < kSlaves; ++i) {
+      scheduler.Request(kFirst + i, kBytes, nullptr);
+    }
+    while (scheduler.Pending()) {
+      uint64_t turn_start = sim::Now();
+      scheduler.Poll(budget_us);
+      result.Turn(turn_start);
+    }
+  }
+  char mode[32];
+  snprintf(mode, sizeof(mode), "budget %u us", budget_us);
+  result.Print(mode);
+}
+
+}  // namespace
+
+int main() {
+  Slave slaves[kSlaves];
+  for (uint8_t i{0}; i < kSlaves; ++i) {
+    sim::AttachI2c(kFirst + i, &slaves[i]);
+  }
+  printf("mode             cycle us  longest us  bus\n");
+  Blocking();
+  for (uint32_t budget_us : {0, 1000, 5000}) {
+    Scheduled(budget_us);
+  }
+  return 0;
+}
@@ -0,0 +1,56 @@
+// Adaptive chunk size at 115200 baud: 40 transfers of 500 bytes starting
+// from 8 byte chunks, against how often the reader's loop() comes back and
+// with or without CRC framing. Reports the chunk size the link settled at,
+// the transfers that went through and the goodput of the last 10.
+#include "com_link.h"
+
+#include "test.h"
+
+namespace {
+
+using common::com::Transfer;
+using common::com::TransferStatus;
+
+void Run(uint32_t loop_ms, bool crc) {
+  test::Link link;
+  link.a_link.crc = link.b_link.crc = crc;
+  Transfer<HardwareSerial> tx;
+  Transfer<HardwareSerial> rx;
+  sim::SetBackground([&] { tx.Poll(); });
+  std::string data = test::Pattern(500);
+  int ok{0};
+  uint64_t start{0};
+  for (int i{0}; i < 40; ++i) {
+    if (i == 30) {
+      start = sim::Now();
+    }
+    tx.BeginWrite(link.a, data, 8, 0, &link.a_link);
+    rx.BeginRead(link.b, 0, 8, 1000, &link.b_link);
+    while (rx.Poll() == TransferStatus::IN_PROGRESS) {
+      if (loop_ms) {
+        delay(loop_ms);
+      } else {
+        yield();
+      }
+    }
+    while (tx.Busy()) {
+      yield();
+    }
+    ok += rx.Status() == TransferStatus::DONE && rx.Data() == data;
+  }
+  printf("%7u %-4s %5u %4d %8.0f\n", loop_ms, crc ? "crc" : "s&w",
+         link.a_link.chunk_size, ok,
+         10 * data.size() * 1e6 / (sim::Now() - start));
+}
+
+}  // namespace
+
+int main() {
+  printf("loop ms mode chunk   ok  bytes/s\n");
+  for (bool crc : {false, true}) {
+    for (uint32_t loop_ms : {0, 5, 10, 20}) {
+      Run(loop_ms, crc);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,67 @@
+// Goodput of 20 transfers of 1000 bytes at 115200 baud against the bit
+// error and byte loss rates, stop-and-wait against CRC framing with a
+// window of 4. Transfers that report success with wrong bytes are counted as
+// corrupt, failed ones as failed.
+#include "com_link.h"
+
+#include "test.h"
+
+namespace {
+
+using common::com::Transfer;
+
+void Run(double bit_error_rate, double drop_rate, bool crc) {
+  sim::LineConfig config;
+  config.bit_error_rate = bit_error_rate;
+  config.drop_rate = drop_rate;
+  config.seed = 11;
+  test::Link link(config);
+  uint8_t window = crc ? 4 : 1;
+  link.a_link.crc = link.b_link.crc = crc;
+  link.a_link.window = link.b_link.window = window;
+  link.a_link.peer_crc = crc;
+  link.a_link.peer_window = window;
+  Transfer<HardwareSerial> tx;
+  sim::SetBackground([&] { tx.Poll(); });
+  std::string data = test::Pattern(1000);
+  size_t delivered{0};
+  int corrupt{0}, failed{0};
+  uint64_t start = sim::Now();
+  for (int i{0}; i < 20; ++i) {
+    link.a_link.chunk_size = 16;
+    tx.BeginWrite(link.a, data, 16, 2000, &link.a_link);
+    std::string got;
+    bool ok = test::Uart::Read(link.b, got, true, false, 100, &link.b_link);
+    while (tx.Busy()) {
+      yield();
+    }
+    if (!ok) {
+      ++failed;
+      delay(100);
+      test::Uart::Drain(link.a);
+      test::Uart::Drain(link.b);
+    } else if (got != data) {
+      ++corrupt;
+    } else {
+      delivered += data.size();
+    }
+  }
+  printf("%-6s %8.0e %8.0e %8.0f %7d %6d\n", crc ? "crc" : "s&w",
+         bit_error_rate, drop_rate, delivered * 1e6 / (sim::Now() - start),
+         corrupt, failed);
+}
+
+}  // namespace
+
+int main() {
+  printf("mode        ber     drop  bytes/s corrupt failed\n");
+  for (bool crc : {false, true}) {
+    for (double ber : {0.0, 1e-5, 1e-4, 1e-3}) {
+      Run(ber, 0, crc);
+    }
+    for (double drop : {1e-4, 1e-3}) {
+      Run(0, drop, crc);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,52 @@
+// Goodput of chunked transfers at 115200 baud against the window size and
+// the line latency. The writer is the blocking Com::Write, the reader a
+// polled Transfer. The window is capped to what fits in the 63 byte RX ring.
+#include "com_link.h"
+
+#include "test.h"
+
+namespace {
+
+using common::com::Transfer;
+
+double Goodput(uint16_t chunk_size, uint8_t window, uint32_t latency_us) {
+  sim::LineConfig config;
+  config.latency_us = latency_us;
+  test::Link link(config);
+  link.a_link.window = window;
+  link.b_link.window = window;
+  Transfer<HardwareSerial> rx;
+  sim::SetBackground([&] { rx.Poll(); });
+  std::string data = test::Pattern(2048);
+  // The first transfer learns the peer's window, the second its RX room.
+  for (int i{0}; i < 3; ++i) {
+    // Pinned, the chunk size adapts after every transfer.
+    link.a_link.chunk_size = chunk_size;
+    uint64_t start = sim::Now();
+    rx.BeginRead(link.b, 0, chunk_size, 0, &link.b_link);
+    test::Com::Write(link.a, data, chunk_size, &link.a_link);
+    if (i == 2) {
+      return data.size() * 1e6 / (sim::Now() - start);
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+
+int main() {
+  printf("chunk window used   0 ms    2 ms   10 ms   (bytes/s)\n");
+  for (uint16_t chunk_size : {8, 16, 32}) {
+    for (uint8_t window{1}; window <= 8; ++window) {
+      uint8_t used = common::com::NegotiatedWindow(
+          common::com::WindowForRoom(window, chunk_size,
+                                     common::com::kRxRingSize), window);
+      printf("%5u %6u %4u", chunk_size, window, used ? used : 1);
+      for (uint32_t latency_us : {0, 2000, 10000}) {
+        printf(" %7.0f", Goodput(chunk_size, window, latency_us));
+      }
+      printf("\n");
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,95 @@
+// Allocations per encoded SensorReading through the std::string interface,
+// a fixed buffer and straight into the serial TX buffer, against the
+// string splicing encoder it replaced. The host std::string keeps up to 15
+// characters inline, so the splice row does not count the three temporaries
+// that each take a heap block with ArduinoSTL.
+#include "common/event/defs.h"
+
+#include <string>
+
+#include "test.h"
+
+namespace {
+
+// SensorReading as it was before symbols and sinks: names in std::string
+// members, and Encode() going through a temporary std::string per field that
+// is spliced into the message.
+struct StringReading {
+  uint32_t sec;
+  double value;
+  std::string sensor_id;
+  std::string sensor_type;
+  std::string data_type;
+  std::string unit;
+
+  void Encode(std::string &msg) const {
+    const std::string *fields[] = {&sensor_id, &sensor_type, &data_type,
+                                   &unit};
+    size_t offset = sizeof(sec) + sizeof(value) + 1;
+    msg.resize(offset + 4 * sizeof(uint32_t) + sensor_id.size() +
+               sensor_type.size() + data_type.size() + unit.size());
+
+    std::string time_encoded, reading_encoded(sizeof(value), '0');
+    common::com::Encode(sec, time_encoded);
+    msg[sizeof(sec)] = 1;
+    common::com::Encode(value, reading_encoded);
+    msg.replace(0, time_encoded.size(), time_encoded);
+    msg.replace(sizeof(sec) + 1, reading_encoded.size(), reading_encoded);
+
+    std::string size_encoded;
+    for (const std::string *field : fields) {
+      common::com::Encode(static_cast<uint32_t>(field->size()), size_encoded);
+      msg.replace(offset, size_encoded.size(), size_encoded);
+      msg.replace(offset + sizeof(uint32_t), field->size(), *field);
+      offset += sizeof(uint32_t) + field->size();
+    }
+  }
+};
+
+template <typename Fn>
+void Run(const char *name, Fn &&fn) {
+  constexpr size_t kN = 1000000;
+  test::ResetAllocs();
+  double ns = test::NsPerOp(kN, fn);
+  printf("%-8s %6.1f ns, %4.1f allocs, %5.1f heap bytes per reading\n", name,
+         ns, static_cast<double>(test::Allocs()) / kN,
+         static_cast<double>(test::AllocBytes()) / kN);
+}
+
+}  // namespace
+
+int main() {
+  common::SensorReading reading;
+  reading.time = common::Time::FromSec(1700000123);
+  reading.sensor_id = common::Symbol::Static("greenhouse-dht-1");
+  reading.sensor_type = common::Symbol::Static("dht22");
+  reading.data_type = common::Symbol::Static("temperature");
+  reading.reading.Emplace<double>(21.5);
+  reading.unit = common::Symbol::Static("C");
+
+  StringReading spliced{1700000123, 21.5, "greenhouse-dht-1", "dht22",
+                        "temperature", "C"};
+
+  Run("splice", [&](size_t) {
+    std::string msg;
+    spliced.Encode(msg);
+    test::Use(msg);
+  });
+  Run("string", [&](size_t) {
+    std::string msg;
+    reading.Encode(msg);
+    test::Use(msg);
+  });
+  Run("buffer", [&](size_t) {
+    char buffer[64];
+    common::com::BufferSink sink(buffer, sizeof(buffer));
+    common::com::Encode(reading, sink);
+    test::Use(buffer);
+  });
+  // Serial is not connected and has no baud rate, the bytes cost no time.
+  Run("stream", [&](size_t) {
+    common::com::StreamSink<HardwareSerial> sink(Serial);
+    common::com::Encode(reading, sink);
+  });
+  return 0;
+}
@@ -0,0 +1,61 @@
+// Time per call of the runtime detail::Format, which searches and splices
+// the message once per argument, against Format with a COMMON_FORMAT
+// string, parsed at compile time and built in one pass. 1 to 8 integer
+// arguments: the runtime Format does not compile with a std::string
+// anywhere but last.
+#include "common/utility/format.h"
+
+#include <string>
+#include <utility>
+
+#include "common/log.h"
+#include "test.h"
+
+namespace {
+
+constexpr size_t kN = 300000;
+
+#define FMT1 "sensor %% failed"
+#define FMT2 FMT1 " %% times"
+#define FMT3 FMT2 " in %% s"
+#define FMT4 FMT3 ", last %%"
+#define FMT5 FMT4 ", retry %%"
+#define FMT6 FMT5 " of %%"
+#define FMT7 FMT6 " at pin %%"
+#define FMT8 FMT7 " bus %%"
+
+template <typename Str, size_t... I>
+void Run(Str str, std::index_sequence<I...>) {
+  constexpr size_t kArgs = sizeof...(I);
+  double runtime_ns = test::NsPerOp(kN, [&](size_t n) {
+    std::string msg = common::detail::Format(
+        str.Data(), static_cast<int>(n + I * 1000)...);
+    test::Use(msg);
+  });
+  double compiled_ns = test::NsPerOp(kN, [&](size_t n) {
+    std::string msg =
+        common::Format(str, static_cast<int>(n + I * 1000)...);
+    test::Use(msg);
+  });
+  printf("%4zu %9.1f %9.1f\n", kArgs, runtime_ns, compiled_ns);
+}
+
+template <typename Str>
+void Run(Str str) {
+  Run(str, std::make_index_sequence<Str::kArgs>{});
+}
+
+}  // namespace
+
+int main() {
+  printf("args  runtime  compiled  (ns per call)\n");
+  Run(COMMON_FORMAT(FMT1));
+  Run(COMMON_FORMAT(FMT2));
+  Run(COMMON_FORMAT(FMT3));
+  Run(COMMON_FORMAT(FMT4));
+  Run(COMMON_FORMAT(FMT5));
+  Run(COMMON_FORMAT(FMT6));
+  Run(COMMON_FORMAT(FMT7));
+  Run(COMMON_FORMAT(FMT8));
+  return 0;
+}
@@ -0,0 +1,95 @@
+// Bits per sample and encode / decode time of Gorilla streams of 100k
+// samples on synthetic traces: a constant value, a DHT22 like temperature
+// (0.1 degree steps of a random walk, a reading every 2 s with a second of
+// jitter), a GY302 like light level (whole lux, larger steps, every 1 s) and
+// uniformly random doubles. The uncompressed sample is 96 bits, a 32 bit
+// time and a double.
+#include "common/com/gorilla.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "test.h"
+
+namespace {
+
+using common::com::ByteSpan;
+using common::com::GorillaDecoder;
+using common::com::GorillaEncoder;
+using common::com::StringSink;
+
+struct Sample {
+  uint32_t sec;
+  double value;
+};
+
+constexpr size_t kSamples = 100000;
+constexpr int kRounds = 20;
+
+template <typename Next>
+std::vector<Sample> Trace(Next next) {
+  std::vector<Sample> samples(kSamples);
+  for (size_t i{0}; i < kSamples; ++i) {
+    samples[i] = next(i);
+  }
+  return samples;
+}
+
+void Run(const char *name, const std::vector<Sample> &samples) {
+  std::string bytes;
+  double encode_ns = test::NsPerOp(kRounds, [&](size_t) {
+    bytes.clear();
+    StringSink sink(bytes);
+    GorillaEncoder encoder;
+    for (const Sample &sample : samples) {
+      encoder.Append(sample.sec, sample.value, sink);
+    }
+    encoder.Finish(sink);
+  }) / kSamples;
+
+  bool ok{true};
+  double decode_ns = test::NsPerOp(kRounds, [&](size_t) {
+    ByteSpan span(bytes);
+    GorillaDecoder decoder(span);
+    uint32_t sec;
+    double value;
+    for (const Sample &sample : samples) {
+      ok &= decoder.Next(sec, value) && sec == sample.sec &&
+            !memcmp(&value, &sample.value, sizeof(value));
+    }
+  }) / kSamples;
+
+  printf("%-10s %6.1f %7.1f %7.1f%s\n", name,
+         8.0 * bytes.size() / kSamples, encode_ns, decode_ns,
+         ok ? "" : " (mismatch)");
+}
+
+}  // namespace
+
+int main() {
+  std::mt19937 random(1);
+  printf("trace      bits   enc ns  dec ns  (per sample)\n");
+  Run("constant", Trace([](size_t i) {
+        return Sample{static_cast<uint32_t>(1700000000 + i * 60), 21.5};
+      }));
+  double temperature{21};
+  Run("dht22", Trace([&](size_t i) {
+        temperature += (static_cast<int>(random() % 5) - 2) / 10.0;
+        return Sample{static_cast<uint32_t>(1700000000 + i * 2 +
+                                            random() % 2),
+                      temperature};
+      }));
+  double lux{300};
+  Run("gy302", Trace([&](size_t i) {
+        lux = std::max(0.0, lux + static_cast<int>(random() % 41) - 20);
+        return Sample{static_cast<uint32_t>(1700000000 + i), lux};
+      }));
+  Run("random", Trace([&](size_t) {
+        uint64_t bits = (static_cast<uint64_t>(random()) << 32) | random();
+        Sample sample{static_cast<uint32_t>(random()), 0};
+        memcpy(&sample.value, &bits, sizeof(bits));
+        return sample;
+      }));
+  return 0;
+}
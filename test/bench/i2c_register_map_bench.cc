@@ -0,0 +1,69 @@
+// Bus use of a master polling a slave's SensorReading at 100 kHz: the whole
+// encoded reading (51 bytes, more than one Wire buffer) read as a register
+// burst, against three fields kept as registers next to it, read one by one
+// or as one range. Bytes count the data bytes, the address byte of every
+// transaction comes on top.
+#include "com_link.h"
+#include "common/event/defs.h"
+
+#include "test.h"
+
+namespace {
+
+namespace I2C = common::com::I2C;
+
+constexpr uint8_t kAddress = 0x12;
+constexpr uint8_t kFields = 128;
+
+using Time = I2C::Register<uint32_t, kFields>;
+using Value = I2C::Register<double, kFields + 4>;
+using Status = I2C::Register<uint8_t, kFields + 12>;
+
+void Report(const char *mode) {
+  printf("%-22s %12u %5llu %8llu\n", mode, Wire.Transactions(),
+         static_cast<unsigned long long>(Wire.Bytes()),
+         static_cast<unsigned long long>(Wire.BusUs()));
+  Wire.ResetCounters();
+}
+
+}  // namespace
+
+int main() {
+  Wire.begin(kAddress);
+  I2C::RegisterMap<kFields + 16> map;
+  map.Attach();
+
+  common::SensorReading reading;
+  reading.time = common::Time::FromSec(1000);
+  reading.sensor_id = common::Symbol::Static("dht-1");
+  reading.sensor_type = common::Symbol::Static("DHT11");
+  reading.data_type = common::Symbol::Static("temperature");
+  reading.reading.Emplace<double>(21.5);
+  reading.unit = common::Symbol::Static("C");
+  std::string encoded;
+  reading.Encode(encoded);
+  map.SetBytes(0, encoded.data(), encoded.size());
+  map.Set<Time>(reading.time.Sec());
+  map.Set<Value>(21.5);
+  map.Set<Status>(0);
+
+  printf("mode                   transactions bytes  bus us\n");
+  Wire.ResetCounters();
+  std::string got(encoded.size(), '\0');
+  I2C::Request::ReadRegisters(kAddress, 0, &got[0], got.size());
+  Report("full reading");
+
+  uint32_t time;
+  double value;
+  uint8_t status;
+  I2C::Request::ReadRegister<Time>(kAddress, time);
+  I2C::Request::ReadRegister<Value>(kAddress, value);
+  I2C::Request::ReadRegister<Status>(kAddress, status);
+  Report("3 fields, one by one");
+
+  char fields[13];
+  I2C::Request::ReadRegisters(kAddress, Time::kOffset, fields,
+                              sizeof(fields));
+  Report("3 fields, one range");
+  return 0;
+}
@@ -0,0 +1,84 @@
+// Host time of a slave write and a slave request through the Router against
+// the number of routes, next to the unrouted single callback. The master
+// side of the Wire stand-in is included, it is the same in every row.
+#include "common/com/com.h"
+
+#include "test.h"
+
+namespace {
+
+namespace I2C = common::com::I2C;
+
+constexpr uint8_t kAddress = 0x10;
+constexpr size_t kOps = 1000000;
+
+int32_t last{0};
+
+void OnValue(const int32_t &value, int) {
+  last = value;
+}
+
+void Answer(int32_t &value) {
+  value = last;
+}
+
+void Print(const char *mode, int routes, double write_ns, double request_ns) {
+  printf("%-9s %6d %9.1f %11.1f\n", mode, routes, write_ns, request_ns);
+  test::Use(last);
+}
+
+// Unrouted callbacks take a message without a type byte.
+void Unrouted() {
+  I2C::Subscriber::RegisterCallback(&OnValue);
+  I2C::Reply::RegisterCallback(&Answer);
+  double write_ns = test::NsPerOp(kOps, [](size_t i) {
+    I2C::Publisher::Publish(kAddress, static_cast<int32_t>(i));
+  });
+  double request_ns = test::NsPerOp(kOps, [](size_t) {
+    int32_t value;
+    Wire.requestFrom(kAddress, static_cast<uint8_t>(sizeof(value)));
+    Wire.readBytes(reinterpret_cast<char *>(&value), sizeof(value));
+    test::Use(value);
+  });
+  Print("unrouted", 1, write_ns, request_ns);
+}
+
+// Routes are added up to the count, the last type is used.
+void Routed(int routes) {
+  static int added{0};
+  for (; added < routes; ++added) {
+    I2C::Subscriber::RegisterCallback(added, &OnValue);
+    I2C::Reply::RegisterCallback(added, &Answer);
+  }
+  uint8_t type = routes - 1;
+  double write_ns = test::NsPerOp(kOps, [type](size_t i) {
+    Wire.beginTransmission(kAddress);
+    Wire.write(type);
+    int32_t value = i;
+    Wire.write(reinterpret_cast<const uint8_t *>(&value), sizeof(value));
+    Wire.endTransmission();
+  });
+  // The selection is made once, requests follow.
+  Wire.beginTransmission(kAddress);
+  Wire.write(type);
+  Wire.endTransmission();
+  double request_ns = test::NsPerOp(kOps, [](size_t) {
+    int32_t value;
+    Wire.requestFrom(kAddress, static_cast<uint8_t>(sizeof(value)));
+    Wire.readBytes(reinterpret_cast<char *>(&value), sizeof(value));
+    test::Use(value);
+  });
+  Print("routed", routes * 2, write_ns, request_ns);
+}
+
+}  // namespace
+
+int main() {
+  Wire.begin(kAddress);
+  printf("mode      routes  write ns  request ns\n");
+  Unrouted();
+  for (int routes : {1, 4, 8, 16}) {
+    Routed(routes);
+  }
+  return 0;
+}
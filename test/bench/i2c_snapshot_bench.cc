@@ -0,0 +1,48 @@
+// Host time and heap allocations of the request ISR answering with an Event,
+// built, encoded and written by the callback against copied from a
+// pre-encoded snapshot. The Wire stand-in's master side is included, it is
+// the same in both rows.
+#include "common/com/com.h"
+#include "common/event/defs.h"
+
+#include "test.h"
+
+namespace {
+
+namespace I2C = common::com::I2C;
+
+constexpr uint8_t kAddress = 0x11;
+constexpr size_t kOps = 200000;
+
+void Fill(common::Event &event) {
+  event.time = common::Time::FromSec(1000);
+  event.error_code = 3;
+  event.event_msg = "flow low";
+}
+
+void Run(const char *mode) {
+  test::ResetAllocs();
+  double ns = test::NsPerOp(kOps, [](size_t) {
+    Wire.requestFrom(kAddress, I2C::kBufferSize);
+    test::Use(Wire.available());
+  });
+  printf("%-8s %8.1f %11.2f\n", mode, ns,
+         static_cast<double>(test::Allocs()) / kOps);
+}
+
+}  // namespace
+
+int main() {
+  Wire.begin(kAddress);
+  printf("mode      ns/req  allocs/req\n");
+  I2C::Reply::RegisterCallback(&Fill);
+  Run("callback");
+
+  I2C::ReplySnapshot snapshot;
+  common::Event event;
+  Fill(event);
+  snapshot.Publish(event);
+  I2C::Reply::RegisterSnapshot(snapshot);
+  Run("snapshot");
+  return 0;
+}
@@ -0,0 +1,80 @@
+// Cost of a Debug call no handler accepts (the default INFO handlers only),
+// against the LogImpl it replaced, which built the Event (RTC read, name
+// and message copies, formatting) before the handlers' levels were looked
+// at. Debug is kept compiled in here: below COMMON_LOG_MIN_LEVEL a call
+// costs nothing at all.
+#define COMMON_LOG_MIN_LEVEL common::LOGLEVEL_DEBUG
+#include "common/log.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "test.h"
+
+namespace {
+
+// The level check as it was, after the Event is built.
+class EagerLog {
+public:
+  explicit EagerLog(const std::string &name) : name_{name} {
+    handlers_.push_back({&handler_, common::LOGLEVEL_INFO});
+    handlers_.push_back({&handler_, common::LOGLEVEL_INFO});
+  }
+
+  template <typename... Args>
+  void Debug(std::string msg, const Args &...args) {
+    if constexpr (sizeof...(Args) > 0) {
+      common::detail::FormatImpl(msg, args...);
+    }
+    common::Event event{common::Time::Now(), common::LOGLEVEL_DEBUG, 0,
+                        common::Symbol(name_), msg};
+    for (auto &handler : handlers_) {
+      if (handler.second <= event.level) {
+        handler.first->Log(event);
+      }
+    }
+  }
+
+private:
+  std::string name_;
+  common::StreamHandler handler_{};
+  std::vector<std::pair<common::StreamHandler *, common::LogLevel>>
+      handlers_{};
+};
+
+constexpr size_t kN = 1000000;
+
+template <typename Fn>
+void Run(const char *name, Fn &&fn) {
+  sim::Reset();
+  test::ResetAllocs();
+  double ns = test::NsPerOp(kN, fn);
+  printf("%-36s %6.1f ns %5.2f allocs %5.2f RTC reads\n", name, ns,
+         static_cast<double>(test::Allocs()) / kN,
+         static_cast<double>(sim::RtcReads()) / kN);
+}
+
+}  // namespace
+
+int main() {
+  EagerLog eager("pump controller");
+  common::Log log("pump controller");
+  std::string state("priming the intake line");
+
+  printf("suppressed Debug call\n");
+  Run("before, literal", [&](size_t) { eager.Debug("flow check"); });
+  Run("before, 2 ints", [&](size_t i) {
+    eager.Debug("flow %% ml after %% s", i, 7);
+  });
+  Run("before, string", [&](size_t) { eager.Debug("state %%", state); });
+  Run("after, literal", [&](size_t) { log.Debug("flow check"); });
+  Run("after, 2 ints", [&](size_t i) {
+    log.Debug("flow %% ml after %% s", i, 7);
+  });
+  Run("after, string", [&](size_t) { log.Debug("state %%", state); });
+  Run("after, COMMON_FORMAT 2 ints", [&](size_t i) {
+    log.Debug(COMMON_FORMAT("flow %% ml after %% s"), i, 7);
+  });
+  return 0;
+}
@@ -0,0 +1,67 @@
+// Error storms through a Log with flood control off, coalescing, a rate
+// limit and both: lines and message bytes that reach the handlers, and
+// the caller's time per call. A minute of simulated time, 1 ms per step:
+// every 10 s, 4 sensors fail for 2 s and warn every step, a pump logs
+// every 100 ms throughout.
+#include "common/log.h"
+
+#include <string>
+
+#include "test.h"
+
+namespace {
+
+// Counts what would go to serial and SD.
+class Counter : public common::StreamHandler {
+public:
+  void Log(const common::Event &event) override {
+    ++lines;
+    bytes += event.event_msg.size() + 1;
+  }
+
+  size_t lines{0};
+  size_t bytes{0};
+};
+
+constexpr uint32_t kSteps = 60000;
+
+void Run(const char *name, uint16_t window_ms, uint8_t burst,
+         uint16_t per_minute) {
+  sim::Reset();
+  common::Log log("storm");
+  Counter counter;
+  log.AddStreamHandler(&counter, common::LOGLEVEL_INFO);
+  log.SetCoalesceWindow(window_ms);
+  log.SetRateLimit(burst, per_minute);
+  size_t calls{0};
+  double ns = test::NsPerOp(kSteps, [&](size_t step) {
+    bool storm = step % 10000 < 2000;
+    for (uint8_t sensor{0}; storm && sensor < 4; ++sensor) {
+      log.Warn(sensor + 1, COMMON_FORMAT("sensor %% read failed, retry %%"),
+               sensor, step);
+      ++calls;
+    }
+    if (step % 100 == 0) {
+      log.Info(COMMON_FORMAT("pump at %% rpm"), 1400 + step % 7);
+      ++calls;
+    }
+    sim::Advance(1000);
+  });
+  log.Pump();
+  common::LogLimitStats stats = log.GetLimitStats();
+  printf("%-14s %7zu %6zu %9zu %9u %8u %7.1f\n", name, calls, counter.lines,
+         counter.bytes, stats.coalesced, stats.rate_limited,
+         ns * kSteps / calls);
+}
+
+}  // namespace
+
+int main() {
+  printf("               calls  lines     bytes coalesced  limited  ns/call\n");
+  Run("off", 0, 0, 0);
+  Run("coalesce 1 s", 1000, 0, 0);
+  Run("coalesce 10 s", 10000, 0, 0);
+  Run("rate 20, 600", 0, 20, 600);
+  Run("both", 1000, 20, 600);
+  return 0;
+}
@@ -0,0 +1,75 @@
+// Caller side latency of Log::Info with a handler that blocks 1.7 ms per
+// line (a 100 character line at 9600 baud is ~100 ms, an SD append a few
+// ms), in a loop() doing 500 us of work and logging every 4th turn.
+// Handlers run in the caller, from Pump(1000) at the end of every turn, or
+// on the host worker thread. Wall clock, the handler and the loop work
+// sleep.
+#define COMMON_LOG_THREAD
+#include "common/log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "test.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using common::LogQueuePolicy;
+
+constexpr int kMessages = 750;
+
+class SlowHandler : public common::StreamHandler {
+public:
+  void Log(const common::Event &) override {
+    std::this_thread::sleep_for(std::chrono::microseconds(1700));
+  }
+};
+
+enum class Mode { kSync, kPump, kWorker };
+
+void Run(const char *name, Mode mode) {
+  common::Log log("bench");
+  SlowHandler handler;
+  log.AddStreamHandler(&handler, common::LOGLEVEL_INFO);
+  if (mode != Mode::kSync) {
+    log.SetQueuePolicy(LogQueuePolicy::kDropOldest);
+  }
+  if (mode == Mode::kWorker) {
+    log.StartWorker();
+  }
+  std::vector<double> latency_us;
+  for (int turn{0}; latency_us.size() < kMessages; ++turn) {
+    if (turn % 4 == 0) {
+      Clock::time_point start = Clock::now();
+      log.Info(COMMON_FORMAT("turn %% flow %% ml/min"), turn, 120);
+      latency_us.push_back(
+          std::chrono::duration<double, std::micro>(Clock::now() - start)
+              .count());
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(500));
+    if (mode == Mode::kPump) {
+      log.Pump(1000);
+    }
+  }
+  if (mode == Mode::kWorker) {
+    log.StopWorker();
+  }
+  std::sort(latency_us.begin(), latency_us.end());
+  printf("%-22s %8.1f %8.1f %9.1f %8u\n", name,
+         latency_us[latency_us.size() / 2],
+         latency_us[latency_us.size() * 99 / 100], latency_us.back(),
+         log.GetQueueStats().dropped);
+}
+
+}  // namespace
+
+int main() {
+  printf("mode                    p50 us   p99 us    max us  dropped\n");
+  Run("sync", Mode::kSync);
+  Run("queue + Pump(1000)", Mode::kPump);
+  Run("queue + worker thread", Mode::kWorker);
+  return 0;
+}
@@ -0,0 +1,90 @@
+// Gateway filter over 1M encoded SensorReadings: keep the readings of one
+// sensor whose value is above a threshold. Through a SensorReadingView the
+// decision reads two fields in place, through a full Decode every field is
+// copied into a SensorReading first.
+#include "common/event/defs.h"
+
+#include <string>
+#include <vector>
+
+#include "test.h"
+
+namespace {
+
+using common::com::ByteSpan;
+
+template <typename Policy>
+struct Reading : common::SensorReading {
+  using EncodingPolicy = Policy;
+};
+
+constexpr size_t kReadings = 1000000;
+constexpr size_t kSensors = 8;
+
+template <typename Policy>
+std::string Stream() {
+  static const char *kIds[kSensors] = {"dht-0", "dht-1", "dht-2", "dht-3",
+                                       "dht-4", "dht-5", "dht-6", "dht-7"};
+  std::string stream;
+  common::com::StringSink sink(stream);
+  Reading<Policy> reading;
+  reading.sensor_type = common::Symbol::Static("dht22");
+  reading.data_type = common::Symbol::Static("temperature");
+  reading.unit = common::Symbol::Static("C");
+  for (size_t i{0}; i < kReadings; ++i) {
+    reading.time = common::Time::FromSec(1700000000 + i);
+    reading.sensor_id = common::Symbol::Static(kIds[i % kSensors]);
+    reading.reading.template Emplace<double>(15 + (i % 200) * 0.1);
+    common::com::Encode(reading, sink);
+  }
+  return stream;
+}
+
+template <typename Policy>
+void Run(const char *name) {
+  using View = common::com::MessageView<Reading<Policy>>;
+  std::string stream = Stream<Policy>();
+
+  size_t kept{0};
+  test::ResetAllocs();
+  double view_ns = test::NsPerOp(1, [&](size_t) {
+    for (size_t offset{0}; offset < stream.size();) {
+      View view(stream.data() + offset, stream.size() - offset);
+      const double *value =
+          view.template Get<&common::SensorReading::reading>()
+              .template GetIf<double>();
+      kept += view.template Get<&common::SensorReading::sensor_id>() ==
+                  "dht-3" && value && *value > 30;
+      offset += view.Size();
+      if (!view.Ok()) {
+        break;
+      }
+    }
+  });
+  size_t view_allocs = test::Allocs();
+
+  size_t decoded_kept{0};
+  test::ResetAllocs();
+  double decode_ns = test::NsPerOp(1, [&](size_t) {
+    ByteSpan span(stream);
+    Reading<Policy> reading;
+    while (span.Remaining() && common::com::Decode(span, reading)) {
+      const double *value = reading.reading.template GetIf<double>();
+      decoded_kept +=
+          reading.sensor_id == "dht-3" && value && *value > 30;
+    }
+  });
+  size_t decode_allocs = test::Allocs();
+
+  printf("%-8s view %6.1f ms %8zu allocs, decode %6.1f ms %8zu allocs%s\n",
+         name, view_ns / 1e6, view_allocs, decode_ns / 1e6, decode_allocs,
+         kept == decoded_kept ? "" : " (mismatch)");
+}
+
+}  // namespace
+
+int main() {
+  Run<common::com::FixedEncoding>("fixed");
+  Run<common::com::CompactEncoding>("compact");
+  return 0;
+}
@@ -0,0 +1,94 @@
+// Size and encode / decode time of 10k SensorReadings from 16 sensors,
+// encoded one by one (FixedEncoding) against one SensorReadingBatch. Half
+// the sensors report a double temperature, the others an int humidity, a
+// reading every 10 s.
+#include "common/event/sensor_reading_batch.h"
+
+#include <string>
+#include <vector>
+
+#include "test.h"
+
+namespace {
+
+using common::SensorReading;
+using common::SensorReadingBatch;
+using common::com::BufferSink;
+using common::com::ByteSpan;
+
+constexpr size_t kReadings = 10000;
+constexpr size_t kSensors = 16;
+constexpr int kRounds = 50;
+
+std::vector<SensorReading> Readings() {
+  static char ids[kSensors][8];
+  std::vector<SensorReading> readings(kReadings);
+  for (size_t i{0}; i < kReadings; ++i) {
+    size_t sensor = i % kSensors;
+    snprintf(ids[sensor], sizeof(ids[sensor]), "dht-%zu", sensor);
+    SensorReading &reading = readings[i];
+    reading.time = common::Time::FromSec(1700000000 + i / kSensors * 10);
+    reading.sensor_id = common::Symbol::Static(ids[sensor]);
+    reading.sensor_type = common::Symbol::Static("dht22");
+    if (sensor % 2) {
+      reading.data_type = common::Symbol::Static("humidity");
+      reading.unit = common::Symbol::Static("%");
+      reading.reading.Emplace<int>(40 + i % 20);
+    } else {
+      reading.data_type = common::Symbol::Static("temperature");
+      reading.unit = common::Symbol::Static("C");
+      reading.reading.Emplace<double>(20 + (i % 50) * 0.1);
+    }
+  }
+  return readings;
+}
+
+}  // namespace
+
+int main() {
+  std::vector<SensorReading> readings = Readings();
+  static char buffer[kReadings * 64];
+
+  size_t single_size{0};
+  double single_enc = test::NsPerOp(kRounds, [&](size_t) {
+    BufferSink sink(buffer, sizeof(buffer));
+    for (const SensorReading &reading : readings) {
+      common::com::Encode(reading, sink);
+    }
+    single_size = sink.Size();
+  });
+  SensorReading decoded;
+  bool ok{true};
+  double single_dec = test::NsPerOp(kRounds, [&](size_t) {
+    ByteSpan span(buffer, single_size);
+    for (size_t i{0}; i < kReadings; ++i) {
+      ok &= common::com::Decode(span, decoded);
+    }
+  });
+
+  SensorReadingBatch batch;
+  size_t batch_size{0};
+  double batch_enc = test::NsPerOp(kRounds, [&](size_t) {
+    batch.Clear();
+    for (const SensorReading &reading : readings) {
+      batch.Add(reading);
+    }
+    BufferSink sink(buffer, sizeof(buffer));
+    batch.Encode(sink);
+    batch_size = sink.Size();
+  });
+  SensorReadingBatch batch_decoded;
+  double batch_dec = test::NsPerOp(kRounds, [&](size_t) {
+    ByteSpan span(buffer, batch_size);
+    batch_decoded.Decode(span);
+    ok &= span.Ok() && batch_decoded.Size() == kReadings;
+  });
+
+  printf("encoding   bytes   ratio  enc ms  dec ms  (10k readings)\n");
+  printf("single  %8zu  %5.2f  %6.2f  %6.2f\n", single_size, 1.0,
+         single_enc / 1e6, single_dec / 1e6);
+  printf("batch   %8zu  %5.2f  %6.2f  %6.2f%s\n", batch_size,
+         static_cast<double>(single_size) / batch_size, batch_enc / 1e6,
+         batch_dec / 1e6, ok ? "" : " (decode failed)");
+  return 0;
+}
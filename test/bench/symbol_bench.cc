@@ -0,0 +1,77 @@
+// Time and heap use per DHT22::GenerateSensorReading(), which copies symbol
+// handles, against the std::string copies it replaced: the id member and
+// the three PROGMEM constants copied into a reading with std::string
+// fields. The host std::string keeps up to 15 characters inline, which
+// ArduinoSTL does not, so the second row uses a longer id as well.
+#include "common/device/temperature_sensor.h"
+
+#include <string>
+
+#include "test.h"
+
+namespace {
+
+PROGMEM const char *const kSensorType = "DHT22";
+PROGMEM const char *const kUnitName[] = {"\xB0" "C", "%"};
+PROGMEM const char *const kDataType[] = {"temperature", "humidity"};
+
+struct StringReading {
+  common::Time time{common::Time::FromSec(0)};
+  std::string sensor_id;
+  std::string sensor_type;
+  std::string data_type;
+  common::DeviceDataType reading;
+  std::string unit;
+};
+
+// The sensor as it was, texts copied out on every reading.
+class StringSensor {
+public:
+  explicit StringSensor(const std::string &id) : id_{id} {}
+
+  StringReading GenerateSensorReading(uint8_t datatype_idx) const {
+    StringReading reading;
+    reading.time = t_;
+    reading.sensor_id = id_;
+    reading.sensor_type =
+        reinterpret_cast<const char *>(pgm_read_ptr(&kSensorType));
+    reading.reading = common::DeviceDataType(double(data_[datatype_idx]));
+    reading.data_type =
+        reinterpret_cast<const char *>(pgm_read_ptr(kDataType + datatype_idx));
+    reading.unit =
+        reinterpret_cast<const char *>(pgm_read_ptr(kUnitName + datatype_idx));
+    return reading;
+  }
+
+private:
+  std::string id_;
+  common::Time t_{common::Time::FromSec(1700000000)};
+  float data_[2] = {21.5f, 40.0f};
+};
+
+constexpr size_t kN = 2000000;
+
+template <typename Sensor>
+void Run(const char *name, const Sensor &sensor) {
+  test::ResetAllocs();
+  double ns = test::NsPerOp(kN, [&sensor](size_t i) {
+    auto reading = sensor.GenerateSensorReading(i % 2);
+    test::Use(reading);
+  });
+  printf("%-22s %6.1f ns %5.2f allocs %6.1f heap bytes\n", name, ns,
+         static_cast<double>(test::Allocs()) / kN,
+         static_cast<double>(test::AllocBytes()) / kN);
+}
+
+}  // namespace
+
+int main() {
+  printf("per GenerateSensorReading() call\n");
+  Run("strings, short id", StringSensor("dht-1"));
+  Run("strings, long id", StringSensor("greenhouse-north-dht"));
+  common::device::DHT22 sensor("greenhouse-north-dht", 2);
+  sim::Advance(3000000);
+  sensor.UpdateReading();
+  Run("symbols", sensor);
+  return 0;
+}
@@ -0,0 +1,100 @@
+// SensorReadings per second in telemetry mode (COBS packets with a sequence
+// number, nothing sent back) against the acked chunk protocol (blocking
+// write, polled reader), at 9600 and 115200 baud and with line latency.
+// Reports the bytes each side put on the wire per reading.
+#include "com_link.h"
+
+#include "common/com/cobs.h"
+#include "common/event/defs.h"
+#include "test.h"
+
+namespace {
+
+using common::com::PacketDecoder;
+using common::com::TelemetryStats;
+using common::com::Transfer;
+using common::com::TransferStatus;
+
+constexpr uint32_t kReadings = 100;
+
+common::SensorReading Reading(uint32_t i) {
+  common::SensorReading reading;
+  reading.time = common::Time::FromSec(i);
+  reading.sensor_id = common::Symbol::Static("greenhouse-dht-1");
+  reading.unit = common::Symbol::Static("C");
+  reading.reading.Emplace<double>(21.5);
+  return reading;
+}
+
+sim::LineConfig Config(long baud, uint32_t latency_us) {
+  sim::LineConfig config;
+  config.baud = baud;
+  config.latency_us = latency_us;
+  return config;
+}
+
+void Print(const char *mode, long baud, uint32_t latency_us,
+           const test::Link &link, uint32_t delivered, uint64_t time_us) {
+  printf("%-9s %6ld %6.0f %7.1f %7.1f %9u %10.0f\n", mode, baud,
+         latency_us / 1000.0, static_cast<double>(link.a.Sent()) / kReadings,
+         static_cast<double>(link.b.Sent()) / kReadings, delivered,
+         delivered * 1e6 / time_us);
+}
+
+void Telemetry(long baud, uint32_t latency_us) {
+  test::Link link(Config(baud, latency_us));
+  PacketDecoder decoder(common::com::UART::kMaxPacketSize);
+  TelemetryStats stats;
+  sim::SetBackground([&] {
+    common::SensorReading reading;
+    while (test::Uart::ReadTelemetry(link.b, decoder, stats, reading, false,
+                                     0)) {
+    }
+  });
+  uint16_t seq{0};
+  for (uint32_t i{0}; i < kReadings; ++i) {
+    test::Uart::WriteTelemetry(link.a, seq, Reading(i));
+  }
+  link.a.flush();
+  // The writer is done once the last byte left, the reader a latency later.
+  uint64_t time_us = sim::Now();
+  delay(latency_us / 1000 + 1);
+  CHECK_EQ(stats.received, kReadings);
+  Print("telemetry", baud, latency_us, link, stats.received, time_us);
+}
+
+void Acked(long baud, uint32_t latency_us) {
+  test::Link link(Config(baud, latency_us));
+  Transfer<HardwareSerial> rx;
+  uint32_t delivered{0};
+  sim::SetBackground([&] {
+    if (rx.Poll() != TransferStatus::IN_PROGRESS) {
+      common::SensorReading reading;
+      if (rx.Get(reading)) {
+        ++delivered;
+      }
+      test::Uart::BeginRead<common::SensorReading>(link.b, rx, 1000,
+                                                   &link.b_link, nullptr);
+    }
+  });
+  for (uint32_t i{0}; i < kReadings; ++i) {
+    test::Uart::Write(link.a, Reading(i), 1000, &link.a_link);
+  }
+  uint64_t time_us = sim::Now();
+  yield();
+  CHECK_EQ(delivered, kReadings);
+  Print("acked", baud, latency_us, link, delivered, time_us);
+}
+
+}  // namespace
+
+int main() {
+  printf("mode        baud lat ms  a->b B  b->a B delivered  readings/s\n");
+  for (long baud : {9600L, 115200L}) {
+    for (uint32_t latency_us : {0u, 2000u, 10000u}) {
+      Telemetry(baud, latency_us);
+      Acked(baud, latency_us);
+    }
+  }
+  return test::Result();
+}
@@ -0,0 +1,50 @@
+// Time HardwareCom::Write spends blocked on the UART, straight against
+// coalesced (32 bytes or 10 ms), for 1000 int32_t writes with the caller's
+// loop() coming back every loop_ms. Reports the blocked time per write and
+// the share of the loop it takes.
+#include "com_link.h"
+
+#include "test.h"
+
+namespace {
+
+using Com = common::com::UART::HardwareCom<0, 64>;
+
+void Run(long baud, uint32_t loop_ms, bool coalesce) {
+  sim::LineConfig config;
+  config.baud = baud;
+  HardwareSerial peer;
+  sim::Reset();
+  sim::Connect(Serial, peer, config);
+  Com::Init(baud);
+  Com::SetCoalescing(coalesce ? 32 : 0, 10);
+  constexpr int kWrites = 1000;
+  uint64_t start = sim::Now();
+  for (int32_t i{0}; i < kWrites; ++i) {
+    Com::Write(i);
+    // The peer's reader keeps up, only the sending side is measured.
+    while (peer.read() >= 0) {}
+    delay(loop_ms);
+    Com::Poll();
+  }
+  Com::Flush();
+  uint64_t blocked_us = Serial.BlockedUs();
+  printf("%6ld %7u %-9s %9.1f %6.1f%%\n", baud, loop_ms,
+         coalesce ? "coalesced" : "straight",
+         static_cast<double>(blocked_us) / kWrites,
+         100.0 * blocked_us / (sim::Now() - start));
+}
+
+}  // namespace
+
+int main() {
+  printf("  baud loop ms mode      us/write  share\n");
+  for (long baud : {9600, 115200}) {
+    for (uint32_t loop_ms : {1, 10}) {
+      for (bool coalesce : {false, true}) {
+        Run(baud, loop_ms, coalesce);
+      }
+    }
+  }
+  return 0;
+}
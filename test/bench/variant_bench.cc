@@ -0,0 +1,184 @@
+// Construct, copy and move of a Variant holding a double or a short
+// string, against the heap allocating Variant of the baseline, vendored
+// below as it was (binary search dispatch, without the unused Construct).
+#include "common/utility/variant.h"
+
+#include <string>
+#include <utility>
+
+#include "test.h"
+
+namespace baseline {
+
+namespace detail {
+
+template <size_t StartIndex, size_t EndIndex, typename ...Types,
+    typename = std::enable_if_t<!(StartIndex <= EndIndex)>>
+bool Destroy(...) {
+  return false;
+}
+
+template <size_t StartIndex, size_t EndIndex, typename ...Types,
+          typename = std::enable_if_t<StartIndex <= EndIndex>,
+          typename TypeList = common::type_traits::VariadicTypeTraits<Types...>,
+          typename CurType = typename TypeList::template type<StartIndex>>
+bool Destroy(size_t index, void *data) {
+  constexpr size_t mid = (StartIndex + EndIndex) / 2;
+  if (mid == index) {
+    auto ptr = reinterpret_cast<CurType *>(data);
+    delete ptr;
+    return true;
+  }
+  if constexpr (mid == StartIndex) {
+    return Destroy<StartIndex + 1, EndIndex, Types...>(index, data);
+  }
+  return index > mid ? Destroy<mid, EndIndex, Types...>(index, data) :
+                       Destroy<StartIndex, mid, Types...>(index, data);
+}
+
+template <size_t StartIndex, size_t EndIndex, typename ...Types,
+    typename = std::enable_if_t<!(StartIndex <= EndIndex)>>
+void *Copy(...) {
+  return nullptr;
+}
+
+template <size_t StartIndex, size_t EndIndex, typename ...Types,
+    typename = std::enable_if_t<StartIndex <= EndIndex>,
+    typename TypeList = common::type_traits::VariadicTypeTraits<Types...>,
+    typename CurType = typename TypeList::template type<StartIndex>>
+void *Copy(size_t index, const void *data) {
+  constexpr size_t mid = (StartIndex + EndIndex) / 2;
+  if (mid == index) {
+    return reinterpret_cast<void *>(
+        new CurType{*reinterpret_cast<const CurType *>(data)});
+  }
+  if constexpr (mid == StartIndex) {
+    return Copy<StartIndex + 1, EndIndex, Types...>(index, data);
+  }
+  return index > mid ? Copy<mid, EndIndex, Types...>(index, data) :
+         Copy<StartIndex, mid, Types...>(index, data);
+}
+
+}  // namespace detail
+
+template <class... Types>
+class Variant {
+private:
+  using TypeList = common::type_traits::VariadicTypeTraits<Types...>;
+
+public:
+  Variant() = default;
+
+  Variant(const Variant &other)  {
+    *this = other;
+  }
+
+  Variant(Variant &&other) {
+    *this = std::move(other);
+  }
+
+  Variant &operator=(const Variant &other) {
+    data_ = detail::Copy<0, TypeList::N - 1, Types...>(
+        other.index_, other.data_);
+    if (data_) {
+      index_ = other.index_;
+    }
+    return *this;
+  };
+
+  Variant &operator=(Variant &&other) {
+    this->~Variant();
+    data_ = other.data_;
+    index_ = other.index_;
+    other.data_ = nullptr;
+    other.index_ = std::numeric_limits<size_t>::max();
+    return *this;
+  };
+
+  ~Variant() {
+    if (index_ < TypeList::N && data_) {
+      detail::Destroy<0, TypeList::N - 1, Types...>(index_, data_);
+      index_ = std::numeric_limits<size_t>::max();
+      data_ = nullptr;
+    }
+  }
+
+  template <
+      typename T,
+      size_t Index = TypeList::template GetIndex<T>(),
+      typename = std::enable_if_t<TypeList::template Has<T>()>>
+  explicit Variant(T&& arg) {
+    index_ = Index;
+    data_ = reinterpret_cast<void *>(
+        new typename TypeList::template type<Index>{std::forward<T>(arg)});
+  }
+
+  template <typename T, size_t Index = TypeList::template GetIndex<T>()>
+  const T *GetIf() const {
+    return index_ == Index ? reinterpret_cast<T *>(data_) : nullptr;
+  }
+
+private:
+  void *data_{nullptr};
+  size_t index_ = std::numeric_limits<size_t>::max();
+};
+
+}  // namespace baseline
+
+namespace {
+
+constexpr size_t kN = 2000000;
+
+struct Result {
+  double ns;
+  double allocs;
+};
+
+template <typename Fn>
+Result Measure(Fn &&fn) {
+  test::ResetAllocs();
+  double ns = test::NsPerOp(kN, fn);
+  return {ns, static_cast<double>(test::Allocs()) / kN};
+}
+
+// make(i) gives the value to hold.
+template <template <class...> class V, typename Make>
+void Run(const char *name, Make make) {
+  using Value = V<double, int, std::string>;
+  Result construct = Measure([&](size_t i) {
+    Value a(make(i));
+    test::Use(a);
+  });
+  Result copy = Measure([&](size_t i) {
+    Value a(make(i));
+    Value b(a);
+    test::Use(b);
+  });
+  Result move = Measure([&](size_t i) {
+    Value a(make(i));
+    Value b(std::move(a));
+    test::Use(b);
+  });
+  printf("%-18s %7.1f %4.1f %7.1f %4.1f %7.1f %4.1f\n", name, construct.ns,
+         construct.allocs, copy.ns, copy.allocs, move.ns, move.allocs);
+}
+
+double MakeDouble(size_t i) {
+  return static_cast<double>(i);
+}
+
+std::string MakeString(size_t i) {
+  return std::string(1, static_cast<char>('a' + i % 26));
+}
+
+}  // namespace
+
+int main() {
+  printf("                   construct     +copy         +move"
+         "     (ns, allocs)\n");
+  Run<common::Variant>("double in place", MakeDouble);
+  Run<baseline::Variant>("double baseline", MakeDouble);
+  Run<common::Variant>("string in place", MakeString);
+  Run<baseline::Variant>("string baseline", MakeString);
+  return 0;
+}
@@ -0,0 +1,94 @@
+// Encoded size and encode / decode time of Event and SensorReading streams
+// under FixedEncoding and CompactEncoding. Events carry error codes under
+// 16 and messages of 5 to 30 characters, readings alternate a double and a
+// small int. Encoding goes into a fixed buffer, decoding from a span.
+#include "common/event/defs.h"
+
+#include <string>
+#include <vector>
+
+#include "test.h"
+
+namespace {
+
+using common::com::BufferSink;
+using common::com::ByteSpan;
+
+template <typename Base, typename Policy>
+struct WithPolicy : Base {
+  using EncodingPolicy = Policy;
+};
+
+template <typename Policy>
+using EventOf = WithPolicy<common::Event, Policy>;
+template <typename Policy>
+using ReadingOf = WithPolicy<common::SensorReading, Policy>;
+
+constexpr size_t kMessages = 1000;
+constexpr int kRounds = 200;
+
+template <typename Policy>
+std::vector<EventOf<Policy>> Events() {
+  std::vector<EventOf<Policy>> events(kMessages);
+  for (size_t i{0}; i < kMessages; ++i) {
+    events[i].time = common::Time::FromSec(1700000000 + i * 60);
+    events[i].error_code = i % 16;
+    events[i].source_name = common::Symbol::Static("pump");
+    events[i].event_msg = std::string(5 + i % 26, 'e');
+  }
+  return events;
+}
+
+template <typename Policy>
+std::vector<ReadingOf<Policy>> Readings() {
+  std::vector<ReadingOf<Policy>> readings(kMessages);
+  for (size_t i{0}; i < kMessages; ++i) {
+    readings[i].time = common::Time::FromSec(1700000000 + i * 2);
+    readings[i].sensor_id = common::Symbol::Static("dht-1");
+    readings[i].sensor_type = common::Symbol::Static("dht22");
+    readings[i].unit = common::Symbol::Static("C");
+    if (i % 2) {
+      readings[i].data_type = common::Symbol::Static("humidity");
+      readings[i].reading.template Emplace<int>(40 + i % 20);
+    } else {
+      readings[i].data_type = common::Symbol::Static("temperature");
+      readings[i].reading.template Emplace<double>(20 + (i % 50) * 0.1);
+    }
+  }
+  return readings;
+}
+
+template <typename Message>
+void Run(const char *name, const std::vector<Message> &messages) {
+  static char buffer[kMessages * 96];
+  size_t size{0};
+  double encode_ns = test::NsPerOp(kRounds, [&](size_t) {
+    BufferSink sink(buffer, sizeof(buffer));
+    for (const Message &message : messages) {
+      common::com::Encode(message, sink);
+    }
+    size = sink.Size();
+  }) / kMessages;
+  Message decoded;
+  bool ok{true};
+  double decode_ns = test::NsPerOp(kRounds, [&](size_t) {
+    ByteSpan span(buffer, size);
+    for (size_t i{0}; i < kMessages; ++i) {
+      ok &= common::com::Decode(span, decoded);
+    }
+  }) / kMessages;
+  printf("%-22s %6.1f %8.1f %8.1f%s\n", name,
+         static_cast<double>(size) / kMessages, encode_ns, decode_ns,
+         ok ? "" : " (decode failed)");
+}
+
+}  // namespace
+
+int main() {
+  printf("stream                 bytes  enc ns   dec ns  (per message)\n");
+  Run("Event fixed", Events<common::com::FixedEncoding>());
+  Run("Event compact", Events<common::com::CompactEncoding>());
+  Run("SensorReading fixed", Readings<common::com::FixedEncoding>());
+  Run("SensorReading compact", Readings<common::com::CompactEncoding>());
+  return 0;
+}
@@ -0,0 +1,138 @@
+#include "common/binary_log.h"
+
+#include <string>
+#include <vector>
+
+#include "common/log.h"
+#include "test.h"
+
+namespace {
+
+using common::BinaryLogType;
+
+// Undoes the COBS framing, empty if the record is not one frame.
+std::string Unframe(const std::string &record) {
+  std::string payload;
+  if (record.empty() || record.back() != '\0') {
+    return payload;
+  }
+  for (size_t i{0}; i + 1 < record.size();) {
+    uint8_t code = record[i];
+    if (!code || i + code > record.size() - 1) {
+      return std::string();
+    }
+    payload.append(record, i + 1, code - 1);
+    i += code;
+    if (code < 0xFF && i + 1 < record.size()) {
+      payload.push_back('\0');
+    }
+  }
+  return payload;
+}
+
+template <typename T>
+T Read(const std::string &payload, size_t offset) {
+  T value;
+  memcpy(&value, payload.data() + offset, sizeof(value));
+  return value;
+}
+
+// Header, argument type nibbles, then the raw arguments.
+void TestLayout() {
+  constexpr auto kFormat = COMMON_FORMAT("pump %% at %% rpm, %% (%%) %%");
+  std::string name(300, 'n');
+  common::Symbol unit = common::Symbol::Static("rpm");
+  std::string record = common::BinaryLogRecord(
+      kFormat, common::LOGLEVEL_WARN, 7, common::Time::FromSec(1700000000),
+      int16_t{-3}, 1450.5f, name, unit, true);
+  CHECK_EQ(record.find('\0'), record.size() - 1);
+
+  std::string payload = Unframe(record);
+  CHECK_EQ(Read<uint16_t>(payload, 0), kFormat.kId);
+  CHECK_EQ(Read<int8_t>(payload, 2), common::LOGLEVEL_WARN);
+  CHECK_EQ(Read<uint8_t>(payload, 3), 7);
+  CHECK_EQ(Read<uint32_t>(payload, 4), 1700000000u);
+  CHECK_EQ(Read<uint8_t>(payload, 8),
+           static_cast<uint8_t>(BinaryLogType::kI16) |
+               static_cast<uint8_t>(BinaryLogType::kF32) << 4);
+  CHECK_EQ(Read<uint8_t>(payload, 9),
+           static_cast<uint8_t>(BinaryLogType::kString) |
+               static_cast<uint8_t>(BinaryLogType::kString) << 4);
+  CHECK_EQ(Read<uint8_t>(payload, 10),
+           static_cast<uint8_t>(BinaryLogType::kBool));
+  CHECK_EQ(Read<int16_t>(payload, 11), -3);
+  CHECK(Read<float>(payload, 13) == 1450.5f);
+  // Strings are cut at 255 bytes.
+  CHECK_EQ(Read<uint8_t>(payload, 17), 255);
+  CHECK(payload.compare(18, 255, name, 0, 255) == 0);
+  CHECK_EQ(Read<uint8_t>(payload, 273), 3);
+  CHECK(payload.compare(274, 3, "rpm") == 0);
+  CHECK_EQ(Read<uint8_t>(payload, 277), 1);
+  CHECK_EQ(payload.size(), 278u);
+
+  // Framed as it is encoded, into one allocation.
+  test::ResetAllocs();
+  std::string again = common::BinaryLogRecord(
+      kFormat, common::LOGLEVEL_WARN, 7, common::Time::FromSec(1700000000),
+      int16_t{-3}, 1450.5f, name, unit, true);
+  CHECK_EQ(test::Allocs(), 1u);
+  CHECK(again == record);
+}
+
+// Types follow the argument's size and sign, whatever its name.
+static_assert(common::detail::BinaryLogTypeOf<uint8_t>() ==
+              BinaryLogType::kU8);
+static_assert(common::detail::BinaryLogTypeOf<int64_t>() ==
+              BinaryLogType::kI64);
+static_assert(common::detail::BinaryLogTypeOf<unsigned long long>() ==
+              BinaryLogType::kU64);
+static_assert(common::detail::BinaryLogTypeOf<double>() ==
+              BinaryLogType::kF64);
+static_assert(common::detail::BinaryLogTypeOf<const char *>() ==
+              BinaryLogType::kString);
+static_assert(common::detail::BinaryLogTypeOf<char *>() ==
+              BinaryLogType::kString);
+
+class Recorder : public common::StreamHandler {
+public:
+  void Log(const common::Event &event) override {
+    text.push_back(event.event_msg);
+  }
+
+  void LogBinary(const common::Time &, const std::string &record) override {
+    records.push_back(record);
+  }
+
+  std::vector<std::string> text{};
+  std::vector<std::string> records{};
+};
+
+// In binary mode COMMON_FORMAT messages go out as records at the handlers'
+// levels, runtime format strings stay text.
+void TestLog() {
+  common::Log log("binary");
+  Recorder recorder;
+  log.AddStreamHandler(&recorder, common::LOGLEVEL_WARN);
+  log.SetBinary(true);
+  log.Warn(1, COMMON_FORMAT("flow %% ml"), 12);
+  log.Warn(1, "flow %% ml", 12);
+  log.Info(COMMON_FORMAT("flow %% ml"), 12);
+  CHECK_EQ(recorder.records.size(), 1u);
+  CHECK(recorder.text == std::vector<std::string>({"flow 12 ml"}));
+  std::string payload = Unframe(recorder.records[0]);
+  CHECK_EQ(payload.size(), 8u + 1 + sizeof(int));
+  CHECK_EQ(Read<int>(payload, 9), 12);
+
+  log.SetBinary(false);
+  log.Warn(1, COMMON_FORMAT("flow %% ml"), 13);
+  CHECK_EQ(recorder.records.size(), 1u);
+  CHECK(recorder.text.back() == "flow 13 ml");
+}
+
+}  // namespace
+
+int main() {
+  TestLayout();
+  TestLog();
+  return test::Result();
+}
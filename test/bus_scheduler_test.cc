@@ -0,0 +1,148 @@
+#include <vector>
+
+#include "common/com/bus_scheduler.h"
+#include "test.h"
+
+namespace {
+
+namespace I2C = common::com::I2C;
+
+using Scheduler = I2C::BusScheduler<8, 4>;
+
+// Answers requests with its address and the request count, keeps writes.
+class Slave : public sim::I2cDevice {
+public:
+  explicit Slave(uint8_t address) : address_{address} {
+    sim::AttachI2c(address, this);
+  }
+
+  void OnReceive(const uint8_t *data, size_t size) override {
+    received.assign(reinterpret_cast<const char *>(data), size);
+  }
+
+  size_t OnRequest(uint8_t *data, size_t quantity) override {
+    uint8_t reply[4] = {address_, static_cast<uint8_t>(++requests), 0, 0};
+    size_t size = quantity < reply_size ? quantity : reply_size;
+    memcpy(data, reply, size);
+    return size;
+  }
+
+  std::string received{};
+  size_t reply_size{2};
+  int requests{0};
+
+private:
+  uint8_t address_;
+};
+
+std::vector<uint8_t> order;
+
+void OnDone(const I2C::BusTransaction &transaction) {
+  order.push_back(transaction.address);
+}
+
+// Priority first, then the earliest deadline, then queue order.
+void TestOrder() {
+  sim::Reset();
+  Slave a(0x20), b(0x21), c(0x22), d(0x23);
+  Scheduler scheduler;
+  scheduler.Begin();
+  order.clear();
+  CHECK(scheduler.Request(0x20, 2, &OnDone));
+  CHECK(scheduler.Request(0x21, 2, &OnDone, 0, 50));
+  CHECK(scheduler.Request(0x22, 2, &OnDone, 1));
+  CHECK(scheduler.Request(0x23, 2, &OnDone, 0, 20));
+  CHECK(scheduler.Request(0x20, 2, &OnDone));
+  CHECK_EQ(scheduler.Pending(), 5);
+  while (scheduler.Poll()) {}
+  CHECK(order == std::vector<uint8_t>({0x22, 0x23, 0x21, 0x20, 0x20}));
+  CHECK_EQ(a.requests, 2);
+  sim::DetachI2c();
+}
+
+int32_t value{0};
+
+void OnValue(const I2C::BusTransaction &transaction) {
+  CHECK(transaction.Get(value));
+}
+
+uint8_t status{0};
+
+void OnStatus(const I2C::BusTransaction &transaction) {
+  status = transaction.status;
+}
+
+// Writes carry the encoded message, replies decode, failures are reported
+// in the status and the stats.
+void TestTransactions() {
+  sim::Reset();
+  Slave a(0x20);
+  Scheduler scheduler;
+  scheduler.Begin();
+  CHECK(scheduler.Publish(0x20, int32_t{77}));
+  CHECK(scheduler.Publish(0x20, std::string("hello")));
+  CHECK(!scheduler.Publish(0x20, std::string(I2C::kBufferSize + 1, 'x')));
+  CHECK_EQ(scheduler.Pending(), 2);
+  CHECK_EQ(scheduler.Poll(), 1);
+  CHECK_EQ(a.received.size(), sizeof(int32_t));
+  CHECK_EQ(scheduler.Poll(), 1);
+  CHECK(a.received == "hello");
+
+  a.reply_size = 4;
+  CHECK(scheduler.Request(0x20, 4, &OnValue));
+  CHECK(!scheduler.Request(0x20, I2C::kBufferSize + 1, &OnValue));
+  scheduler.Poll();
+  CHECK_EQ(value, 0x20 | (1 << 8));
+
+  a.reply_size = 1;
+  scheduler.Request(0x20, 2, &OnStatus);
+  scheduler.Poll();
+  CHECK_EQ(status, I2C::kShortRead);
+  scheduler.Publish(0x30, int32_t{1}, 0, 0, &OnStatus);
+  scheduler.Poll();
+  CHECK_EQ(status, 2);
+
+  const I2C::SlaveStats *stats = scheduler.GetStats(0x20);
+  CHECK(stats != nullptr);
+  CHECK_EQ(stats->transactions, 4);
+  CHECK_EQ(stats->failures, 1);
+  CHECK(scheduler.GetStats(0x30) != nullptr);
+  CHECK(scheduler.GetStats(0x31) == nullptr);
+  sim::DetachI2c();
+}
+
+// The queue holds Capacity transactions, a transaction run after its
+// deadline is counted, and Poll() stops before overrunning its budget.
+void TestBudgetAndDeadlines() {
+  sim::Reset();
+  Slave a(0x20);
+  Scheduler scheduler;
+  scheduler.Begin();
+  for (int i{0}; i < 8; ++i) {
+    CHECK(scheduler.Request(0x20, 2, nullptr, 0, i < 4 ? 1 : 0));
+  }
+  CHECK(!scheduler.Request(0x20, 2, nullptr));
+  sim::Advance(1000);
+  uint32_t us = sim::I2cTransactionUs(2);
+  // One transaction per call at least, then as many as fit in the budget.
+  CHECK_EQ(scheduler.Poll(1), 1);
+  CHECK_EQ(scheduler.Poll(us + us / 2), 1);
+  CHECK_EQ(scheduler.Poll(2 * us), 2);
+  CHECK_EQ(scheduler.Poll(100000), 4);
+  const I2C::SlaveStats *stats = scheduler.GetStats(0x20);
+  CHECK_EQ(stats->transactions, 8);
+  // Due at 1 ms, the fourth one ends in the third millisecond.
+  CHECK_EQ(stats->missed_deadlines, 1);
+  CHECK_EQ(stats->max_latency_us, 1000 + 8 * us);
+  CHECK_EQ(stats->AverageLatencyUs(), 1000 + 9 * us / 2);
+  sim::DetachI2c();
+}
+
+}  // namespace
+
+int main() {
+  TestOrder();
+  TestTransactions();
+  TestBudgetAndDeadlines();
+  return test::Result();
+}
@@ -0,0 +1,217 @@
+#include "common/com/cobs.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "com_link.h"
+#include "common/event/defs.h"
+#include "test.h"
+
+namespace {
+
+using common::com::PacketDecoder;
+using common::com::StringSink;
+
+std::string Cobs(const std::string &data) {
+  std::string encoded;
+  StringSink sink(encoded);
+  common::com::CobsEncode(data.c_str(), data.size(), sink);
+  return encoded;
+}
+
+std::string Packet(const std::string &payload) {
+  std::string encoded;
+  StringSink sink(encoded);
+  common::com::EncodePacket(payload, sink);
+  return encoded;
+}
+
+// Feeds bytes, returns the payloads completed.
+std::vector<std::string> Feed(PacketDecoder &decoder,
+                              const std::string &bytes) {
+  std::vector<std::string> payloads;
+  for (char c : bytes) {
+    if (decoder.Push(static_cast<uint8_t>(c))) {
+      payloads.push_back(decoder.Payload());
+    }
+  }
+  return payloads;
+}
+
+// Payloads with zeros in every position a block boundary can fall on.
+std::string Payload(size_t size, uint32_t seed) {
+  std::string data(size, '\0');
+  for (size_t i{0}; i < size; ++i) {
+    seed = seed * 1103515245u + 12345u;
+    data[i] = (seed >> 16) % 5 ? static_cast<char>(seed >> 24) : '\0';
+  }
+  return data;
+}
+
+void TestCobsVectors() {
+  using namespace std::string_literals;
+  CHECK(Cobs(""s) == "\x01\x00"s);
+  CHECK(Cobs("\x00"s) == "\x01\x01\x00"s);
+  CHECK(Cobs("\x00\x00"s) == "\x01\x01\x01\x00"s);
+  CHECK(Cobs("\x11\x22\x00\x33"s) == "\x03\x11\x22\x02\x33\x00"s);
+  CHECK(Cobs("\x11\x22\x33\x44"s) == "\x05\x11\x22\x33\x44\x00"s);
+
+  // 254 non-zero bytes fill one block, the 255th starts another.
+  std::string block(254, '\0');
+  for (size_t i{0}; i < block.size(); ++i) {
+    block[i] = static_cast<char>(i + 1);
+  }
+  CHECK(Cobs(block) == "\xff"s + block + "\x00"s);
+  CHECK(Cobs(block + "\xff"s) == "\xff"s + block + "\x02\xff\x00"s);
+}
+
+void TestRoundTrip() {
+  PacketDecoder decoder(common::com::UART::kMaxPacketSize);
+  for (size_t size : {0, 1, 2, 253, 254, 255}) {
+    for (uint32_t seed : {1, 2, 3}) {
+      std::string payload = Payload(size, seed);
+      std::string packet = Packet(payload);
+      // Only the delimiter is zero.
+      CHECK(packet.find('\0') == packet.size() - 1);
+      std::vector<std::string> got = Feed(decoder, packet);
+      CHECK_EQ(got.size(), 1u);
+      CHECK(!got.empty() && got[0] == payload);
+    }
+  }
+}
+
+// The streaming sink frames like CobsEncode, however the payload is split.
+void TestStringSink() {
+  for (size_t size : {0, 1, 2, 253, 254, 255, 508, 509, 600}) {
+    for (uint32_t seed : {1, 2, 3}) {
+      std::string payload = Payload(size, seed);
+      if (seed == 3) {
+        // No zero at all, only full blocks.
+        for (char &c : payload) {
+          c |= 1;
+        }
+      }
+      for (size_t piece : {1, 7, 1000}) {
+        std::string framed;
+        common::com::CobsStringSink sink(framed);
+        for (size_t i{0}; i < size; i += piece) {
+          sink.Write(payload.c_str() + i, std::min(piece, size - i));
+        }
+        sink.Finish();
+        CHECK(framed == Cobs(payload));
+      }
+    }
+  }
+}
+
+void TestRejected() {
+  PacketDecoder decoder(16);
+  std::string packet = Packet("0123456789");
+  // A flipped bit fails the CRC.
+  std::string corrupted = packet;
+  corrupted[3] ^= 0x04;
+  CHECK(Feed(decoder, corrupted).empty());
+  // Larger than the decoder takes.
+  CHECK(Feed(decoder, Packet(std::string(20, 'x'))).empty());
+  // Too short to hold the CRC.
+  CHECK(Feed(decoder, std::string("\x02\x01\x00", 3)).empty());
+  // The decoder is back in sync for the next one.
+  CHECK_EQ(Feed(decoder, packet).size(), 1u);
+}
+
+// A lost byte costs the packet it was in (and the next one for the
+// delimiter), a reader joining mid-stream the packet it joined in: both lock
+// on at the next delimiter.
+void TestResync() {
+  std::vector<std::string> payloads;
+  std::string stream;
+  for (uint32_t i{0}; i < 10; ++i) {
+    payloads.push_back(Payload(30 + i, i));
+    stream += Packet(payloads.back());
+  }
+  // First byte and delimiter of payloads[3].
+  size_t start = 0;
+  for (int i{0}; i < 3; ++i) {
+    start = stream.find('\0', start) + 1;
+  }
+  size_t delimiter = stream.find('\0', start);
+
+  for (size_t lost = start; lost <= delimiter; ++lost) {
+    std::string damaged = stream;
+    damaged.erase(lost, 1);
+    PacketDecoder decoder(common::com::UART::kMaxPacketSize);
+    std::vector<std::string> got = Feed(decoder, damaged);
+    std::vector<std::string> expected = payloads;
+    expected.erase(expected.begin() + 3,
+                   expected.begin() + (lost == delimiter ? 5 : 4));
+    CHECK(got == expected);
+  }
+
+  for (size_t join = start + 1; join <= delimiter; ++join) {
+    PacketDecoder decoder(common::com::UART::kMaxPacketSize);
+    std::vector<std::string> got = Feed(decoder, stream.substr(join));
+    CHECK(got == std::vector<std::string>(payloads.begin() + 4,
+                                          payloads.end()));
+  }
+}
+
+// A packet that passes the CRC but does not decode is not a message.
+void TestUndecodable() {
+  test::Link link;
+  PacketDecoder decoder(common::com::UART::kMaxPacketSize);
+  common::SensorReading reading;
+  reading.time = common::Time::FromSec(7);
+  test::Uart::WritePacket(link.a, std::string("short"));
+  test::Uart::WritePacket(link.a, reading);
+  delay(10);
+  common::SensorReading got;
+  CHECK(!test::Uart::ReadPacket(link.b, decoder, got, false, 0));
+  CHECK(test::Uart::ReadPacket(link.b, decoder, got, false, 0));
+  CHECK_EQ(got.time.Sec(), 7u);
+}
+
+// WritePacket / ReadPacket over a line that loses bytes: every packet read
+// is one that was sent, in order.
+void TestLossyLine() {
+  sim::LineConfig config;
+  config.drop_rate = 1e-3;
+  config.bit_error_rate = 1e-4;
+  config.seed = 3;
+  test::Link link(config);
+  PacketDecoder decoder(common::com::UART::kMaxPacketSize);
+  std::vector<uint32_t> got;
+  sim::SetBackground([&] {
+    common::SensorReading reading;
+    while (test::Uart::ReadPacket(link.b, decoder, reading, false, 0)) {
+      got.push_back(reading.time.Sec());
+    }
+  });
+  common::SensorReading reading;
+  reading.sensor_id = common::Symbol::Static("dht-1");
+  reading.unit = common::Symbol::Static("C");
+  reading.reading.Emplace<double>(21.5);
+  for (uint32_t i{0}; i < 500; ++i) {
+    reading.time = common::Time::FromSec(i);
+    test::Uart::WritePacket(link.a, reading);
+  }
+  delay(10);
+  CHECK(got.size() >= 460 && got.size() < 500);
+  for (size_t i{1}; i < got.size(); ++i) {
+    CHECK(got[i] > got[i - 1]);
+  }
+  CHECK_EQ(link.b.Overruns(), 0u);
+}
+
+}  // namespace
+
+int main() {
+  TestCobsVectors();
+  TestRoundTrip();
+  TestStringSink();
+  TestRejected();
+  TestResync();
+  TestUndecodable();
+  TestLossyLine();
+  return test::Result();
+}
@@ -0,0 +1,180 @@
+#include "com_link.h"
+
+#include "common/event/defs.h"
+#include "test.h"
+
+namespace {
+
+using common::com::Transfer;
+using common::com::TransferStatus;
+
+// Polled writer on a, blocking reader on b over a lossy line. Lost bytes
+// are NACKed (stop-and-wait) or reported missing (CRC framing), corrupted
+// ones only caught with CRC framing. A Read() that returns true must hold
+// the bytes that were sent. Returns the transfers that made it.
+int Transfers(const sim::LineConfig &config, bool crc) {
+  test::Link link(config);
+  // Without framing a window hides a lost byte behind the next chunk, only
+  // stop-and-wait resends the chunk that fell short.
+  uint8_t window = crc ? 4 : 1;
+  link.a_link.crc = link.b_link.crc = crc;
+  link.a_link.window = link.b_link.window = window;
+  // As negotiated by an earlier transfer, the first one is unprotected.
+  link.a_link.peer_crc = crc;
+  link.a_link.peer_window = window;
+  Transfer<HardwareSerial> tx;
+  sim::SetBackground([&] { tx.Poll(); });
+  int ok{0};
+  for (int i{0}; i < 20; ++i) {
+    std::string data = test::Pattern(300 + i);
+    CHECK(tx.BeginWrite(link.a, data, 16, 2000, &link.a_link));
+    std::string got;
+    bool read = test::Uart::Read(link.b, got, true, false, 100, &link.b_link);
+    while (tx.Busy()) {
+      yield();
+    }
+    if (read) {
+      CHECK(got == data);
+      CHECK(tx.Status() == TransferStatus::DONE);
+      ++ok;
+    }
+    // Whatever a failed transfer left on the line.
+    delay(100);
+    test::Uart::Drain(link.a);
+    test::Uart::Drain(link.b);
+  }
+  return ok;
+}
+
+void TestLossyLine() {
+  sim::LineConfig config;
+  config.seed = 7;
+  CHECK_EQ(Transfers(config, false), 20);
+  CHECK_EQ(Transfers(config, true), 20);
+
+  config.drop_rate = 1e-3;
+  CHECK(Transfers(config, false) >= 19);
+  CHECK(Transfers(config, true) >= 19);
+
+  config.drop_rate = 0;
+  config.bit_error_rate = 1e-4;
+  CHECK(Transfers(config, true) >= 19);
+  config.bit_error_rate = 1e-3;
+  CHECK(Transfers(config, true) >= 18);
+}
+
+// A writer that goes away mid-transfer fails the read, typed messages are
+// not decoded from what arrived.
+void TestWriterGone() {
+  test::Link link;
+  Transfer<HardwareSerial> tx;
+  uint64_t cutoff = 20000;
+  sim::SetBackground([&] {
+    if (sim::Now() < cutoff) {
+      tx.Poll();
+    }
+  });
+  std::string data = test::Pattern(1000);
+  CHECK(tx.BeginWrite(link.a, data, 16, 1, &link.a_link));
+  std::string got;
+  CHECK(!test::Uart::Read(link.b, got, true, false, 50, &link.b_link));
+  CHECK(got.size() == data.size());
+
+  common::SensorReading reading;
+  reading.sensor_id = common::Symbol::Static("dht-1");
+  reading.reading.Emplace<double>(21.5);
+  std::string encoded;
+  reading.Encode(encoded);
+  // Timed out by now.
+  CHECK(tx.Poll() == TransferStatus::TIMEOUT);
+  cutoff = sim::Now() + 2000;
+  CHECK(tx.BeginWrite(link.a, encoded, 8, 0, &link.a_link));
+  common::SensorReading decoded;
+  CHECK(!test::Uart::Read(link.b, decoded, true, false, 50, &link.b_link));
+  CHECK(decoded.sensor_id.Empty());
+}
+
+// Polls both ends until for_us have passed, or until neither is busy when
+// for_us is 0.
+void PollBoth(Transfer<HardwareSerial> &tx, Transfer<HardwareSerial> &rx,
+              uint64_t for_us = 0) {
+  uint64_t end = sim::Now() + (for_us ? for_us : 10000000);
+  while (sim::Now() < end && (for_us || tx.Busy() || rx.Busy())) {
+    tx.Poll();
+    rx.Poll();
+    yield();
+  }
+}
+
+// The report saying every chunk arrived is lost: the sender repeats the
+// round, the receiver answers it again instead of having stopped reading.
+// A lost final ack only delays the receiver. Either way the next transfer
+// starts on a clean line.
+void TestLostFinal(bool drop_report) {
+  test::Link link;
+  link.a_link.crc = link.b_link.crc = link.a_link.peer_crc = true;
+  link.a_link.peer_window = link.a_link.window;
+  Transfer<HardwareSerial> tx;
+  Transfer<HardwareSerial> rx;
+  std::string data = test::Pattern(100);
+  CHECK(rx.BeginRead(link.b, 0, 16, 0, &link.b_link));
+  CHECK(tx.BeginWrite(link.a, data, 16, 0, &link.a_link));
+  // Metadata and 7 frames of 16 bytes at most, 5 bytes of framing each.
+  uint64_t frames = common::com::kStrMetadataSize + 7 * 5 + data.size();
+  while (link.a.Sent() < frames) {
+    tx.Poll();
+    rx.Poll();
+    yield();
+  }
+  if (drop_report) {
+    // Only the receiver runs while the report crosses the line.
+    uint64_t end = sim::Now() + 5000;
+    while (sim::Now() < end) {
+      rx.Poll();
+      yield();
+    }
+    test::Uart::Drain(link.a);
+    CHECK(rx.Busy());
+  } else {
+    // The sender reads the report and sends its ack, which is lost.
+    while (tx.Busy()) {
+      tx.Poll();
+      rx.Poll();
+      yield();
+    }
+    test::Uart::Drain(link.b);
+  }
+  PollBoth(tx, rx);
+  CHECK(tx.Status() == TransferStatus::DONE);
+  CHECK(rx.Status() == TransferStatus::DONE);
+  CHECK(rx.Data() == data);
+
+  std::string next = test::Pattern(50);
+  CHECK(rx.BeginRead(link.b, 0, 16, 0, &link.b_link));
+  CHECK(tx.BeginWrite(link.a, next, 16, 0, &link.a_link));
+  PollBoth(tx, rx);
+  CHECK(rx.Status() == TransferStatus::DONE);
+  CHECK(rx.Data() == next);
+}
+
+// Raw reads fail on a short message.
+void TestShortRaw() {
+  test::Link link;
+  link.b.Receive(std::string("\x01\x02", 2));
+  uint32_t value{0};
+  CHECK(!test::Com::Read(link.b, value, 20));
+  link.b.Receive(std::string("\x03\x04", 2));
+  CHECK(test::Com::Read(link.b, value, 20));
+  CHECK_EQ(value, 0x04030201u);
+}
+
+}  // namespace
+
+int main() {
+  TestLossyLine();
+  TestWriterGone();
+  TestLostFinal(true);
+  TestLostFinal(false);
+  TestShortRaw();
+  return test::Result();
+}
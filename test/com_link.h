@@ -0,0 +1,55 @@
+#pragma once
+
+// Two HardwareSerial ports on one simulated line, and the protected Com /
+// UART entry points the tests drive them with.
+
+#include "common/com/com.h"
+
+namespace test {
+
+class Com : public common::com::Com {
+public:
+  using common::com::Com::Read;
+  using common::com::Com::Write;
+};
+
+class Uart
+    : public common::com::UART::internal::UARTComBase<HardwareSerial> {
+public:
+  using UARTComBase::BeginRead;
+  using UARTComBase::BeginWrite;
+  using UARTComBase::Drain;
+  using UARTComBase::Read;
+  using UARTComBase::ReadPacket;
+  using UARTComBase::ReadTelemetry;
+  using UARTComBase::Write;
+  using UARTComBase::WritePacket;
+  using UARTComBase::WriteTelemetry;
+};
+
+struct Link {
+  explicit Link(const sim::LineConfig &config = sim::LineConfig()) {
+    sim::Reset();
+    sim::Connect(a, b, config);
+  }
+
+  ~Link() {
+    sim::Reset();
+  }
+
+  HardwareSerial a;
+  HardwareSerial b;
+  common::com::LinkState a_link{common::com::UART::kWindowSize};
+  common::com::LinkState b_link{common::com::UART::kWindowSize};
+};
+
+// Bytes 0..size with a period that does not divide any chunk size.
+inline std::string Pattern(size_t size) {
+  std::string data(size, '\0');
+  for (size_t i{0}; i < size; ++i) {
+    data[i] = static_cast<char>(i * 7 % 251);
+  }
+  return data;
+}
+
+}  // namespace test
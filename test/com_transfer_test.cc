@@ -0,0 +1,196 @@
+#include "com_link.h"
+#include "common/event/defs.h"
+
+#include "test.h"
+
+namespace {
+
+using common::com::Transfer;
+using common::com::TransferStatus;
+
+enum class Mode { kStopAndWait, kWindowed, kCrc };
+
+void Configure(test::Link &link, Mode mode) {
+  uint8_t window = mode == Mode::kWindowed ? 4 : 1;
+  link.a_link.window = link.b_link.window = window;
+  link.a_link.crc = link.b_link.crc = mode == Mode::kCrc;
+}
+
+// Blocking writer on a, polled reader on b. The first transfers negotiate
+// the window / CRC framing / chunk size, the later ones use them.
+void TestBlockingWrite(Mode mode, uint16_t chunk_size) {
+  test::Link link;
+  Configure(link, mode);
+  Transfer<HardwareSerial> rx;
+  sim::SetBackground([&] { rx.Poll(); });
+  for (size_t size : {100, 1000, 1, 0, 333}) {
+    std::string data = test::Pattern(size);
+    CHECK(rx.BeginRead(link.b, 0, chunk_size, 0, &link.b_link));
+    test::Com::Write(link.a, data, chunk_size, &link.a_link);
+    // The final ack of a CRC framed write may still be arriving.
+    while (rx.Poll() == TransferStatus::IN_PROGRESS) {
+      yield();
+    }
+    CHECK(rx.Status() == TransferStatus::DONE);
+    CHECK(rx.Data() == data);
+  }
+  CHECK_EQ(link.a_link.peer_crc, mode == Mode::kCrc);
+}
+
+// Polled writer on a, blocking reader on b.
+void TestBlockingRead(Mode mode, uint16_t chunk_size) {
+  test::Link link;
+  Configure(link, mode);
+  Transfer<HardwareSerial> tx;
+  sim::SetBackground([&] { tx.Poll(); });
+  for (size_t size : {100, 1000, 1, 333}) {
+    std::string data = test::Pattern(size);
+    CHECK(tx.BeginWrite(link.a, data, chunk_size, 0, &link.a_link));
+    std::string got;
+    CHECK(test::Uart::Read(link.b, got, true, false, 1000, &link.b_link));
+    CHECK(got == data);
+    while (tx.Busy()) {
+      yield();
+    }
+    CHECK(tx.Status() == TransferStatus::DONE);
+  }
+}
+
+void TestRaw() {
+  test::Link link;
+  Transfer<HardwareSerial> rx;
+  sim::SetBackground([&] { rx.Poll(); });
+  CHECK(rx.BeginRead(link.b, sizeof(uint32_t), 0, 0));
+  test::Com::Write(link.a, uint32_t{0xDEADBEEF});
+  // Write() returns once the last byte left, the reader gets it right after.
+  while (rx.Poll() == TransferStatus::IN_PROGRESS) {
+    yield();
+  }
+  uint32_t value{0};
+  CHECK(rx.Get(value));
+  CHECK_EQ(value, 0xDEADBEEFu);
+
+  // Fewer bytes than the type, or a message that does not decode.
+  CHECK(rx.BeginRead(link.b, sizeof(uint16_t), 0, 0));
+  test::Com::Write(link.a, uint16_t{0xBEEF});
+  while (rx.Poll() == TransferStatus::IN_PROGRESS) {
+    yield();
+  }
+  CHECK(!rx.Get(value));
+  common::Event event;
+  CHECK(!rx.Get(event));
+
+  sim::SetBackground(nullptr);
+  test::Com::Write(link.b, int16_t{-1234});
+  int16_t got{0};
+  CHECK(test::Uart::Read(link.a, got, true, false, 100, nullptr));
+  CHECK_EQ(got, -1234);
+}
+
+// The point of Poll(): loop() keeps running while a message is on the
+// wire, a blocking Write() holds it for the whole transfer.
+void TestLoopKeepsRunning() {
+  std::string data = test::Pattern(1024);
+  uint64_t blocking_gap;
+  {
+    test::Link link;
+    Transfer<HardwareSerial> rx;
+    sim::SetBackground([&] { rx.Poll(); });
+    rx.BeginRead(link.b, 0, 32, 0, &link.b_link);
+    uint64_t start = sim::Now();
+    test::Com::Write(link.a, data, 32, &link.a_link);
+    blocking_gap = sim::Now() - start;
+    CHECK(rx.Data() == data);
+  }
+
+  test::Link link;
+  Transfer<HardwareSerial> rx;
+  sim::SetBackground([&] { rx.Poll(); });
+  Transfer<HardwareSerial> tx;
+  rx.BeginRead(link.b, 0, 32, 0, &link.b_link);
+  tx.BeginWrite(link.a, data, 32, 0, &link.a_link);
+  uint64_t last = sim::Now(), max_gap{0};
+  uint32_t iterations{0};
+  while (tx.Poll() == TransferStatus::IN_PROGRESS) {
+    // Whatever else loop() does.
+    ++iterations;
+    uint64_t now = sim::Now();
+    max_gap = std::max(max_gap, now - last);
+    last = now;
+    yield();
+  }
+  CHECK(tx.Status() == TransferStatus::DONE);
+  CHECK(rx.Data() == data);
+  printf("longest loop() gap: blocking %llu us, polled %llu us "
+         "(%u iterations)\n", static_cast<unsigned long long>(blocking_gap),
+         static_cast<unsigned long long>(max_gap), iterations);
+  CHECK(blocking_gap > 80000);
+  CHECK(max_gap < 100);
+  CHECK(iterations > 1000);
+}
+
+// Poll() returns at once while the TX buffer is full instead of waiting in
+// write() for a free slot. SoftwareSerial, which reports no room at all,
+// still gets a byte per call.
+void TestFullTxBuffer() {
+  test::Link link;
+  std::string fill(link.a.availableForWrite(), 'x');
+  link.a.write(fill.data(), fill.size());
+  CHECK_EQ(link.a.availableForWrite(), 0);
+  Transfer<HardwareSerial> tx;
+  std::string data = test::Pattern(100);
+  CHECK(tx.BeginWrite(link.a, data, 0, 0));
+  uint64_t start = sim::Now();
+  CHECK(tx.Poll() == TransferStatus::IN_PROGRESS);
+  CHECK_EQ(sim::Now(), start);
+  while (tx.Poll() == TransferStatus::IN_PROGRESS) {
+    yield();
+  }
+  CHECK(tx.Status() == TransferStatus::DONE);
+
+  SoftwareSerial soft(2, 3);
+  HardwareSerial peer;
+  sim::Connect(soft, peer);
+  Transfer<SoftwareSerial> soft_tx;
+  // Within the peer's RX ring, nobody reads it meanwhile.
+  data.resize(40);
+  CHECK(soft_tx.BeginWrite(soft, data, 0, 0));
+  while (soft_tx.Poll() == TransferStatus::IN_PROGRESS) {
+  }
+  delay(10);
+  std::string got(peer.available(), '\0');
+  peer.readBytes(&got[0], got.size());
+  CHECK(got == data);
+}
+
+void TestTimeout() {
+  test::Link link;
+  Transfer<HardwareSerial> rx;
+  CHECK(rx.BeginRead(link.b, 0, 32, 50, &link.b_link));
+  while (rx.Poll() == TransferStatus::IN_PROGRESS) {
+    yield();
+  }
+  CHECK(rx.Status() == TransferStatus::TIMEOUT);
+  CHECK(millis() >= 50 && millis() < 60);
+
+  std::string got;
+  uint32_t start = millis();
+  CHECK(!test::Uart::Read(link.b, got, true, false, 20, &link.b_link));
+  CHECK(millis() - start == 20);
+}
+
+}  // namespace
+
+int main() {
+  for (Mode mode : {Mode::kStopAndWait, Mode::kWindowed, Mode::kCrc}) {
+    for (uint16_t chunk_size : {8, 32}) {
+      TestBlockingWrite(mode, chunk_size);
+      TestBlockingRead(mode, chunk_size);
+    }
+  }
+  TestRaw();
+  TestLoopKeepsRunning();
+  TestFullTxBuffer();
+  TestTimeout();
+  return test::Result();
+}
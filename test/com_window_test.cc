@@ -0,0 +1,223 @@
+#include "com_link.h"
+
+#include "test.h"
+
+namespace {
+
+using common::com::LinkState;
+using common::com::Transfer;
+using common::com::TransferStatus;
+
+// Blocking windowed writer against a polled reader, one transfer to learn
+// the peer's window and two using it.
+void TestRoundTrip(uint16_t chunk_size, size_t size) {
+  test::Link link;
+  Transfer<HardwareSerial> rx;
+  sim::SetBackground([&] { rx.Poll(); });
+  std::string data = test::Pattern(size);
+  for (int i{0}; i < 3; ++i) {
+    CHECK(rx.BeginRead(link.b, 0, chunk_size, 0, &link.b_link));
+    test::Com::Write(link.a, data, chunk_size, &link.a_link);
+    CHECK(rx.Status() == TransferStatus::DONE);
+    CHECK(rx.Data() == data);
+  }
+  CHECK_EQ(link.a_link.peer_window, common::com::UART::kWindowSize);
+  CHECK_EQ(link.b.Overruns(), 0u);
+}
+
+void TestWindowForRoom() {
+  using common::com::WindowForRoom;
+  CHECK_EQ(WindowForRoom(4, 32, 63), 1);
+  CHECK_EQ(WindowForRoom(4, 16, 63), 3);
+  CHECK_EQ(WindowForRoom(4, 8, 63), 4);
+  CHECK_EQ(WindowForRoom(8, 8 + 5, 63), 4);
+  CHECK_EQ(WindowForRoom(4, 32, 10), 0);
+
+  // The default UART settings pipeline, with or without CRC framing.
+  using common::com::NegotiatedWindow;
+  using common::com::kRxRingSize;
+  using common::com::UART::kChunkSize;
+  using common::com::UART::kWindowSize;
+  CHECK_EQ(NegotiatedWindow(WindowForRoom(kWindowSize, kChunkSize,
+                                          kRxRingSize), kWindowSize), 3);
+  CHECK_EQ(NegotiatedWindow(WindowForRoom(kWindowSize, kChunkSize + 5,
+                                          kRxRingSize), kWindowSize), 3);
+
+  LinkState link;
+  CHECK_EQ(common::com::PeerRxRoom(link), common::com::kRxRingSize);
+  link.peer_rx_room = 20;
+  CHECK_EQ(common::com::PeerRxRoom(link), 20);
+}
+
+// Link time of the third 2 KB transfer at the default chunk size, with
+// 2 ms of latency each way.
+uint64_t DefaultTransferUs(uint8_t window) {
+  sim::LineConfig config;
+  config.latency_us = 2000;
+  test::Link link(config);
+  link.a_link.window = link.b_link.window = window;
+  Transfer<HardwareSerial> rx;
+  sim::SetBackground([&] { rx.Poll(); });
+  std::string data = test::Pattern(2048);
+  uint64_t elapsed{0};
+  for (int i{0}; i < 3; ++i) {
+    link.a_link.chunk_size = common::com::UART::kChunkSize;
+    uint64_t start = sim::Now();
+    CHECK(rx.BeginRead(link.b, 0, common::com::UART::kChunkSize, 0,
+                       &link.b_link));
+    test::Com::Write(link.a, data, common::com::UART::kChunkSize,
+                     &link.a_link);
+    CHECK(rx.Data() == data);
+    elapsed = sim::Now() - start;
+  }
+  return elapsed;
+}
+
+// The default settings keep several chunks in flight, well ahead of
+// stop-and-wait on a line with latency.
+void TestDefaultPipelines() {
+  CHECK(DefaultTransferUs(common::com::UART::kWindowSize) * 2 <
+        DefaultTransferUs(1));
+}
+
+// A reader whose loop() only comes back every 5 ms (about 57 bytes at
+// 115200 baud) must not lose bytes to a full window.
+void TestSlowReader(uint16_t chunk_size) {
+  test::Link link;
+  Transfer<HardwareSerial> tx;
+  Transfer<HardwareSerial> rx;
+  sim::SetBackground([&] { tx.Poll(); });
+  std::string data = test::Pattern(1000);
+  for (int i{0}; i < 3; ++i) {
+    CHECK(tx.BeginWrite(link.a, data, chunk_size, 0, &link.a_link));
+    CHECK(rx.BeginRead(link.b, 0, chunk_size, 1000, &link.b_link));
+    while (rx.Poll() == TransferStatus::IN_PROGRESS) {
+      delay(5);
+    }
+    CHECK(rx.Status() == TransferStatus::DONE);
+    CHECK(rx.Data() == data);
+    // The writer still has to see the last acknowledgement.
+    while (tx.Busy()) {
+      yield();
+    }
+    CHECK(tx.Status() == TransferStatus::DONE);
+  }
+  CHECK_EQ(link.b.Overruns(), 0u);
+}
+
+// Chunks never outgrow the 63 bytes the RX ring holds.
+void TestChunkSizeLimit() {
+  using common::com::ChunkSizeFor;
+  using common::com::kRxRingSize;
+  test::Link link;
+  CHECK_EQ(common::com::FreeRxRoom(link.b), kRxRingSize);
+  link.b.Receive(std::string(10, 'x'));
+  CHECK_EQ(common::com::FreeRxRoom(link.b), kRxRingSize - 10);
+
+  LinkState state;
+  state.peer_rx_room = 64;
+  CHECK_EQ(ChunkSizeFor(state, 255, false), kRxRingSize);
+  CHECK_EQ(ChunkSizeFor(state, 255, true), kRxRingSize - 5);
+  state.peer_rx_room = 20;
+  CHECK_EQ(ChunkSizeFor(state, 255, false), 20);
+  // Too small a report for a chunk, the ring is the limit.
+  state.peer_rx_room = 4;
+  CHECK_EQ(ChunkSizeFor(state, 255, false), kRxRingSize);
+  for (int i{0}; i < 40; ++i) {
+    common::com::AdaptChunkSize(state, state.chunk_size ? state.chunk_size :
+                                                          8, 10, 0, false);
+  }
+  CHECK_EQ(state.chunk_size, kRxRingSize);
+
+  // On a windowed link the ring is split across the window, a full window
+  // of grown chunks still fits.
+  for (uint8_t window{2}; window <= common::com::kMaxWindowSize; ++window) {
+    for (bool crc : {false, true}) {
+      LinkState windowed{window};
+      windowed.peer_window = window;
+      for (int i{0}; i < 40; ++i) {
+        common::com::AdaptChunkSize(
+            windowed, windowed.chunk_size ? windowed.chunk_size : 8, 10, 0,
+            crc);
+      }
+      uint16_t frame = windowed.chunk_size + (crc ? 5 : 0);
+      CHECK(windowed.chunk_size >= common::com::kMinChunkSize);
+      CHECK(common::com::NegotiatedWindow(
+                common::com::WindowForRoom(window, frame, kRxRingSize),
+                window) > 1);
+    }
+  }
+}
+
+// Transfers without retries grow the chunk size up to the ring's share of
+// one chunk of the window, the window stays in use. The reader only comes
+// back every 10 ms, a window that does not fit in the ring would lose its
+// last bytes every time.
+void TestConvergence(bool crc) {
+  test::Link link;
+  link.a_link.crc = link.b_link.crc = crc;
+  Transfer<HardwareSerial> tx;
+  Transfer<HardwareSerial> rx;
+  sim::SetBackground([&] { tx.Poll(); });
+  std::string data = test::Pattern(500);
+  for (int i{0}; i < 40; ++i) {
+    CHECK(tx.BeginWrite(link.a, data, 8, 0, &link.a_link));
+    CHECK(rx.BeginRead(link.b, 0, 8, 1000, &link.b_link));
+    while (rx.Poll() == TransferStatus::IN_PROGRESS) {
+      delay(10);
+    }
+    CHECK(rx.Status() == TransferStatus::DONE);
+    CHECK(rx.Data() == data);
+    while (tx.Busy()) {
+      yield();
+    }
+    CHECK(tx.Status() == TransferStatus::DONE);
+  }
+  uint8_t overhead = crc ? 5 : 0;
+  CHECK_EQ(link.a_link.chunk_size,
+           common::com::kRxRingSize / common::com::UART::kWindowSize -
+               overhead);
+  CHECK_EQ(common::com::NegotiatedWindow(
+               common::com::WindowForRoom(
+                   link.a_link.window, link.a_link.chunk_size + overhead,
+                   common::com::PeerRxRoom(link.a_link)),
+               link.a_link.peer_window),
+           common::com::UART::kWindowSize);
+  CHECK_EQ(link.b.Overruns(), 0u);
+}
+
+// A chunk larger than the RX ring is refused by the reader, and the writer
+// gives up on it instead of waiting for acknowledgements.
+void TestRefused() {
+  test::Link link;
+  Transfer<HardwareSerial> rx;
+  sim::SetBackground([&] { rx.Poll(); });
+  CHECK(rx.BeginRead(link.b, 0, 8, 0, &link.b_link));
+  std::string data = test::Pattern(200);
+  Transfer<HardwareSerial> tx;
+  CHECK(tx.BeginWrite(link.a, data, common::com::kRxBufferSize, 0));
+  while (tx.Poll() == TransferStatus::IN_PROGRESS) {
+    yield();
+  }
+  CHECK(tx.Status() == TransferStatus::TIMEOUT);
+  CHECK(rx.Status() == TransferStatus::TIMEOUT);
+}
+
+}  // namespace
+
+int main() {
+  TestRoundTrip(32, 1000);
+  TestRoundTrip(8, 1000);
+  TestRoundTrip(16, 1);
+  TestRoundTrip(32, 40000);
+  TestRoundTrip(common::com::UART::kChunkSize, 1000);
+  TestWindowForRoom();
+  TestDefaultPipelines();
+  TestSlowReader(32);
+  TestSlowReader(8);
+  TestChunkSizeLimit();
+  TestConvergence(false);
+  TestConvergence(true);
+  TestRefused();
+  return test::Result();
+}
@@ -0,0 +1,132 @@
+#include "common/event/defs.h"
+
+#include <string>
+
+#include "test.h"
+
+namespace {
+
+using common::com::BufferSink;
+using common::com::ByteSpan;
+using common::com::StreamSink;
+
+common::SensorReading MakeReading() {
+  common::SensorReading reading;
+  reading.time = common::Time::FromSec(1700000123);
+  reading.sensor_id = common::Symbol::Static("dht-1");
+  reading.sensor_type = common::Symbol::Static("dht22");
+  reading.data_type = common::Symbol::Static("temperature");
+  reading.reading.Emplace<double>(21.5);
+  reading.unit = common::Symbol::Static("C");
+  return reading;
+}
+
+void CheckReading(const common::SensorReading &reading) {
+  CHECK_EQ(reading.time.Sec(), 1700000123u);
+  CHECK(reading.sensor_id == "dht-1");
+  CHECK(reading.sensor_type == "dht22");
+  CHECK(reading.data_type == "temperature");
+  CHECK(reading.reading.HoldsAlternative<double>());
+  CHECK(reading.reading.GetIf<double>() &&
+        *reading.reading.GetIf<double>() == 21.5);
+  CHECK(reading.unit == "C");
+}
+
+// The string, buffer and stream paths put the same bytes on the wire.
+void TestReadingRoundTrip() {
+  common::SensorReading reading = MakeReading();
+  std::string msg;
+  reading.Encode(msg);
+  common::SensorReading decoded;
+  decoded.Decode(msg);
+  CheckReading(decoded);
+
+  char buffer[64];
+  BufferSink sink(buffer, sizeof(buffer));
+  test::ResetAllocs();
+  common::com::Encode(reading, sink);
+  CHECK_EQ(test::Allocs(), 0u);
+  CHECK(!sink.Overflow());
+  CHECK(std::string(buffer, sink.Size()) == msg);
+
+  ByteSpan span(buffer, sink.Size());
+  common::SensorReading from_span;
+  test::ResetAllocs();
+  CHECK(common::com::Decode(span, from_span));
+  CHECK_EQ(test::Allocs(), 0u);
+  CHECK_EQ(span.Remaining(), 0u);
+  CheckReading(from_span);
+
+  Serial.Capture(true);
+  StreamSink<HardwareSerial> stream(Serial);
+  common::com::Encode(reading, stream);
+  CHECK(Serial.TakeCaptured() == msg);
+  Serial.Capture(false);
+}
+
+void TestIntReading() {
+  common::SensorReading reading = MakeReading();
+  reading.reading.Emplace<int>(-42);
+  std::string msg;
+  reading.Encode(msg);
+  common::SensorReading decoded;
+  decoded.Decode(msg);
+  CHECK(decoded.reading.GetIf<int>() && *decoded.reading.GetIf<int>() == -42);
+}
+
+void TestEventRoundTrip() {
+  common::Event event;
+  event.time = common::Time::FromSec(1700000456);
+  event.level = common::LOGLEVEL_WARN;
+  event.error_code = 7;
+  event.source_name = common::Symbol::Static("pump");
+  event.event_msg = "dry run";
+  std::string msg;
+  event.Encode(msg);
+
+  common::Event decoded;
+  decoded.Decode(msg);
+  CHECK_EQ(decoded.time.Sec(), 1700000456u);
+  CHECK(decoded.level == common::LOGLEVEL_WARN);
+  CHECK_EQ(decoded.error_code, 7);
+  CHECK(decoded.source_name == "pump");
+  CHECK(decoded.event_msg == "dry run");
+}
+
+// A short buffer keeps what fits and reports the overflow.
+void TestBufferOverflow() {
+  common::SensorReading reading = MakeReading();
+  std::string msg;
+  reading.Encode(msg);
+  char buffer[64];
+  BufferSink sink(buffer, 10);
+  common::com::Encode(reading, sink);
+  CHECK(sink.Overflow());
+  CHECK_EQ(sink.Size(), 10u);
+  CHECK(std::string(buffer, 10) == msg.substr(0, 10));
+}
+
+// Every truncation of a valid message fails to decode instead of reading
+// past the end.
+void TestShortSpan() {
+  common::SensorReading reading = MakeReading();
+  std::string msg;
+  reading.Encode(msg);
+  for (size_t size{0}; size < msg.size(); ++size) {
+    ByteSpan span(msg.data(), size);
+    common::SensorReading decoded;
+    CHECK(!common::com::Decode(span, decoded));
+    CHECK(!span.Ok());
+  }
+}
+
+}  // namespace
+
+int main() {
+  TestReadingRoundTrip();
+  TestIntReading();
+  TestEventRoundTrip();
+  TestBufferOverflow();
+  TestShortSpan();
+  return test::Result();
+}
@@ -0,0 +1,88 @@
+#include "common/utility/format.h"
+
+#include <cmath>
+#include <limits>
+#include <string>
+
+#include "common/log.h"
+#include "test.h"
+
+namespace {
+
+using common::Format;
+
+constexpr auto kNone = COMMON_FORMAT("none");
+constexpr auto kTwo = COMMON_FORMAT("%%%%");
+constexpr auto kOdd = COMMON_FORMAT("%%%");
+constexpr auto kSpaced = COMMON_FORMAT("a %% b %%");
+static_assert(kNone.kArgs == 0);
+static_assert(kTwo.kArgs == 2);
+static_assert(kOdd.kArgs == 1);
+static_assert(kSpaced.kOffsets.value[1] == 7);
+
+// Placeholders anywhere, '%' alone stays, arguments are not scanned again.
+void TestPlaceholders() {
+  CHECK(Format(COMMON_FORMAT("no args")) == "no args");
+  CHECK(Format(COMMON_FORMAT("%%"), 1) == "1");
+  CHECK(Format(COMMON_FORMAT("%%%%"), 1, 2) == "12");
+  CHECK(Format(COMMON_FORMAT("%%% done"), 50) == "50% done");
+  CHECK(Format(COMMON_FORMAT("a %% b %% c"), "x", "y") == "a x b y c");
+  CHECK(Format(COMMON_FORMAT("%% then %%"), "%%", 2) == "%% then 2");
+  CHECK(Format(COMMON_FORMAT("[%%]"), "") == "[]");
+}
+
+// Integers print as std::to_string does, at every width.
+void TestIntegers() {
+  CHECK(Format(COMMON_FORMAT("%% %%"), int8_t{-128}, uint8_t{255}) ==
+        "-128 255");
+  CHECK(Format(COMMON_FORMAT("%%"), std::numeric_limits<int16_t>::min()) ==
+        "-32768");
+  CHECK(Format(COMMON_FORMAT("%%"), std::numeric_limits<int32_t>::min()) ==
+        std::to_string(std::numeric_limits<int32_t>::min()));
+  CHECK(Format(COMMON_FORMAT("%%"), std::numeric_limits<uint32_t>::max()) ==
+        "4294967295");
+  CHECK(Format(COMMON_FORMAT("%%"), std::numeric_limits<int64_t>::min()) ==
+        "-9223372036854775808");
+  CHECK(Format(COMMON_FORMAT("%%"), std::numeric_limits<uint64_t>::max()) ==
+        "18446744073709551615");
+  CHECK(Format(COMMON_FORMAT("%% %%"), 0, true) == "0 1");
+  // Same text as the runtime Format for the arguments it handles.
+  CHECK(Format(COMMON_FORMAT("%% of %% at %%"), 3, 10l, -7ll) ==
+        common::detail::Format("%% of %% at %%", 3, 10l, -7ll));
+}
+
+// Floating points with 4 rounded decimals, out of range values as words.
+void TestFloats() {
+  CHECK(Format(COMMON_FORMAT("%%"), 21.5) == "21.5000");
+  CHECK(Format(COMMON_FORMAT("%%"), 21.5f) == "21.5000");
+  CHECK(Format(COMMON_FORMAT("%%"), -1.25) == "-1.2500");
+  CHECK(Format(COMMON_FORMAT("%%"), 0.99996) == "1.0000");
+  CHECK(Format(COMMON_FORMAT("%%"), 0.00004) == "0.0000");
+  CHECK(Format(COMMON_FORMAT("%%"), 4294967040.0) == "4294967040.0000");
+  CHECK(Format(COMMON_FORMAT("%% %% %% %%"), std::nan(""), INFINITY, 5e9,
+               -5e9) == "nan inf ovf ovf");
+}
+
+// Text arguments are referenced, the result is sized once.
+void TestText() {
+  std::string name("pump-1");
+  common::Symbol unit = common::Symbol::Static("kPa");
+  test::ResetAllocs();
+  std::string msg = Format(
+      COMMON_FORMAT("sensor %% reads %% %% after %% retries, %%"), name,
+      101.325, unit, 3u, "a message long enough to leave the inline buffer");
+  CHECK_EQ(test::Allocs(), 1u);
+  CHECK(msg == "sensor pump-1 reads 101.3250 kPa after 3 retries, a message "
+               "long enough to leave the inline buffer");
+  CHECK(Format(COMMON_FORMAT("[%%]"), common::Symbol()) == "[]");
+}
+
+}  // namespace
+
+int main() {
+  TestPlaceholders();
+  TestIntegers();
+  TestFloats();
+  TestText();
+  return test::Result();
+}
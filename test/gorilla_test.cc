@@ -0,0 +1,184 @@
+#include "common/com/gorilla.h"
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/event/sensor_reading_series.h"
+#include "test.h"
+
+namespace {
+
+using common::com::ByteSpan;
+using common::com::GorillaDecoder;
+using common::com::GorillaEncoder;
+using common::com::StringSink;
+
+struct Sample {
+  uint32_t sec;
+  double value;
+};
+
+std::string Compress(const std::vector<Sample> &samples) {
+  std::string bytes;
+  StringSink sink(bytes);
+  GorillaEncoder encoder;
+  for (const Sample &sample : samples) {
+    encoder.Append(sample.sec, sample.value, sink);
+  }
+  encoder.Finish(sink);
+  CHECK_EQ(encoder.Count(), samples.size());
+  return bytes;
+}
+
+// Values come back bit for bit, NaN payloads and signed zeros included.
+void CheckRoundTrip(const std::vector<Sample> &samples) {
+  std::string bytes = Compress(samples);
+  ByteSpan span(bytes);
+  GorillaDecoder decoder(span);
+  for (const Sample &sample : samples) {
+    uint32_t sec{0};
+    double value{0};
+    CHECK(decoder.Next(sec, value));
+    CHECK_EQ(sec, sample.sec);
+    CHECK(!memcmp(&value, &sample.value, sizeof(value)));
+  }
+  CHECK_EQ(span.Remaining(), 0u);
+}
+
+void TestRoundTrip() {
+  CheckRoundTrip({{1700000000, 21.5}});
+
+  // Every timestamp bucket, backwards and wrapping steps, special values.
+  std::vector<Sample> edges;
+  uint32_t sec = 1700000000;
+  for (int32_t step : {10, 10, 11, 74, 10, 300, -200, 4000, 100000, -5,
+                       0x7FFFFFFF, 1, 0, 0}) {
+    sec += step;
+    edges.push_back({sec, 0});
+  }
+  const double kValues[] = {21.5,
+                            21.5,
+                            21.6,
+                            -0.0,
+                            0.0,
+                            std::numeric_limits<double>::infinity(),
+                            std::nan("1"),
+                            std::numeric_limits<double>::denorm_min(),
+                            -std::numeric_limits<double>::max(),
+                            1.0,
+                            -1.0,
+                            1e-300,
+                            21.5,
+                            21.5};
+  for (size_t i{0}; i < edges.size(); ++i) {
+    edges[i].value = kValues[i];
+  }
+  CheckRoundTrip(edges);
+
+  std::mt19937 random(7);
+  std::vector<Sample> noise;
+  std::vector<Sample> walk;
+  double value{20};
+  for (uint32_t i{0}; i < 5000; ++i) {
+    uint64_t bits = (static_cast<uint64_t>(random()) << 32) | random();
+    double raw;
+    memcpy(&raw, &bits, sizeof(raw));
+    noise.push_back({static_cast<uint32_t>(random()), raw});
+    value += (static_cast<int>(random() % 3) - 1) * 0.1;
+    walk.push_back({static_cast<uint32_t>(1700000000 + i * 2 + random() % 2),
+                    value});
+  }
+  CheckRoundTrip(noise);
+  CheckRoundTrip(walk);
+}
+
+// A constant reading at a fixed period costs two bits per sample.
+void TestSize() {
+  std::vector<Sample> samples;
+  for (uint32_t i{0}; i < 1001; ++i) {
+    samples.push_back({1700000000 + i * 60, 21.5});
+  }
+  CHECK_EQ(Compress(samples).size(), (32 + 64 + 1 + 7 + 1 + 999 * 2 + 7) / 8);
+}
+
+// Cuts fail instead of reading past the end.
+void TestTruncated() {
+  std::vector<Sample> samples;
+  for (uint32_t i{0}; i < 20; ++i) {
+    samples.push_back({1700000000 + i * i, 20 + i * 0.3});
+  }
+  std::string bytes = Compress(samples);
+  for (size_t cut{0}; cut + 1 < bytes.size(); ++cut) {
+    ByteSpan span(bytes.data(), cut);
+    GorillaDecoder decoder(span);
+    uint32_t sec;
+    double value;
+    size_t read{0};
+    while (decoder.Next(sec, value)) {
+      ++read;
+    }
+    CHECK(read < samples.size());
+  }
+}
+
+// A series keeps growing after Encode(), and decodes to the same samples
+// with the symbols it started with.
+void TestSeries() {
+  common::SensorReading reading;
+  reading.sensor_id = common::Symbol::Static("dht-1");
+  reading.sensor_type = common::Symbol::Static("dht22");
+  reading.data_type = common::Symbol::Static("humidity");
+  reading.unit = common::Symbol::Static("%");
+
+  common::SensorReadingSeries series;
+  CHECK(series.Matches(reading));
+  std::string bytes;
+  for (int i{0}; i < 10; ++i) {
+    reading.time = common::Time::FromSec(1700000000 + i * 2);
+    reading.reading.Emplace<int>(40 + i % 3);
+    series.Add(reading);
+    if (i == 4) {
+      StringSink sink(bytes);
+      series.Encode(sink);
+    }
+  }
+  common::SensorReading other = reading;
+  other.sensor_id = common::Symbol::Static("dht-2");
+  CHECK(!series.Matches(other));
+
+  bytes.clear();
+  StringSink sink(bytes);
+  series.Encode(sink);
+  common::SensorReadingSeries decoded;
+  ByteSpan span(bytes);
+  decoded.Decode(span);
+  CHECK(span.Ok());
+  CHECK_EQ(span.Remaining(), 0u);
+  CHECK_EQ(decoded.Size(), 10u);
+  CHECK(decoded.Metadata().unit == "%");
+  int i{0};
+  CHECK(decoded.ForEach([&i](uint32_t sec, double value) {
+    CHECK_EQ(sec, 1700000000u + i * 2);
+    CHECK(value == 40 + i % 3);
+    ++i;
+  }));
+  CHECK_EQ(i, 10);
+
+  ByteSpan cut(bytes.data(), bytes.size() - 1);
+  decoded.Decode(cut);
+  CHECK(!cut.Ok());
+  CHECK(decoded.Empty());
+}
+
+}  // namespace
+
+int main() {
+  TestRoundTrip();
+  TestSize();
+  TestTruncated();
+  TestSeries();
+  return test::Result();
+}
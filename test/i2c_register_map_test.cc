@@ -0,0 +1,80 @@
+#include "com_link.h"
+#include "test.h"
+
+namespace {
+
+namespace I2C = common::com::I2C;
+
+constexpr uint8_t kAddress = 0x12;
+
+using Temperature = I2C::Register<float, 0>;
+using Humidity = I2C::Register<float, 4>;
+using Status = I2C::Register<uint8_t, 8>;
+using Uptime = I2C::Register<uint32_t, 9>;
+using Counters = I2C::Register<uint16_t, 198>;
+
+// Fields are polled one by one or as a range, without an allocation.
+void TestFields(I2C::RegisterMap<200> &map) {
+  map.Set<Temperature>(21.5f);
+  map.Set<Humidity>(40.25f);
+  map.Set<Status>(3);
+  map.Set<Uptime>(123456);
+  map.Set<Counters>(999);
+  CHECK(map.Get<Humidity>() == 40.25f);
+
+  float humidity{0};
+  uint32_t uptime{0};
+  uint16_t counters{0};
+  test::ResetAllocs();
+  CHECK(I2C::Request::ReadRegister<Humidity>(kAddress, humidity));
+  CHECK(I2C::Request::ReadRegister<Uptime>(kAddress, uptime));
+  CHECK(I2C::Request::ReadRegister<Counters>(kAddress, counters));
+  CHECK_EQ(test::Allocs(), 0u);
+  CHECK(humidity == 40.25f);
+  CHECK_EQ(uptime, 123456u);
+  CHECK_EQ(counters, 999);
+
+  char range[9];
+  CHECK(I2C::Request::ReadRegisters(kAddress, Temperature::kOffset, range,
+                                    sizeof(range)));
+  float temperature;
+  memcpy(&temperature, range, sizeof(temperature));
+  CHECK(temperature == 21.5f);
+  CHECK_EQ(range[Status::kOffset], 3);
+
+  // Nothing past the end of the map.
+  CHECK(!I2C::Request::ReadRegisters(kAddress, 195, range, sizeof(range)));
+  CHECK(!map.SetBytes(195, range, 6));
+}
+
+// A range larger than the Wire buffer takes one offset write and one
+// request per buffer.
+void TestBurst(I2C::RegisterMap<200> &map) {
+  std::string data = test::Pattern(150);
+  CHECK(map.SetBytes(20, data.data(), data.size()));
+  std::string got(data.size(), '\0');
+  Wire.ResetCounters();
+  CHECK(I2C::Request::ReadRegisters(kAddress, 20, &got[0], got.size()));
+  CHECK(got == data);
+  CHECK_EQ(Wire.Transactions(), 1u + 5u);
+  CHECK_EQ(Wire.BusUs(), sim::I2cTransactionUs(1) +
+                             4 * sim::I2cTransactionUs(I2C::kBufferSize) +
+                             sim::I2cTransactionUs(150 - 4 * 32));
+
+  // Without an offset write the next request goes on after the full buffer
+  // the slave sent for the last one, wrapping at the end of the map.
+  CHECK_EQ(Wire.requestFrom(kAddress, I2C::kBufferSize), 20);
+  CHECK_EQ(Wire.requestFrom(kAddress, I2C::kBufferSize), I2C::kBufferSize);
+  CHECK_EQ(Wire.read(), 0);
+}
+
+}  // namespace
+
+int main() {
+  Wire.begin(kAddress);
+  I2C::RegisterMap<200> map;
+  map.Attach();
+  TestFields(map);
+  TestBurst(map);
+  return test::Result();
+}
@@ -0,0 +1,133 @@
+#include <utility>
+
+#include "common/com/com.h"
+#include "common/event/defs.h"
+#include "test.h"
+
+namespace {
+
+namespace I2C = common::com::I2C;
+
+constexpr uint8_t kAddress = 0x10;
+constexpr uint8_t kTypes = 24;
+
+int32_t received[kTypes];
+
+template <uint8_t N>
+void OnValue(const int32_t &value, int) {
+  received[N] = value;
+}
+
+template <uint8_t... N>
+bool Subscribe(std::integer_sequence<uint8_t, N...>) {
+  return (I2C::Subscriber::RegisterCallback(N, &OnValue<N>) && ...);
+}
+
+void Answer(int32_t &value) {
+  value = 42;
+}
+
+// Two methods of one class taking the same message type.
+struct Board {
+  void Temperature(double &value) { value = temperature; }
+  void Humidity(double &value) { value = humidity; }
+  void OnTemperature(const double &value, int) { temperature = value; }
+  void OnHumidity(const double &value, int) { humidity = value; }
+
+  double temperature{21.5};
+  double humidity{40};
+};
+
+// Every one of the types reaches its own handler, without an allocation.
+void TestSubscriptions() {
+  CHECK(Subscribe(std::make_integer_sequence<uint8_t, kTypes>()));
+  for (uint8_t i{0}; i < kTypes; ++i) {
+    received[i] = -1;
+  }
+  test::ResetAllocs();
+  CHECK_EQ(I2C::Publisher::Publish<5>(kAddress, int32_t{500}), 0);
+  CHECK_EQ(I2C::Publisher::Publish<0>(kAddress, int32_t{0}), 0);
+  CHECK_EQ(I2C::Publisher::Publish<23>(kAddress, int32_t{2300}), 0);
+  CHECK_EQ(test::Allocs(), 0u);
+  for (uint8_t i{0}; i < kTypes; ++i) {
+    CHECK_EQ(received[i], i == 5 ? 500 : i == 23 ? 2300 : i == 0 ? 0 : -1);
+  }
+
+  // Too short for the message type, the handler is skipped.
+  CHECK_EQ(I2C::Publisher::Publish<5>(kAddress, int8_t{1}), 0);
+  CHECK_EQ(received[5], 500);
+  // No route, nothing happens.
+  CHECK_EQ(I2C::Publisher::Publish<200>(kAddress, int32_t{1}), 0);
+}
+
+void TestReplies(Board &board) {
+  CHECK(I2C::Reply::RegisterCallback(100, &Answer));
+  CHECK(I2C::Reply::RegisterCallback(101, &board, &Board::Temperature));
+  CHECK(I2C::Reply::RegisterCallback(102, &board, &Board::Humidity));
+  CHECK(I2C::Subscriber::RegisterCallback(101, &board,
+                                          &Board::OnTemperature));
+  CHECK(I2C::Subscriber::RegisterCallback(102, &board, &Board::OnHumidity));
+
+  int32_t value{0};
+  test::ResetAllocs();
+  CHECK(I2C::Request::RequestFrom<100>(kAddress, value));
+  CHECK_EQ(test::Allocs(), 0u);
+  CHECK_EQ(value, 42);
+  double real{0};
+  CHECK(I2C::Request::RequestFrom<101>(kAddress, real));
+  CHECK(real == 21.5);
+  CHECK(I2C::Request::RequestFrom<102>(kAddress, real));
+  CHECK(real == 40);
+
+  CHECK_EQ(I2C::Publisher::Publish<101>(kAddress, 18.0), 0);
+  CHECK_EQ(I2C::Publisher::Publish<102>(kAddress, 55.0), 0);
+  CHECK(board.temperature == 18);
+  CHECK(board.humidity == 55);
+  // The selection outlives the writes to other types.
+  CHECK_EQ(I2C::Publisher::Publish<3>(kAddress, int32_t{3}), 0);
+  CHECK(I2C::Request::RequestFrom<101>(kAddress, real));
+  CHECK(real == 18);
+}
+
+// A full table still takes new callbacks for registered types.
+void TestFullTable() {
+  uint8_t type{110};
+  while (I2C::Subscriber::RegisterCallback(type, &OnValue<0>)) {
+    ++type;
+  }
+  CHECK_EQ(type, 110 + I2C::kMaxRoutes - kTypes - 5);
+  CHECK(I2C::Subscriber::RegisterCallback(110, &OnValue<1>));
+  received[1] = -1;
+  CHECK_EQ(I2C::Publisher::Publish<110>(kAddress, int32_t{11}), 0);
+  CHECK_EQ(received[1], 11);
+}
+
+void Status(common::Event &event) {
+  event.error_code = 3;
+  event.event_msg = "ok";
+}
+
+// Unrouted replies take over onRequest, so this runs last.
+void TestUnroutedEvent() {
+  common::Event expected;
+  Status(expected);
+  std::string encoded;
+  expected.Encode(encoded);
+  I2C::Reply::RegisterCallback(&Status);
+  common::Event event;
+  I2C::Request::RequestFrom(kAddress, encoded.size(), event);
+  CHECK_EQ(event.error_code, 3);
+  CHECK(event.event_msg == "ok");
+}
+
+}  // namespace
+
+int main() {
+  Wire.begin(kAddress);
+  Board board;
+  TestSubscriptions();
+  TestReplies(board);
+  TestFullTable();
+  TestUnroutedEvent();
+  return test::Result();
+}
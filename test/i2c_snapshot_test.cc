@@ -0,0 +1,79 @@
+#include "common/com/com.h"
+#include "common/event/defs.h"
+#include "test.h"
+
+namespace {
+
+namespace I2C = common::com::I2C;
+
+constexpr uint8_t kAddress = 0x11;
+
+common::Event MakeEvent(uint8_t error_code) {
+  common::Event event;
+  event.time = common::Time::FromSec(1000 + error_code);
+  event.error_code = error_code;
+  event.event_msg = "ok";
+  return event;
+}
+
+std::string Request(uint8_t quantity) {
+  std::string got;
+  I2C::Request::RequestFrom(kAddress, quantity, got);
+  return got;
+}
+
+// A request copies the last published bytes and nothing else, a message
+// larger than the Wire buffer keeps the previous one.
+void TestRouted() {
+  I2C::ReplySnapshot snapshot;
+  CHECK(I2C::Reply::RegisterSnapshot(7, snapshot));
+  CHECK(snapshot.Publish(int32_t{12}));
+  int32_t value{0};
+  test::ResetAllocs();
+  CHECK(I2C::Request::RequestFrom<7>(kAddress, value));
+  CHECK_EQ(test::Allocs(), 0u);
+  CHECK_EQ(value, 12);
+
+  CHECK(snapshot.Publish(int32_t{13}));
+  CHECK(snapshot.Publish(int32_t{14}));
+  CHECK(I2C::Request::RequestFrom<7>(kAddress, value));
+  CHECK_EQ(value, 14);
+  CHECK(!snapshot.Publish(std::string(I2C::kBufferSize + 1, 'x')));
+  CHECK(I2C::Request::RequestFrom<7>(kAddress, value));
+  CHECK_EQ(value, 14);
+
+  common::Event event = MakeEvent(2);
+  std::string encoded;
+  event.Encode(encoded);
+  CHECK(encoded.size() <= I2C::kBufferSize);
+  CHECK(snapshot.Publish(event));
+  common::Event got;
+  CHECK(I2C::Request::RequestFrom<7>(kAddress, got, encoded.size()));
+  CHECK_EQ(got.error_code, 2);
+  CHECK_EQ(got.time.Sec(), event.time.Sec());
+  CHECK(got.event_msg == "ok");
+}
+
+// Unrouted snapshots take over onRequest, so this runs last.
+void TestUnrouted() {
+  I2C::ReplySnapshot snapshot;
+  I2C::Reply::RegisterSnapshot(snapshot);
+  CHECK_EQ(Wire.requestFrom(kAddress, I2C::kBufferSize), 0);
+  std::string full(I2C::kBufferSize, 'y');
+  CHECK(snapshot.Publish(full));
+  test::ResetAllocs();
+  Wire.requestFrom(kAddress, I2C::kBufferSize);
+  CHECK_EQ(test::Allocs(), 0u);
+  CHECK(Request(I2C::kBufferSize) == full);
+  CHECK(snapshot.Publish(std::string("ab")));
+  CHECK(Request(2) == "ab");
+}
+
+}  // namespace
+
+int main() {
+  Wire.begin(kAddress);
+  TestRouted();
+  TestUnrouted();
+  return test::Result();
+}
@@ -0,0 +1,74 @@
+// Debug stays compiled in, the runtime level is what filters it.
+#define COMMON_LOG_MIN_LEVEL common::LOGLEVEL_DEBUG
+#include "common/log.h"
+
+#include <string>
+#include <vector>
+
+#include "test.h"
+
+namespace {
+
+using common::LogLevel;
+
+class Recorder : public common::StreamHandler {
+public:
+  void Log(const common::Event &event) override {
+    events.push_back(event);
+  }
+
+  std::vector<common::Event> events{};
+};
+
+// Messages below every handler's level build nothing: no message, no
+// Event, no RTC read.
+void TestSuppressed() {
+  common::Log log("level");
+  Recorder recorder;
+  log.AddStreamHandler(&recorder, common::LOGLEVEL_WARN);
+  CHECK(!log.Enabled(common::LOGLEVEL_DEBUG));
+  CHECK(log.Enabled(common::LOGLEVEL_INFO));
+
+  std::string name("a name long enough to be a heap block");
+  sim::Reset();
+  test::ResetAllocs();
+  log.Debug("reading %% from %%", 42, name);
+  log.Debug(name);
+  log.Debug(COMMON_FORMAT("reading %% from %%"), 42, name);
+  common::Event event;
+  event.level = common::LOGLEVEL_DEBUG;
+  log.LogEvent(event);
+  CHECK_EQ(test::Allocs(), 0u);
+  CHECK_EQ(sim::RtcReads(), 0u);
+
+  // Above the lowest level only the handlers that accept it are called.
+  log.Info("reading %%", 42);
+  CHECK(recorder.events.empty());
+  CHECK_EQ(sim::RtcReads(), 1u);
+  log.Warn(3, COMMON_FORMAT("reading %% from %%"), 42, name);
+  CHECK_EQ(recorder.events.size(), 1u);
+  CHECK_EQ(recorder.events[0].level, common::LOGLEVEL_WARN);
+  CHECK_EQ(recorder.events[0].error_code, 3);
+  CHECK(recorder.events[0].source_name == "level");
+  CHECK(recorder.events[0].event_msg == "reading 42 from " + name);
+}
+
+// A debug handler turns Debug on.
+void TestDebugHandler() {
+  common::Log log("debug");
+  Recorder recorder;
+  log.AddStreamHandler(&recorder, common::LOGLEVEL_DEBUG);
+  log.Debug("reading %%", 1);
+  log.Info("reading %%", 2);
+  CHECK(log.Enabled(common::LOGLEVEL_DEBUG));
+  CHECK_EQ(recorder.events.size(), 2u);
+  CHECK(recorder.events[0].event_msg == "reading 1");
+}
+
+}  // namespace
+
+int main() {
+  TestSuppressed();
+  TestDebugHandler();
+  return test::Result();
+}
@@ -0,0 +1,232 @@
+// The worker thread is part of the host build under test.
+#define COMMON_LOG_THREAD
+#include "common/log_limiter.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/log.h"
+#include "test.h"
+
+namespace {
+
+using common::LogLimiter;
+
+class Recorder : public common::StreamHandler {
+public:
+  void Log(const common::Event &event) override {
+    events.push_back(event);
+  }
+
+  std::vector<std::string> Lines() const {
+    std::vector<std::string> lines;
+    for (const auto &event : events) {
+      lines.push_back(event.event_msg);
+    }
+    return lines;
+  }
+
+  std::vector<common::Event> events{};
+};
+
+void AdvanceMs(uint32_t ms) {
+  sim::Advance(ms * 1000);
+}
+
+// Repeats within the window are counted, the summary follows once it
+// closes, before the next message or from Pump().
+void TestCoalesce() {
+  sim::Reset();
+  common::Log log("coalesce");
+  Recorder recorder;
+  log.AddStreamHandler(&recorder, common::LOGLEVEL_INFO);
+  log.SetCoalesceWindow(1000);
+  for (int i{0}; i < 100; ++i) {
+    log.Warn(3, COMMON_FORMAT("sensor %% failed"), i);
+    // Another error code is another message.
+    log.Warn(4, COMMON_FORMAT("sensor %% failed"), i);
+    AdvanceMs(5);
+  }
+  log.Info("pump %% on", 1);
+  CHECK(recorder.Lines() == std::vector<std::string>(
+                                {"sensor 0 failed", "sensor 0 failed",
+                                 "pump 1 on"}));
+
+  // Runtime templates are coalesced too.
+  AdvanceMs(500);
+  log.Info("pump %% on", 2);
+  std::vector<std::string> lines = recorder.Lines();
+  CHECK_EQ(lines.size(), 5u);
+  CHECK(lines[3] == "repeated 99 more times: sensor %% failed");
+  CHECK(lines[4] == "repeated 99 more times: sensor %% failed");
+  CHECK_EQ(recorder.events[3].level, common::LOGLEVEL_WARN);
+  CHECK_EQ(recorder.events[3].error_code, 3);
+  CHECK_EQ(recorder.events[4].error_code, 4);
+
+  // Their summary names them by id, the text may be gone.
+  recorder.events.clear();
+  AdvanceMs(500);
+  CHECK_EQ(log.Pump(), 0);
+  CHECK(recorder.Lines() ==
+        std::vector<std::string>({common::detail::Format(
+            "message %% repeated %% more times",
+            common::detail::FormatId("pump %% on"), 1)}));
+  CHECK_EQ(log.GetLimitStats().coalesced, 199u);
+
+  // Once the window closes the message is logged again.
+  recorder.events.clear();
+  log.Warn(3, COMMON_FORMAT("sensor %% failed"), 7);
+  CHECK(recorder.Lines() == std::vector<std::string>({"sensor 7 failed"}));
+}
+
+// Past kSlots distinct messages the others are logged as they come.
+void TestSlots() {
+  sim::Reset();
+  common::Log log("slots");
+  Recorder recorder;
+  log.AddStreamHandler(&recorder, common::LOGLEVEL_INFO);
+  log.SetCoalesceWindow(1000);
+  for (int round{0}; round < 3; ++round) {
+    for (uint8_t code{0}; code <= LogLimiter::kSlots; ++code) {
+      log.Warn(code, COMMON_FORMAT("sensor failed"));
+    }
+  }
+  CHECK_EQ(recorder.events.size(), LogLimiter::kSlots + 3u);
+  CHECK_EQ(log.GetLimitStats().coalesced, 2u * LogLimiter::kSlots);
+}
+
+// A burst, then per_minute, the rest is counted and reported once a token
+// is back at the highest level dropped.
+void TestRateLimit() {
+  sim::Reset();
+  common::Log log("rate");
+  Recorder recorder;
+  log.AddStreamHandler(&recorder, common::LOGLEVEL_INFO);
+  log.SetRateLimit(3, 60);
+  for (int i{0}; i < 10; ++i) {
+    if (i == 5) {
+      log.Error(1, COMMON_FORMAT("sensor %% failed"), i);
+    } else {
+      log.Info(COMMON_FORMAT("sensor %% failed"), i);
+    }
+  }
+  CHECK_EQ(recorder.events.size(), 3u);
+  CHECK_EQ(log.GetLimitStats().rate_limited, 7u);
+
+  AdvanceMs(999);
+  log.Pump();
+  CHECK_EQ(recorder.events.size(), 3u);
+  AdvanceMs(1);
+  log.Pump();
+  CHECK_EQ(recorder.events.size(), 4u);
+  CHECK(recorder.events[3].event_msg ==
+        "7 messages dropped by the rate limit");
+  CHECK_EQ(recorder.events[3].level, common::LOGLEVEL_ERROR);
+
+  // The summary took the token, the bucket refills up to the burst only,
+  // however long it waited.
+  log.Info("next");
+  CHECK_EQ(recorder.events.size(), 4u);
+  AdvanceMs(4000000);
+  for (int i{0}; i < 5; ++i) {
+    log.Info("next");
+  }
+  log.Pump();
+  CHECK_EQ(recorder.events.size(), 7u);
+  AdvanceMs(1000);
+  log.Pump();
+  CHECK(recorder.events.back().event_msg ==
+        "3 messages dropped by the rate limit");
+
+  // Off again, nothing is held back.
+  log.SetRateLimit(0, 0);
+  for (int i{0}; i < 10; ++i) {
+    log.Info("free");
+  }
+  CHECK_EQ(recorder.events.size(), 18u);
+}
+
+// Coalesced repeats take no token.
+void TestBoth() {
+  sim::Reset();
+  common::Log log("both");
+  Recorder recorder;
+  log.AddStreamHandler(&recorder, common::LOGLEVEL_INFO);
+  log.SetCoalesceWindow(100);
+  log.SetRateLimit(2, 60);
+  for (int i{0}; i < 50; ++i) {
+    log.Warn(1, COMMON_FORMAT("sensor %% failed"), i);
+  }
+  log.Warn(2, COMMON_FORMAT("bus %% stuck"), 1);
+  log.Warn(3, COMMON_FORMAT("bus %% stuck"), 2);
+  CHECK(recorder.Lines() == std::vector<std::string>(
+                                {"sensor 0 failed", "bus 1 stuck"}));
+  common::LogLimitStats stats = log.GetLimitStats();
+  CHECK_EQ(stats.coalesced, 49u);
+  CHECK_EQ(stats.rate_limited, 1u);
+
+  // Summaries wait for tokens too.
+  AdvanceMs(1000);
+  log.Pump();
+  AdvanceMs(1000);
+  log.Pump();
+  CHECK(recorder.Lines() ==
+        std::vector<std::string>({"sensor 0 failed", "bus 1 stuck",
+                                  "repeated 49 more times: sensor %% failed",
+                                  "1 messages dropped by the rate limit"}));
+}
+
+// Counts the binary records, written by both the logging thread and the
+// worker.
+class BinaryCounter : public Recorder {
+public:
+  void LogBinary(const common::Time &, const std::string &) override {
+    ++records;
+  }
+
+  std::atomic<uint32_t> records{0};
+};
+
+// The limits and the binary mode change while another thread logs and the
+// worker pumps, every message is delivered, dropped or counted.
+void TestWorker() {
+  sim::Reset();
+  common::Log log("worker");
+  BinaryCounter recorder;
+  log.AddStreamHandler(&recorder, common::LOGLEVEL_INFO);
+  log.SetQueuePolicy(common::LogQueuePolicy::kDropNewest);
+  log.StartWorker();
+  constexpr uint32_t kLogged{2000};
+  std::atomic<bool> done{false};
+  std::thread writer([&] {
+    for (uint32_t i{0}; i < kLogged; ++i) {
+      log.Warn(i % 4, COMMON_FORMAT("sensor %% failed"), i);
+    }
+    done = true;
+  });
+  for (int round{0}; !done; ++round) {
+    log.SetCoalesceWindow(round % 3 ? 100 : 0);
+    log.SetRateLimit(round % 4 ? 20 : 0, 60);
+    log.SetBinary(round % 5 == 0);
+  }
+  writer.join();
+  log.StopWorker();
+  common::LogLimitStats limits = log.GetLimitStats();
+  CHECK(recorder.events.size() + recorder.records +
+            log.GetQueueStats().dropped + limits.coalesced +
+            limits.rate_limited >=
+        kLogged);
+}
+
+}  // namespace
+
+int main() {
+  TestCoalesce();
+  TestSlots();
+  TestRateLimit();
+  TestBoth();
+  TestWorker();
+  return test::Result();
+}
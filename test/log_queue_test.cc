@@ -0,0 +1,125 @@
+// The worker thread is part of the host build under test.
+#define COMMON_LOG_THREAD
+#include "common/log.h"
+
+#include <string>
+#include <vector>
+
+#include "test.h"
+
+namespace {
+
+using common::LogQueuePolicy;
+
+// Takes cost_us of simulated time per line, like a slow serial port.
+class Recorder : public common::StreamHandler {
+public:
+  void Log(const common::Event &event) override {
+    if (cost_us) {
+      sim::Advance(cost_us);
+    }
+    lines.push_back(event.event_msg);
+  }
+
+  std::vector<std::string> lines{};
+  uint32_t cost_us{0};
+};
+
+std::vector<std::string> Lines(int first, int last) {
+  std::vector<std::string> lines;
+  for (int i{first}; i <= last; ++i) {
+    lines.push_back(common::Format(COMMON_FORMAT("line %%"), i));
+  }
+  return lines;
+}
+
+// Messages wait for Pump(), which respects its budget but delivers at
+// least one, timestamps are taken by the caller.
+void TestPump() {
+  sim::Reset();
+  common::Log log("queue");
+  Recorder recorder;
+  recorder.cost_us = 1000;
+  log.AddStreamHandler(&recorder, common::LOGLEVEL_WARN);
+  log.SetQueuePolicy(LogQueuePolicy::kDropOldest);
+  for (int i{1}; i <= 5; ++i) {
+    log.Warn(0, COMMON_FORMAT("line %%"), i);
+  }
+  CHECK(recorder.lines.empty());
+  CHECK_EQ(log.Pending(), 5);
+  CHECK_EQ(sim::Now(), 0u);
+
+  CHECK_EQ(log.Pump(1), 1);
+  CHECK_EQ(log.Pump(2000), 2);
+  CHECK_EQ(log.Pump(), 2);
+  CHECK_EQ(log.Pump(), 0);
+  CHECK(recorder.lines == Lines(1, 5));
+  common::LogQueueStats stats = log.GetQueueStats();
+  CHECK_EQ(stats.queued, 5u);
+  CHECK_EQ(stats.delivered, 5u);
+  CHECK_EQ(stats.dropped, 0u);
+  CHECK_EQ(stats.max_pending, 5);
+
+  // Back to synchronous delivery, what was pending goes first.
+  log.Warn(0, COMMON_FORMAT("line %%"), 6);
+  log.SetQueuePolicy(LogQueuePolicy::kSync);
+  log.Warn(0, COMMON_FORMAT("line %%"), 7);
+  CHECK(recorder.lines == Lines(1, 7));
+  CHECK_EQ(log.Pending(), 0);
+}
+
+// A full queue drops its oldest or the new message, and counts it.
+void TestDrops() {
+  constexpr int kCapacity = COMMON_LOG_QUEUE_SIZE;
+  for (LogQueuePolicy policy :
+       {LogQueuePolicy::kDropOldest, LogQueuePolicy::kDropNewest}) {
+    common::Log log("drops");
+    Recorder recorder;
+    log.AddStreamHandler(&recorder, common::LOGLEVEL_WARN);
+    log.SetQueuePolicy(policy);
+    for (int i{1}; i <= kCapacity + 3; ++i) {
+      log.Warn(0, COMMON_FORMAT("line %%"), i);
+    }
+    log.Pump();
+    bool oldest = policy == LogQueuePolicy::kDropOldest;
+    CHECK(recorder.lines ==
+          (oldest ? Lines(4, kCapacity + 3) : Lines(1, kCapacity)));
+    common::LogQueueStats stats = log.GetQueueStats();
+    CHECK_EQ(stats.dropped, 3u);
+    CHECK_EQ(stats.delivered, static_cast<uint32_t>(kCapacity));
+    CHECK_EQ(stats.max_pending, kCapacity);
+  }
+}
+
+// A worker thread drains the queue in order, stopping it delivers the
+// rest, switching policies while it runs loses nothing.
+void TestWorker() {
+  common::Log log("worker");
+  Recorder recorder;
+  log.AddStreamHandler(&recorder, common::LOGLEVEL_WARN);
+  log.SetQueuePolicy(LogQueuePolicy::kDropNewest);
+  log.StartWorker();
+  int logged{0};
+  for (int round{0}; round < 50; ++round) {
+    for (int i{0}; i < 4; ++i) {
+      log.Warn(0, COMMON_FORMAT("line %%"), ++logged);
+    }
+    log.SetQueuePolicy(round % 2 ? LogQueuePolicy::kDropNewest
+                                 : LogQueuePolicy::kSync);
+  }
+  log.StopWorker();
+  CHECK_EQ(recorder.lines.size() + log.GetQueueStats().dropped,
+           static_cast<size_t>(logged));
+  for (size_t i{1}; i < recorder.lines.size(); ++i) {
+    CHECK(recorder.lines[i - 1] != recorder.lines[i]);
+  }
+}
+
+}  // namespace
+
+int main() {
+  TestPump();
+  TestDrops();
+  TestWorker();
+  return test::Result();
+}
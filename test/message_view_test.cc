@@ -0,0 +1,111 @@
+#include "common/com/schema.h"
+
+#include <string>
+
+#include "common/event/defs.h"
+#include "test.h"
+
+namespace {
+
+using common::com::CompactEncoding;
+using common::com::Field;
+using common::com::StringView;
+
+template <typename Policy>
+struct Reading : common::SensorReading {
+  using EncodingPolicy = Policy;
+};
+
+template <typename Policy>
+std::string EncodeReading() {
+  Reading<Policy> reading;
+  reading.time = common::Time::FromSec(1700000123);
+  reading.sensor_id = common::Symbol::Static("dht-1");
+  reading.sensor_type = common::Symbol::Static("dht22");
+  reading.data_type = common::Symbol::Static("humidity");
+  reading.reading.template Emplace<int>(45);
+  reading.unit = common::Symbol::Static("%");
+  std::string bytes;
+  common::com::Encode(reading, bytes);
+  return bytes;
+}
+
+// Every field reads back in place, strings point into the buffer, nothing
+// allocates.
+template <typename Policy>
+void CheckReadingView() {
+  using View = common::com::MessageView<Reading<Policy>>;
+  std::string bytes = EncodeReading<Policy>();
+  bytes += "next message";
+
+  test::ResetAllocs();
+  View view(bytes);
+  CHECK(view.Ok());
+  CHECK_EQ(view.Size(), bytes.size() - 12);
+  CHECK_EQ(view.template Get<&common::SensorReading::time>().Sec(),
+           1700000123u);
+  StringView id = view.template Get<&common::SensorReading::sensor_id>();
+  CHECK(id == "dht-1");
+  CHECK(id.Data() > bytes.data() && id.Data() < bytes.data() + bytes.size());
+  CHECK(view.template Get<&common::SensorReading::data_type>() ==
+        "humidity");
+  CHECK(view.template Get<&common::SensorReading::unit>() == "%");
+  common::DeviceDataType value =
+      view.template Get<&common::SensorReading::reading>();
+  CHECK(value.GetIf<int>() && *value.GetIf<int>() == 45);
+  CHECK_EQ(test::Allocs(), 0u);
+
+  // A cut anywhere makes the view empty rather than partial.
+  for (size_t cut{0}; cut < view.Size(); ++cut) {
+    View partial(bytes.data(), cut);
+    CHECK(!partial.Ok());
+    CHECK_EQ(partial.Size(), 0u);
+    CHECK(partial.template Get<&common::SensorReading::unit>() == "");
+  }
+}
+
+void TestReadingView() {
+  CheckReadingView<common::com::FixedEncoding>();
+  CheckReadingView<CompactEncoding>();
+
+  common::Event event;
+  event.level = common::LOGLEVEL_ERROR;
+  event.error_code = 3;
+  event.event_msg = "flow low";
+  std::string bytes;
+  event.Encode(bytes);
+  common::EventView view(bytes);
+  CHECK(view.Ok());
+  CHECK_EQ(view.Get<&common::Event::level>(), common::LOGLEVEL_ERROR);
+  CHECK_EQ(view.Get<&common::Event::error_code>(), 3);
+  CHECK(view.Get<&common::Event::source_name>() == "");
+  CHECK(view.Get<&common::Event::event_msg>() == "flow low");
+}
+
+struct Blob {
+  std::string data{};
+  uint32_t crc{0};
+
+  using Schema = common::com::Schema<Field<&Blob::data>, Field<&Blob::crc>>;
+};
+
+// Field offsets past 64 KiB stay exact on the host.
+void TestLargeMessage() {
+  Blob blob;
+  blob.data.assign(70000, 'x');
+  blob.crc = 0xC0FFEE;
+  std::string bytes;
+  common::com::Encode(blob, bytes);
+  common::com::MessageView<Blob> view(bytes);
+  CHECK(view.Ok());
+  CHECK_EQ(view.Get<&Blob::data>().Size(), 70000u);
+  CHECK_EQ(view.Get<&Blob::crc>(), 0xC0FFEEu);
+}
+
+}  // namespace
+
+int main() {
+  TestReadingView();
+  TestLargeMessage();
+  return test::Result();
+}
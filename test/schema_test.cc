@@ -0,0 +1,151 @@
+#include "common/com/schema.h"
+
+#include <string>
+
+#include "common/event/defs.h"
+#include "test.h"
+
+namespace {
+
+using common::com::ByteSpan;
+using common::com::CompactEncoding;
+using common::com::Field;
+using common::com::FixedEncoding;
+using common::com::Schema;
+
+enum Mode : int32_t { MODE_IDLE = 0, MODE_RUN = 5 };
+
+struct Sample {
+  uint16_t id{0};
+  Mode mode{MODE_IDLE};
+  common::Variant<double, int32_t> value;
+  std::string name{};
+  int64_t total{0};
+
+  using Schema = common::com::Schema<
+      Field<&Sample::id>,
+      Field<&Sample::mode, uint8_t>,
+      Field<&Sample::value>,
+      Field<&Sample::name>,
+      Field<&Sample::total>>;
+};
+
+struct CompactSample : Sample {
+  using EncodingPolicy = CompactEncoding;
+};
+
+static_assert(common::com::IsEncodible<Sample>::value);
+static_assert(Sample::Schema::kNumFields == 5);
+static_assert(Sample::Schema::kMinSize == 2 + 1 + 9 + 4 + 8);
+static_assert(!Sample::Schema::kFixedLayout);
+static_assert(Sample::Schema::IndexOf<&Sample::name>() == 3);
+static_assert(Sample::Schema::Offset<0>() == 0);
+static_assert(Sample::Schema::Offset<2>() == 3);
+static_assert(Sample::Schema::Offset<3>() == 12);
+
+// The generated layouts keep the bytes the hand written codecs produced.
+static_assert(common::Event::Schema::Offset<1>() == 4);
+static_assert(common::Event::Schema::Offset<2>() == 5);
+static_assert(common::Event::Schema::Offset<3>() == 6);
+static_assert(common::Event::Schema::kMinSize == 14);
+static_assert(common::SensorReading::Schema::Offset<2>() == 13);
+
+template <typename Type>
+Type MakeSample() {
+  Type sample;
+  sample.id = 513;
+  sample.mode = MODE_RUN;
+  sample.value.template Emplace<int32_t>(-7);
+  sample.name = "pump";
+  sample.total = -3;
+  return sample;
+}
+
+template <typename Type>
+void CheckRoundTrip(size_t size) {
+  Type sample = MakeSample<Type>();
+  std::string bytes;
+  common::com::Encode(sample, bytes);
+  CHECK_EQ(bytes.size(), size);
+
+  Type decoded;
+  ByteSpan span(bytes);
+  CHECK(common::com::Decode(span, decoded));
+  CHECK_EQ(span.Remaining(), 0u);
+  CHECK_EQ(decoded.id, 513);
+  CHECK_EQ(decoded.mode, MODE_RUN);
+  CHECK(decoded.value.template GetIf<int32_t>() &&
+        *decoded.value.template GetIf<int32_t>() == -7);
+  CHECK(decoded.name == "pump");
+  CHECK_EQ(decoded.total, -3);
+
+  // Every cut fails instead of reading past the end.
+  for (size_t cut{0}; cut < bytes.size(); ++cut) {
+    Type partial;
+    ByteSpan cut_span(bytes.data(), cut);
+    CHECK(!common::com::Decode(cut_span, partial));
+  }
+}
+
+// Fields in declaration order, the enum as its one byte wire type, the
+// variant in a slot of its largest alternative under FixedEncoding.
+void TestRoundTrip() {
+  CheckRoundTrip<Sample>(Sample::Schema::kMinSize + 4);
+  std::string bytes;
+  common::com::Encode(MakeSample<Sample>(), bytes);
+  CHECK_EQ(static_cast<uint8_t>(bytes[0]), 1);
+  CHECK_EQ(static_cast<uint8_t>(bytes[1]), 2);
+  CHECK_EQ(static_cast<uint8_t>(bytes[2]), MODE_RUN);
+  CHECK_EQ(static_cast<uint8_t>(bytes[3]), 2);
+  CHECK(bytes.substr(16, 4) == "pump");
+
+  // Varints: 2 + 1 + (1 + 1) + (1 + 4) + 1.
+  CheckRoundTrip<CompactSample>(11);
+}
+
+// Tag 0 is an empty variant, an unknown tag empties it under FixedEncoding
+// where the slot is skipped, and fails under CompactEncoding where the size
+// of the value is unknown.
+void TestVariantTags() {
+  Sample empty;
+  std::string bytes;
+  common::com::Encode(empty, bytes);
+  Sample decoded = MakeSample<Sample>();
+  ByteSpan span(bytes);
+  CHECK(common::com::Decode(span, decoded));
+  CHECK(!decoded.value.HoldsAlternative<double>());
+  CHECK(!decoded.value.HoldsAlternative<int32_t>());
+
+  bytes.clear();
+  common::com::Encode(MakeSample<Sample>(), bytes);
+  bytes[3] = 9;
+  ByteSpan fixed_span(bytes);
+  CHECK(common::com::Decode(fixed_span, decoded));
+  CHECK(!decoded.value.HoldsAlternative<int32_t>());
+  CHECK(decoded.name == "pump");
+
+  CompactSample compact = MakeSample<CompactSample>();
+  bytes.clear();
+  common::com::Encode(compact, bytes);
+  CompactSample compact_decoded;
+  ByteSpan compact_span(bytes);
+  CHECK(common::com::Decode(compact_span, compact_decoded));
+  bytes[3] = 9;
+  ByteSpan bad_span(bytes);
+  CHECK(!common::com::Decode(bad_span, compact_decoded));
+
+  using Codec = common::com::FieldCodec<common::Variant<double, int32_t>>;
+  common::Variant<double, int32_t> value;
+  ByteSpan tag_span("\x09\x0D", 2);
+  CHECK(!Codec::Decode<CompactEncoding>(tag_span, value));
+  ByteSpan empty_span("\x00", 1);
+  CHECK(Codec::Decode<CompactEncoding>(empty_span, value));
+}
+
+}  // namespace
+
+int main() {
+  TestRoundTrip();
+  TestVariantTags();
+  return test::Result();
+}
@@ -0,0 +1,134 @@
+#include "common/event/sensor_reading_batch.h"
+
+#include <string>
+
+#include "test.h"
+
+namespace {
+
+using common::SensorReading;
+using common::SensorReadingBatch;
+using common::com::ByteSpan;
+using common::com::StringSink;
+
+SensorReading MakeReading(size_t i) {
+  static const char *kIds[] = {"dht-0", "dht-1", "dht-2"};
+  SensorReading reading;
+  reading.time = common::Time::FromSec(1700000000 + i * 30 - (i == 3) * 90);
+  reading.sensor_id = common::Symbol::Static(kIds[i % 3]);
+  reading.sensor_type = common::Symbol::Static("dht22");
+  if (i % 4 == 1) {
+    reading.data_type = common::Symbol::Static("humidity");
+    reading.unit = common::Symbol::Static("%");
+    reading.reading.Emplace<int>(40 - static_cast<int>(i));
+  } else if (i % 4 != 3) {
+    reading.data_type = common::Symbol::Static("temperature");
+    reading.unit = common::Symbol::Static("C");
+    reading.reading.Emplace<double>(20.5 + i);
+  }
+  return reading;
+}
+
+bool SameReading(const SensorReading &a, const SensorReading &b) {
+  return a.time.Sec() == b.time.Sec() && a.sensor_id == b.sensor_id &&
+         a.sensor_type == b.sensor_type && a.data_type == b.data_type &&
+         a.unit == b.unit && a.reading.Index() == b.reading.Index() &&
+         (!a.reading.GetIf<double>() ||
+          *a.reading.GetIf<double>() == *b.reading.GetIf<double>()) &&
+         (!a.reading.GetIf<int>() ||
+          *a.reading.GetIf<int>() == *b.reading.GetIf<int>());
+}
+
+constexpr size_t kReadings = 12;
+
+std::string EncodeBatch(SensorReadingBatch &batch) {
+  for (size_t i{0}; i < kReadings; ++i) {
+    CHECK(batch.Add(MakeReading(i)));
+  }
+  std::string bytes;
+  StringSink sink(bytes);
+  batch.Encode(sink);
+  return bytes;
+}
+
+// Readings come back one by one and as columns, times going backwards and
+// empty readings included, in fewer bytes than encoded one by one.
+void TestRoundTrip() {
+  SensorReadingBatch batch;
+  std::string bytes = EncodeBatch(batch);
+  CHECK_EQ(batch.Size(), kReadings);
+
+  std::string single;
+  StringSink single_sink(single);
+  for (size_t i{0}; i < kReadings; ++i) {
+    common::com::Encode(MakeReading(i), single_sink);
+  }
+  CHECK(bytes.size() * 2 < single.size());
+
+  SensorReadingBatch decoded;
+  ByteSpan span(bytes);
+  decoded.Decode(span);
+  CHECK(span.Ok());
+  CHECK_EQ(span.Remaining(), 0u);
+  CHECK_EQ(decoded.Size(), kReadings);
+  for (size_t i{0}; i < kReadings; ++i) {
+    CHECK(SameReading(decoded.Get(i), MakeReading(i)));
+  }
+  CHECK_EQ(decoded.Times()[3], 1700000000u);
+  CHECK(decoded.String(decoded.KeyColumn()[1].unit) == "%");
+  CHECK(decoded.Readings()[5].GetIf<int>() &&
+        *decoded.Readings()[5].GetIf<int>() == 35);
+
+  SensorReadingBatch empty;
+  std::string empty_bytes;
+  StringSink empty_sink(empty_bytes);
+  empty.Encode(empty_sink);
+  ByteSpan empty_span(empty_bytes);
+  decoded.Decode(empty_span);
+  CHECK(empty_span.Ok());
+  CHECK(decoded.Empty());
+}
+
+void CheckRejected(const std::string &bytes) {
+  SensorReadingBatch decoded;
+  ByteSpan span(bytes);
+  decoded.Decode(span);
+  CHECK(!span.Ok());
+  CHECK(decoded.Empty());
+}
+
+// Malformed input leaves the batch empty and the span bad.
+void TestMalformed() {
+  SensorReadingBatch batch;
+  std::string bytes = EncodeBatch(batch);
+  for (size_t cut{0}; cut < bytes.size(); ++cut) {
+    CheckRejected(bytes.substr(0, cut));
+  }
+
+  // The tag column starts after the keys, the doubles and ints follow it.
+  size_t doubles{0};
+  size_t ints{0};
+  for (const auto &reading : batch.Readings()) {
+    doubles += reading.GetIf<double>() != nullptr;
+    ints += reading.GetIf<int>() != nullptr;
+  }
+  size_t tags = bytes.size() - ints - doubles * sizeof(double) - kReadings;
+  std::string bad_tag = bytes;
+  bad_tag[tags + 3] = 3;
+  CheckRejected(bad_tag);
+
+  std::string bad_key = bytes;
+  bad_key[tags - 1] = batch.KeyColumn().size();
+  CheckRejected(bad_key);
+
+  // A count far beyond the bytes is refused before anything is allocated.
+  CheckRejected(std::string("\xFF\xFF\x03\x00", 4));
+}
+
+}  // namespace
+
+int main() {
+  TestRoundTrip();
+  TestMalformed();
+  return test::Result();
+}
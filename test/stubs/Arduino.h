@@ -0,0 +1,120 @@
+#pragma once
+
+// Host stand-in for the parts of the Arduino core the library uses. Time is
+// simulated: millis() / micros() only move when the code waits (delay(),
+// yield(), a full serial TX buffer) or a test advances it, see sim.h.
+
+#include <avr/pgmspace.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using std::isinf;
+using std::isnan;
+
+// HardwareSerial / SoftwareSerial ring sizes, one slot is always free.
+#define SERIAL_RX_BUFFER_SIZE 64
+#define SERIAL_TX_BUFFER_SIZE 64
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x0
+#define OUTPUT 0x1
+
+namespace sim {
+
+// Simulated time in microseconds.
+uint64_t Now();
+
+}  // namespace sim
+
+inline unsigned long millis() {
+  return static_cast<uint32_t>(sim::Now() / 1000);
+}
+
+inline unsigned long micros() {
+  return static_cast<uint32_t>(sim::Now());
+}
+
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return LOW; }
+inline void analogWrite(uint8_t, int) {}
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+class Print {
+public:
+  virtual ~Print() = default;
+
+  virtual size_t write(uint8_t c) = 0;
+
+  virtual size_t write(const uint8_t *data, size_t size) {
+    size_t written{0};
+    while (size--) {
+      written += write(*data++);
+    }
+    return written;
+  }
+
+  size_t write(const char *data, size_t size) {
+    return write(reinterpret_cast<const uint8_t *>(data), size);
+  }
+
+  size_t write(const char *str) {
+    return write(str, strlen(str));
+  }
+
+  virtual int availableForWrite() { return 0; }
+  virtual void flush() {}
+
+  size_t print(const char *str) { return write(str); }
+  size_t print(const std::string &str) { return write(str.c_str(), str.size()); }
+
+  template <typename T,
+            typename = std::enable_if_t<std::is_arithmetic<T>::value>>
+  size_t print(T value) {
+    return print(std::to_string(value));
+  }
+
+  size_t println(const char *str = "") { return print(str) + write("\r\n"); }
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  void setTimeout(unsigned long timeout_ms) { timeout_ms_ = timeout_ms; }
+
+  // Waits up to the stream timeout (1 s by default) for every byte, as the
+  // core does.
+  size_t readBytes(char *buffer, size_t size);
+
+  size_t readBytes(uint8_t *buffer, size_t size) {
+    return readBytes(reinterpret_cast<char *>(buffer), size);
+  }
+
+protected:
+  unsigned long timeout_ms_{1000};
+};
+
+#include "sim.h"
+
+class HardwareSerial : public sim::Uart {
+public:
+  HardwareSerial() : sim::Uart(SERIAL_TX_BUFFER_SIZE - 1) {}
+};
+
+extern HardwareSerial Serial;
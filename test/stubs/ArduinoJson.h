@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Just enough of ArduinoJson for ToJson() and serializeJson(): an object
+// tree that keeps insertion order and prints compact JSON.
+class JsonVariant {
+public:
+  JsonVariant &operator[](const char *key) {
+    for (auto &member : members_) {
+      if (member.first == key) {
+        return *member.second;
+      }
+    }
+    value_.clear();
+    members_.emplace_back(key, std::make_shared<JsonVariant>());
+    return *members_.back().second;
+  }
+
+  JsonVariant &operator=(const std::string &value) {
+    members_.clear();
+    value_ = Quote(value);
+    return *this;
+  }
+
+  JsonVariant &operator=(const char *value) {
+    return *this = std::string(value);
+  }
+
+  template <typename T,
+            typename = std::enable_if_t<std::is_arithmetic<T>::value>>
+  JsonVariant &operator=(T value) {
+    members_.clear();
+    if constexpr (std::is_same<T, bool>::value) {
+      value_ = value ? "true" : "false";
+    } else if constexpr (std::is_floating_point<T>::value) {
+      char buffer[32];
+      snprintf(buffer, sizeof(buffer), "%.9g", static_cast<double>(value));
+      value_ = buffer;
+    } else {
+      value_ = std::to_string(value);
+    }
+    return *this;
+  }
+
+  void Print(std::string &out) const {
+    if (members_.empty()) {
+      out += value_.empty() ? "null" : value_;
+      return;
+    }
+    out += '{';
+    for (size_t i{0}; i < members_.size(); ++i) {
+      if (i) {
+        out += ',';
+      }
+      out += Quote(members_[i].first);
+      out += ':';
+      members_[i].second->Print(out);
+    }
+    out += '}';
+  }
+
+  size_t size() const { return members_.size(); }
+
+private:
+  static std::string Quote(const std::string &str) {
+    std::string quoted{"\""};
+    for (char c : str) {
+      if (c == '"' || c == '\\') {
+        quoted += '\\';
+      }
+      quoted += c;
+    }
+    return quoted + '"';
+  }
+
+  std::vector<std::pair<std::string, std::shared_ptr<JsonVariant>>>
+      members_{};
+  std::string value_{};
+};
+
+class DynamicJsonDocument : public JsonVariant {
+public:
+  explicit DynamicJsonDocument(size_t) {}
+  void shrinkToFit() {}
+};
+
+template <unsigned int Size>
+class StaticJsonDocument : public JsonVariant {};
+
+inline size_t serializeJson(const JsonVariant &doc, std::string &out) {
+  out.clear();
+  doc.Print(out);
+  return out.size();
+}
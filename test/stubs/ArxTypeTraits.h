@@ -0,0 +1,14 @@
+#pragma once
+
+// The host standard library has everything ArxTypeTraits backports.
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace arx::stdx {
+using std::enable_if_t;
+}  // namespace arx::stdx
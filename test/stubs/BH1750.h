@@ -0,0 +1,11 @@
+#pragma once
+
+#include <Arduino.h>
+
+class BH1750 {
+public:
+  bool begin() { return true; }
+  float readLightLevel() { return kLux; }
+
+  static inline float kLux{120.0f};
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <Arduino.h>
+
+#define DHT_TYPE_11 0
+#define DHT_TYPE_21 1
+#define DHT_TYPE_22 2
+
+// Returns a fixed measurement, set by the tests through the statics.
+class DHT_nonblocking {
+public:
+  DHT_nonblocking(uint8_t, uint8_t) {}
+
+  bool measure(float *temperature, float *humidity) {
+    *temperature = kTemperature;
+    *humidity = kHumidity;
+    return true;
+  }
+
+  static inline float kTemperature{21.5f};
+  static inline float kHumidity{40.0f};
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <Arduino.h>
+
+#define LCD_5x8DOTS 0x00
+#define LCD_5x10DOTS 0x04
+
+// Keeps the text of the current line.
+class LiquidCrystal : public Print {
+public:
+  LiquidCrystal(uint8_t, uint8_t, uint8_t, uint8_t, uint8_t, uint8_t) {}
+
+  void begin(uint8_t, uint8_t, uint8_t = LCD_5x8DOTS) {}
+  void clear() { text_.clear(); }
+  void display() {}
+  void noDisplay() {}
+  void setCursor(uint8_t, uint8_t) {}
+
+  size_t write(uint8_t c) override {
+    text_ += static_cast<char>(c);
+    return 1;
+  }
+  using Print::write;
+
+  const std::string &Text() const { return text_; }
+
+private:
+  std::string text_{};
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include <map>
+#include <memory>
+
+#define FILE_READ 0x01
+#define O_RDONLY 0x00
+#define O_RDWR 0x02
+#define O_CREAT 0x10
+#define O_APPEND 0x04
+
+// In-memory card: files are strings keyed by path, directories exist once
+// created. Enough for the handlers to write and the tests to look at what
+// was stored.
+class File {
+public:
+  File() = default;
+
+  size_t write(const uint8_t *data, size_t size) {
+    if (!data_) {
+      return 0;
+    }
+    data_->append(reinterpret_cast<const char *>(data), size);
+    return size;
+  }
+
+  size_t write(uint8_t c) { return write(&c, 1); }
+  int read();
+  int available() { return data_ ? data_->size() - position_ : 0; }
+  size_t size() const { return data_ ? data_->size() : 0; }
+  void flush() {}
+  void close() { data_.reset(); }
+  bool isDirectory() const { return directory_; }
+  const char *name() const { return name_.c_str(); }
+  File openNextFile(uint8_t = O_RDONLY);
+  void rewindDirectory() { next_ = 0; }
+  explicit operator bool() const { return data_ || directory_; }
+
+private:
+  friend class SDClass;
+
+  std::shared_ptr<std::string> data_{};
+  std::string name_{};
+  std::string path_{};
+  size_t position_{0};
+  size_t next_{0};
+  bool directory_{false};
+};
+
+class SDClass {
+public:
+  bool begin(uint8_t = 0) { return true; }
+  File open(const char *path, uint8_t mode = FILE_READ);
+  bool exists(const char *path);
+  bool mkdir(const char *path);
+  bool remove(const char *path);
+  bool rmdir(const char *path);
+
+  // Test side.
+  const std::map<std::string, std::shared_ptr<std::string>> &Files() const {
+    return files_;
+  }
+  size_t TotalBytes() const;
+  void Clear() {
+    files_.clear();
+    directories_.clear();
+  }
+
+private:
+  friend class File;
+
+  std::map<std::string, std::shared_ptr<std::string>> files_{};
+  std::map<std::string, bool> directories_{};
+};
+
+extern SDClass SD;
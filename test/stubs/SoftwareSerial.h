@@ -0,0 +1,12 @@
+#pragma once
+
+#include <Arduino.h>
+
+// No TX ring: write() takes the time of the byte on the line.
+class SoftwareSerial : public sim::Uart {
+public:
+  SoftwareSerial(uint8_t, uint8_t) : sim::Uart(0) {}
+
+  bool listen() { return true; }
+  bool isListening() { return true; }
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Wire on the simulated bus. One board plays both roles: a master
+// transaction addressed to the address given to begin(address) runs this
+// Wire's own onReceive / onRequest handlers (the slave side under test),
+// other addresses go to the sim::I2cDevice attached there. Every
+// transaction moves the clock by its bus time.
+class TwoWire : public Stream {
+public:
+  static constexpr size_t kBufferLength = 32;
+
+  void begin() {}
+  void begin(uint8_t address) { address_ = address; }
+  void setClock(uint32_t clock_hz) { clock_hz_ = clock_hz; }
+  void setWireTimeout(uint32_t timeout_us = 25000, bool = false) {
+    timeout_us_ = timeout_us;
+  }
+
+  void onReceive(void (*handler)(int)) { on_receive_ = handler; }
+  void onRequest(void (*handler)()) { on_request_ = handler; }
+
+  void beginTransmission(uint8_t address);
+  uint8_t endTransmission(bool stop = true);
+  uint8_t requestFrom(uint8_t address, uint8_t quantity, uint8_t stop = 1);
+
+  size_t write(uint8_t c) override;
+  using Print::write;
+  int available() override { return rx_size_ - rx_index_; }
+  int read() override {
+    return rx_index_ < rx_size_ ? rx_[rx_index_++] : -1;
+  }
+  int peek() override { return rx_index_ < rx_size_ ? rx_[rx_index_] : -1; }
+  int availableForWrite() override { return kBufferLength - tx_size_; }
+
+  // Transactions run, data bytes moved and bus time used, for the
+  // benchmarks.
+  uint32_t Transactions() const { return transactions_; }
+  uint64_t Bytes() const { return bytes_; }
+  uint64_t BusUs() const { return bus_us_; }
+  void ResetCounters() { transactions_ = 0; bytes_ = 0; bus_us_ = 0; }
+
+private:
+  void Run(size_t bytes);
+
+  uint8_t rx_[kBufferLength]{};
+  uint8_t tx_[kBufferLength]{};
+  uint8_t rx_index_{0};
+  uint8_t rx_size_{0};
+  uint8_t tx_size_{0};
+  uint8_t address_{0};
+  uint8_t target_{0};
+  bool transmitting_{false};
+  uint32_t clock_hz_{100000};
+  uint32_t timeout_us_{0};
+  void (*on_receive_)(int){nullptr};
+  void (*on_request_)(){nullptr};
+  uint32_t transactions_{0};
+  uint64_t bytes_{0};
+  uint64_t bus_us_{0};
+};
+
+extern TwoWire Wire;
@@ -0,0 +1,5 @@
+#pragma once
+
+// Shadows src/common/stl/string.h: the host std::string already has the
+// numeric conversions that header adds to ArduinoSTL.
+#include <string>
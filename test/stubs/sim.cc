@@ -0,0 +1,438 @@
+#include <Arduino.h>
+#include <SD.h>
+#include <Wire.h>
+
+#include <map>
+
+#include "common/time/time.h"
+
+HardwareSerial Serial;
+TwoWire Wire;
+SDClass SD;
+
+namespace sim {
+
+namespace {
+
+struct State {
+  uint64_t now_us{0};
+  uint32_t tick_us{10};
+  uint32_t rtc_reads{0};
+  std::function<void()> background{};
+  bool in_background{false};
+  std::map<uint8_t, I2cDevice *> devices{};
+};
+
+State &GetState() {
+  static State state;
+  return state;
+}
+
+}  // namespace
+
+uint64_t Now() {
+  return GetState().now_us;
+}
+
+uint32_t RtcReads() {
+  return GetState().rtc_reads;
+}
+
+void Reset() {
+  State &state = GetState();
+  state.now_us = 0;
+  state.rtc_reads = 0;
+  state.background = nullptr;
+}
+
+void Advance(uint64_t us) {
+  GetState().now_us += us;
+}
+
+void SetYieldTick(uint32_t us) {
+  GetState().tick_us = us;
+}
+
+void SetBackground(std::function<void()> task) {
+  GetState().background = std::move(task);
+}
+
+void Yield() {
+  State &state = GetState();
+  if (state.background && !state.in_background) {
+    state.in_background = true;
+    state.background();
+    state.in_background = false;
+  }
+  state.now_us += state.tick_us;
+}
+
+uint32_t Uart::ByteTimeNs() const {
+  // Start bit, 8 data bits and a stop bit.
+  return config_.baud ? 10000000000 / config_.baud : 0;
+}
+
+uint8_t Uart::Corrupt(uint8_t byte) {
+  if (!config_.bit_error_rate) {
+    return byte;
+  }
+  for (uint8_t bit{0}; bit < 8; ++bit) {
+    rng_ = rng_ * 1103515245u + 12345u;
+    if ((rng_ >> 8) * (1.0 / (1u << 24)) < config_.bit_error_rate) {
+      byte ^= 1 << bit;
+    }
+  }
+  return byte;
+}
+
+void Uart::Deliver() {
+  uint64_t now = Now();
+  while (!incoming_.empty() && incoming_.front().arrival_us <= now) {
+    uint8_t byte = incoming_.front().byte;
+    incoming_.pop_front();
+    if (config_.drop_rate) {
+      rng_ = rng_ * 1103515245u + 12345u;
+      if ((rng_ >> 8) * (1.0 / (1u << 24)) < config_.drop_rate) {
+        continue;
+      }
+    }
+    if (rx_.size() < kRxCapacity) {
+      rx_.push_back(Corrupt(byte));
+    } else {
+      ++overruns_;
+    }
+  }
+}
+
+int Uart::available() {
+  Deliver();
+  return rx_.size();
+}
+
+int Uart::read() {
+  Deliver();
+  if (rx_.empty()) {
+    return -1;
+  }
+  uint8_t byte = rx_.front();
+  rx_.pop_front();
+  return byte;
+}
+
+int Uart::peek() {
+  Deliver();
+  return rx_.empty() ? -1 : rx_.front();
+}
+
+int Uart::availableForWrite() {
+  uint64_t now = Now();
+  while (!tx_.empty() && tx_.front() <= now) {
+    tx_.pop_front();
+  }
+  return tx_.size() < tx_capacity_ ? tx_capacity_ - tx_.size() : 0;
+}
+
+size_t Uart::write(uint8_t c) {
+  uint64_t byte_ns = ByteTimeNs();
+  uint64_t start = Now();
+  // SoftwareSerial bit-bangs the byte, HardwareSerial waits for a free slot.
+  if (byte_ns && !tx_capacity_) {
+    while (Now() * 1000 < start * 1000 + byte_ns) {
+      yield();
+    }
+  } else if (byte_ns) {
+    while (!availableForWrite()) {
+      yield();
+    }
+  }
+  blocked_us_ += Now() - start;
+
+  uint64_t now_ns = Now() * 1000;
+  uint64_t departure_ns =
+      (line_free_ns_ > now_ns ? line_free_ns_ : now_ns) +
+      (tx_capacity_ ? byte_ns : 0);
+  line_free_ns_ = departure_ns;
+  uint64_t departure_us = (departure_ns + 999) / 1000;
+  if (tx_capacity_ && byte_ns) {
+    tx_.push_back(departure_us);
+  }
+  ++sent_;
+  if (peer_) {
+    peer_->incoming_.push_back({departure_us + config_.latency_us, c});
+  } else if (capture_) {
+    captured_ += static_cast<char>(c);
+  }
+  return 1;
+}
+
+void Uart::flush() {
+  uint64_t start = Now();
+  while (Now() * 1000 < line_free_ns_) {
+    yield();
+  }
+  blocked_us_ += Now() - start;
+}
+
+std::string Uart::TakeCaptured() {
+  std::string captured;
+  captured.swap(captured_);
+  return captured;
+}
+
+void Uart::ResetCounters() {
+  sent_ = 0;
+  overruns_ = 0;
+  blocked_us_ = 0;
+}
+
+void Uart::Receive(const std::string &bytes) {
+  for (char c : bytes) {
+    if (rx_.size() < kRxCapacity) {
+      rx_.push_back(static_cast<uint8_t>(c));
+    } else {
+      ++overruns_;
+    }
+  }
+}
+
+void Connect(Uart &a, Uart &b, const LineConfig &config) {
+  a.peer_ = &b;
+  b.peer_ = &a;
+  a.config_ = b.config_ = config;
+  a.rng_ = config.seed;
+  b.rng_ = config.seed * 7919u + 1;
+  for (Uart *port : {&a, &b}) {
+    port->rx_.clear();
+    port->incoming_.clear();
+    port->tx_.clear();
+    port->line_free_ns_ = 0;
+    port->ResetCounters();
+  }
+}
+
+void AttachI2c(uint8_t address, I2cDevice *device) {
+  GetState().devices[address] = device;
+}
+
+void DetachI2c() {
+  GetState().devices.clear();
+}
+
+I2cDevice *FindI2c(uint8_t address) {
+  auto it = GetState().devices.find(address);
+  return it == GetState().devices.end() ? nullptr : it->second;
+}
+
+uint32_t I2cTransactionUs(size_t bytes, uint32_t clock_hz) {
+  // Start, address + ack, 9 clocks per byte, stop.
+  return static_cast<uint64_t>(1 + 9 + 9 * bytes + 1) * 1000000 / clock_hz;
+}
+
+}  // namespace sim
+
+void yield() {
+  sim::Yield();
+}
+
+void delay(unsigned long ms) {
+  uint64_t end = sim::Now() + static_cast<uint64_t>(ms) * 1000;
+  while (sim::Now() < end) {
+    yield();
+  }
+}
+
+void delayMicroseconds(unsigned int us) {
+  sim::Advance(us);
+}
+
+size_t Stream::readBytes(char *buffer, size_t size) {
+  size_t read{0};
+  uint32_t start = millis();
+  while (read < size) {
+    int c = this->read();
+    if (c >= 0) {
+      buffer[read++] = static_cast<char>(c);
+    } else if (millis() - start >= timeout_ms_) {
+      break;
+    } else {
+      yield();
+    }
+  }
+  return read;
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+  target_ = address;
+  tx_size_ = 0;
+  transmitting_ = true;
+}
+
+size_t TwoWire::write(uint8_t c) {
+  if (tx_size_ == kBufferLength) {
+    return 0;
+  }
+  tx_[tx_size_++] = c;
+  return 1;
+}
+
+void TwoWire::Run(size_t bytes) {
+  ++transactions_;
+  bytes_ += bytes;
+  uint32_t us = sim::I2cTransactionUs(bytes, clock_hz_);
+  bus_us_ += us;
+  sim::Advance(us);
+}
+
+uint8_t TwoWire::endTransmission(bool) {
+  transmitting_ = false;
+  size_t size = tx_size_;
+  tx_size_ = 0;
+  Run(size);
+  if (address_ && target_ == address_) {
+    memcpy(rx_, tx_, size);
+    rx_index_ = 0;
+    rx_size_ = size;
+    if (on_receive_) {
+      on_receive_(size);
+    }
+    return 0;
+  }
+  sim::I2cDevice *device = sim::FindI2c(target_);
+  if (!device) {
+    // Address not acknowledged.
+    return 2;
+  }
+  device->OnReceive(tx_, size);
+  return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, uint8_t) {
+  if (quantity > kBufferLength) {
+    quantity = kBufferLength;
+  }
+  size_t size{0};
+  if (address_ && address == address_) {
+    // The slave's reply goes through the TX buffer as on the board.
+    tx_size_ = 0;
+    if (on_request_) {
+      on_request_();
+    }
+    size = tx_size_ < quantity ? tx_size_ : quantity;
+    memcpy(rx_, tx_, size);
+    tx_size_ = 0;
+  } else if (sim::I2cDevice *device = sim::FindI2c(address)) {
+    size = device->OnRequest(rx_, quantity);
+  }
+  rx_index_ = 0;
+  rx_size_ = size;
+  Run(size);
+  return size;
+}
+
+int File::read() {
+  if (!data_ || position_ >= data_->size()) {
+    return -1;
+  }
+  return static_cast<uint8_t>((*data_)[position_++]);
+}
+
+File File::openNextFile(uint8_t) {
+  File next;
+  if (!directory_) {
+    return next;
+  }
+  std::string prefix = path_ + "/";
+  size_t index{0};
+  for (const auto &file : SD.files_) {
+    if (file.first.compare(0, prefix.size(), prefix) ||
+        file.first.find('/', prefix.size()) != std::string::npos) {
+      continue;
+    }
+    if (index++ == next_) {
+      ++next_;
+      next.data_ = file.second;
+      next.path_ = file.first;
+      next.name_ = file.first.substr(prefix.size());
+      return next;
+    }
+  }
+  return next;
+}
+
+File SDClass::open(const char *path, uint8_t mode) {
+  File file;
+  file.path_ = path;
+  file.name_ = path;
+  if (directories_.count(path)) {
+    file.directory_ = true;
+    return file;
+  }
+  auto it = files_.find(path);
+  if (it == files_.end()) {
+    if (!(mode & O_CREAT)) {
+      return file;
+    }
+    it = files_.emplace(path, std::make_shared<std::string>()).first;
+  }
+  file.data_ = it->second;
+  return file;
+}
+
+bool SDClass::exists(const char *path) {
+  return files_.count(path) || directories_.count(path);
+}
+
+bool SDClass::mkdir(const char *path) {
+  directories_[path] = true;
+  return true;
+}
+
+bool SDClass::remove(const char *path) {
+  return files_.erase(path);
+}
+
+bool SDClass::rmdir(const char *path) {
+  return directories_.erase(path);
+}
+
+size_t SDClass::TotalBytes() const {
+  size_t bytes{0};
+  for (const auto &file : files_) {
+    bytes += file.second->size();
+  }
+  return bytes;
+}
+
+namespace common {
+
+// The RTC reads the simulated clock, starting 2023-11-14T22:13:20.
+Time Time::last_sync_;
+
+Time Time::Now() {
+  ++sim::GetState().rtc_reads;
+  uint64_t now = sim::Now();
+  return FromSec(1700000000 + now / 1000000, (now % 1000000) * 1000);
+}
+
+std::string Time::ToString(Time::TimeOption opt) const {
+  char buf[sizeof "YYYY-MM-DDThh:mm:ss"];
+  time_t sec = sec_;
+  strftime(buf, sizeof buf, "%FT%T", gmtime(&sec));
+  switch (opt) {
+    case Time::TimeOption::TIMESTAMP_ISO: {
+      return std::string(buf);
+    }
+    case Time::TimeOption::TIMESTAMP_BASIC: {
+      return std::string(buf + sizeof "YYYY" - 1);
+    }
+    case Time::TimeOption::TIMESTAMP_MS: {
+      // Room for any unsigned, nsec_ / kNsToMs is below 1000.
+      char val[11];
+      snprintf(val, sizeof val, "%03u", nsec_ / kNsToMs);
+      return std::to_string(sec_) + std::string(val);
+    }
+  }
+  return std::string();
+}
+
+}  // namespace common
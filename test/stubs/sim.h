@@ -0,0 +1,139 @@
+#pragma once
+
+// Simulated time, serial lines and I2C bus behind the Arduino stand-ins.
+//
+// Nothing runs concurrently: the other end of a link is a task run from
+// yield(), which the library calls while it waits, and from the tests' own
+// loops. Every wait moves the clock, so transfer times come out in link time
+// and are the same on every run.
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+
+namespace sim {
+
+// Puts the clock back to 0 and drops the background task.
+void Reset();
+void Advance(uint64_t us);
+
+// Time::Now() calls since Reset(), each an I2C RTC read on the board.
+uint32_t RtcReads();
+
+// Time yield() advances by, the cost of one turn of a polling loop.
+void SetYieldTick(uint32_t us);
+
+// Runs from yield(), typically the loop() of the board on the other end of
+// a link. Not re-entered: yield() called from the task only moves the clock.
+void SetBackground(std::function<void()> task);
+
+struct LineConfig {
+  long baud{115200};
+  // Added to the transmission time of every byte.
+  uint32_t latency_us{0};
+  // Probability for every bit of a byte to be flipped, and for a whole byte
+  // to be lost.
+  double bit_error_rate{0};
+  double drop_rate{0};
+  uint32_t seed{1};
+};
+
+// One side of a UART line, modelled after the AVR cores: a 63 byte RX ring
+// that drops what arrives while it is full and a TX ring (none for
+// SoftwareSerial) emptied at the line rate. write() waits, calling yield(),
+// while the TX ring is full.
+class Uart : public Stream {
+public:
+  static constexpr size_t kRxCapacity = SERIAL_RX_BUFFER_SIZE - 1;
+
+  explicit Uart(size_t tx_capacity) : tx_capacity_{tx_capacity} {}
+
+  // The baud rate only matters for a port that is not connected.
+  void begin(long baud) {
+    if (!peer_) {
+      config_.baud = baud;
+    }
+  }
+
+  void end() {}
+
+  explicit operator bool() const { return true; }
+
+  int available() override;
+  int read() override;
+  int peek() override;
+  int availableForWrite() override;
+  size_t write(uint8_t c) override;
+  using Print::write;
+  void flush() override;
+
+  // Bytes written to a port that is not connected, kept when Capture() is
+  // on. Sent() counts them either way.
+  void Capture(bool capture) { capture_ = capture; }
+  std::string TakeCaptured();
+  uint64_t Sent() const { return sent_; }
+
+  // Bytes lost to a full RX ring.
+  uint32_t Overruns() const { return overruns_; }
+  // Time write() and flush() spent waiting for the line.
+  uint64_t BlockedUs() const { return blocked_us_; }
+  void ResetCounters();
+
+  // Puts bytes straight into the RX ring, as if they had just arrived.
+  void Receive(const std::string &bytes);
+
+  // Time a byte takes on the line.
+  uint32_t ByteTimeNs() const;
+
+private:
+  friend void Connect(Uart &, Uart &, const LineConfig &);
+
+  struct InFlight {
+    uint64_t arrival_us;
+    uint8_t byte;
+  };
+
+  // Moves the bytes that arrived by now into the RX ring.
+  void Deliver();
+  uint8_t Corrupt(uint8_t byte);
+
+  Uart *peer_{nullptr};
+  LineConfig config_{0};
+  size_t tx_capacity_;
+  std::deque<uint8_t> rx_{};
+  std::deque<InFlight> incoming_{};
+  // Departure time of the bytes still in the TX ring.
+  std::deque<uint64_t> tx_{};
+  // Time the line is done with the last byte written.
+  uint64_t line_free_ns_{0};
+  uint64_t blocked_us_{0};
+  uint64_t sent_{0};
+  uint32_t overruns_{0};
+  uint32_t rng_{1};
+  bool capture_{false};
+  std::string captured_{};
+};
+
+// Full duplex line between two ports.
+void Connect(Uart &a, Uart &b, const LineConfig &config = LineConfig());
+
+// A device on the simulated I2C bus, see TwoWire.
+class I2cDevice {
+public:
+  virtual ~I2cDevice() = default;
+  // A master write of size bytes.
+  virtual void OnReceive(const uint8_t *data, size_t size) = 0;
+  // A master read: fills up to quantity bytes, returns how many.
+  virtual size_t OnRequest(uint8_t *data, size_t quantity) = 0;
+};
+
+void AttachI2c(uint8_t address, I2cDevice *device);
+void DetachI2c();
+I2cDevice *FindI2c(uint8_t address);
+
+// Bus time of a transaction moving bytes data bytes (start, address, acks
+// and stop included) at the given clock.
+uint32_t I2cTransactionUs(size_t bytes, uint32_t clock_hz = 100000);
+
+}  // namespace sim
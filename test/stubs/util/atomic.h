@@ -0,0 +1,7 @@
+#pragma once
+
+// Interrupts are simulated by direct calls on the host, there is nothing to
+// hold off.
+#define ATOMIC_RESTORESTATE 0
+#define ATOMIC_FORCEON 0
+#define ATOMIC_BLOCK(type) for (bool _done = false; !_done; _done = true)
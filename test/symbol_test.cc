@@ -0,0 +1,206 @@
+#include "common/utility/symbol.h"
+
+#include <string>
+#include <utility>
+
+#include "common/com/specialized_encoding.h"
+#include "common/device/temperature_sensor.h"
+#include "common/event/defs.h"
+#include "test.h"
+
+namespace {
+
+using common::Symbol;
+
+// Equal texts share a handle however they were registered, constants are
+// not copied, other texts are copied once.
+void TestInterning() {
+  static const char kName[] = "dht-1";
+  Symbol a = Symbol::Static(kName);
+  size_t count = Symbol::Count();
+  test::ResetAllocs();
+  Symbol b("dht-1");
+  Symbol c = Symbol::Flash(PSTR("dht-1"));
+  Symbol d;
+  CHECK(Symbol::Intern("dht-1 extra", 5, d));
+  CHECK_EQ(test::Allocs(), 0u);
+  CHECK(a == b && b == c && c == d);
+  CHECK_EQ(Symbol::Count(), count);
+
+  Symbol e("dht-2");
+  CHECK_EQ(test::Allocs(), 1u);
+  CHECK(Symbol(std::string("dht-2")) == e);
+  CHECK(e != a);
+  CHECK(e == "dht-2");
+  CHECK(e != "dht-");
+  CHECK(e != "dht-22");
+  CHECK_EQ(e.Size(), 5u);
+  CHECK(e.ToString() == "dht-2");
+  CHECK_EQ(Symbol::Count(), count + 1);
+
+  // A prefix or an extension of an interned text is a different text.
+  Symbol prefix;
+  CHECK(Symbol::Intern("dht", 3, prefix));
+  CHECK(prefix != a);
+  CHECK(prefix == "dht");
+
+  // Flash texts are looked up and registered where they are, however long.
+  static const char kLong[] = "soil moisture, north bed";
+  Symbol in_ram = Symbol::Static(kLong);
+  test::ResetAllocs();
+  Symbol in_flash = Symbol::Flash(PSTR("soil moisture, north bed"));
+  Symbol other = Symbol::Flash(PSTR("soil moisture, south bed"));
+  CHECK(Symbol::Flash(PSTR("soil moisture, south bed")) == other);
+  CHECK(Symbol::Flash(PSTR("")).Empty());
+  CHECK_EQ(test::Allocs(), 0u);
+  CHECK(in_flash == in_ram);
+  CHECK(other.Interned() && other != in_ram);
+  CHECK(other == "soil moisture, south bed");
+
+  Symbol empty("");
+  CHECK(empty.Empty());
+  CHECK(empty == Symbol());
+  CHECK(empty == "");
+  CHECK_EQ(empty.Size(), 0u);
+
+  std::string written;
+  common::com::StringSink sink(written);
+  e.Write(sink);
+  empty.Write(sink);
+  CHECK(written == "dht-2");
+}
+
+// Decoded texts with a '\0' are refused instead of matching a shorter one.
+void TestEmbeddedNul() {
+  Symbol a = Symbol::Static("pump");
+  Symbol b = a;
+  CHECK(!Symbol::Intern("pump\0x", 6, b));
+  CHECK(b == a);
+  CHECK(!Symbol::Intern("\0", 1, b));
+}
+
+// Decoded texts are looked up, not interned: known ones take their handle
+// without allocating, others are private copies that compare by text.
+void TestDecode() {
+  Symbol pump = Symbol::Static("pump");
+  size_t count = Symbol::Count();
+  Symbol symbol;
+  test::ResetAllocs();
+  CHECK(Symbol::Decode("pump", 4, symbol));
+  CHECK_EQ(test::Allocs(), 0u);
+  CHECK(symbol.Interned());
+  CHECK(symbol == pump);
+
+  CHECK(Symbol::Decode("remote-7", 8, symbol));
+  CHECK(!symbol.Interned());
+  CHECK(!symbol.Empty());
+  CHECK_EQ(symbol.GetHandle(), 0);
+  CHECK_EQ(Symbol::Count(), count);
+  CHECK(symbol == "remote-7");
+  CHECK(symbol != pump);
+  CHECK_EQ(symbol.Size(), 8u);
+  CHECK(symbol.ToString() == "remote-7");
+  std::string written;
+  common::com::StringSink sink(written);
+  symbol.Write(sink);
+  CHECK(written == "remote-7");
+
+  Symbol copy = symbol;
+  CHECK(copy == symbol && copy == "remote-7");
+  Symbol moved = std::move(copy);
+  CHECK(moved == symbol && copy.Empty());
+  copy = pump;
+  CHECK(copy.Interned() && copy == pump);
+  copy = symbol;
+  CHECK(!copy.Interned() && copy == symbol);
+  Symbol other;
+  CHECK(Symbol::Decode("remote-8", 8, other));
+  CHECK(other != symbol);
+  CHECK(!Symbol::Decode("pump\0x", 6, other));
+  CHECK(other == "remote-8");
+
+  // An interned symbol equals a private copy of its text.
+  Symbol interned("remote-7");
+  CHECK(interned.Interned());
+  CHECK(interned == symbol && symbol == interned);
+  CHECK(Symbol::Decode("remote-7", 8, symbol));
+  CHECK(symbol.Interned() && symbol == interned);
+  count = Symbol::Count();
+
+  // Opting in interns up to the limit.
+  Symbol::InternDecoded(1);
+  CHECK(Symbol::Decode("remote-9", 8, symbol));
+  CHECK(symbol.Interned());
+  CHECK(Symbol::Decode("remote-10", 9, other));
+  CHECK(!other.Interned());
+  CHECK_EQ(Symbol::Count(), count + 1);
+}
+
+// Past the capacity Intern() fails and the constructors keep private
+// copies, the texts already interned keep working and decoding still
+// succeeds.
+void TestFull() {
+  // "s" and the digits of any size_t.
+  static char texts[Symbol::kCapacity][22];
+  Symbol first = Symbol::Static("pump");
+  for (size_t i{0}; Symbol::Count() < Symbol::kCapacity; ++i) {
+    snprintf(texts[i], sizeof(texts[i]), "s%zu", i);
+    CHECK(!Symbol::Static(texts[i]).Empty());
+  }
+  Symbol symbol = first;
+  CHECK(!Symbol::Intern("one more", 8, symbol));
+  CHECK(symbol == first);
+  Symbol more("one more");
+  CHECK(!more.Interned() && more == "one more");
+  Symbol another = Symbol::Static("another");
+  CHECK(!another.Interned() && another == "another");
+  CHECK(Symbol::Flash(PSTR("pump")) == first);
+  Symbol flashed = Symbol::Flash(PSTR("flash extra"));
+  CHECK(!flashed.Interned() && flashed == "flash extra");
+  CHECK(Symbol::Intern("pump", 4, symbol));
+  CHECK(symbol == first);
+
+  common::SensorReading reading;
+  reading.sensor_id = more;
+  reading.sensor_type = first;
+  reading.data_type = Symbol::Static("fresh");
+  reading.reading.Emplace<double>(1.5);
+  std::string msg;
+  reading.Encode(msg);
+  for (int i{0}; i < 3; ++i) {
+    common::SensorReading decoded;
+    common::com::ByteSpan span(msg.data(), msg.size());
+    CHECK(common::com::Decode(span, decoded));
+    CHECK(decoded.sensor_id == "one more");
+    CHECK(decoded.sensor_type.Interned() && decoded.sensor_type == first);
+    CHECK(decoded.data_type == "fresh");
+    CHECK(decoded.unit.Empty());
+  }
+  CHECK_EQ(Symbol::Count(), Symbol::kCapacity);
+}
+
+// Readings carry the sensor's handles, generating one allocates nothing.
+void TestSensorReading() {
+  common::device::DHT22 sensor("dht-1", 2);
+  sim::Advance(3000000);
+  CHECK(sensor.UpdateReading());
+  sensor.GenerateSensorReading(1);
+  test::ResetAllocs();
+  common::SensorReading reading = sensor.GenerateSensorReading(1);
+  CHECK_EQ(test::Allocs(), 0u);
+  CHECK(reading.sensor_id == "dht-1");
+  CHECK(reading.sensor_type == "DHT22");
+  CHECK(reading.data_type == "humidity");
+  CHECK(reading.unit == "%");
+}
+
+}  // namespace
+
+int main() {
+  TestInterning();
+  TestEmbeddedNul();
+  TestDecode();
+  TestSensorReading();
+  TestFull();
+  return test::Result();
+}
@@ -0,0 +1,154 @@
+#include <vector>
+
+#include "com_link.h"
+#include "common/com/cobs.h"
+#include "common/event/defs.h"
+#include "test.h"
+
+namespace {
+
+using common::com::PacketDecoder;
+using common::com::TelemetryStats;
+
+common::SensorReading Reading(uint32_t i) {
+  common::SensorReading reading;
+  reading.time = common::Time::FromSec(i);
+  reading.sensor_id = common::Symbol::Static("dht-1");
+  reading.reading.Emplace<double>(21.5);
+  return reading;
+}
+
+// Records go out back to back and nothing comes back.
+void TestStream() {
+  test::Link link;
+  PacketDecoder decoder(common::com::UART::kMaxPacketSize);
+  TelemetryStats stats;
+  std::vector<uint32_t> got;
+  sim::SetBackground([&] {
+    common::SensorReading reading;
+    while (test::Uart::ReadTelemetry(link.b, decoder, stats, reading, false,
+                                     0)) {
+      got.push_back(reading.time.Sec());
+    }
+  });
+  uint16_t seq{0};
+  for (uint32_t i{0}; i < 100; ++i) {
+    test::Uart::WriteTelemetry(link.a, seq, Reading(i));
+  }
+  link.a.flush();
+  delay(1);
+  CHECK_EQ(got.size(), 100u);
+  for (size_t i{0}; i < got.size(); ++i) {
+    CHECK_EQ(got[i], i);
+  }
+  CHECK_EQ(stats.received, 100u);
+  CHECK_EQ(stats.lost, 0u);
+  CHECK_EQ(seq, 100);
+  CHECK_EQ(link.b.Sent(), 0u);
+}
+
+// Gaps between sequence numbers are counted as lost, a sender restarting at
+// 0 and the wrap around are not.
+void TestGaps() {
+  TelemetryStats stats;
+  for (uint16_t seq : {0, 1, 4, 5}) {
+    stats.Update(seq);
+  }
+  CHECK_EQ(stats.received, 4u);
+  CHECK_EQ(stats.lost, 2u);
+  stats.Update(0);
+  CHECK_EQ(stats.lost, 2u);
+  stats.Update(10);
+  CHECK_EQ(stats.lost, 11u);
+
+  TelemetryStats wrap;
+  for (uint16_t seq : {65534, 65535, 0, 1}) {
+    wrap.Update(seq);
+  }
+  CHECK_EQ(wrap.lost, 0u);
+}
+
+// Lost records show up in the stats, nothing in between is misread.
+void TestLossyLine() {
+  sim::LineConfig config;
+  config.drop_rate = 1e-3;
+  config.seed = 5;
+  test::Link link(config);
+  PacketDecoder decoder(common::com::UART::kMaxPacketSize);
+  TelemetryStats stats;
+  uint32_t last{0};
+  sim::SetBackground([&] {
+    common::SensorReading reading;
+    while (test::Uart::ReadTelemetry(link.b, decoder, stats, reading, false,
+                                     0)) {
+      CHECK(stats.received == 1 || reading.time.Sec() > last);
+      last = reading.time.Sec();
+    }
+  });
+  uint16_t seq{0};
+  for (uint32_t i{0}; i < 1000; ++i) {
+    test::Uart::WriteTelemetry(link.a, seq, Reading(i));
+  }
+  link.a.flush();
+  delay(1);
+  CHECK(stats.received > 900);
+  CHECK_EQ(stats.received + stats.lost, last + 1);
+}
+
+// A record that does not decode is refused and leaves the stats alone.
+void TestUndecodable() {
+  test::Link link;
+  PacketDecoder decoder(common::com::UART::kMaxPacketSize);
+  TelemetryStats stats;
+  uint16_t seq{0};
+  test::Uart::WriteTelemetry(link.a, seq, Reading(0));
+  test::Uart::WriteTelemetry(link.a, seq, std::string("short"));
+  test::Uart::WriteTelemetry(link.a, seq, Reading(2));
+  common::SensorReading reading;
+  CHECK(test::Uart::ReadTelemetry(link.b, decoder, stats, reading, true, 10));
+  CHECK(!test::Uart::ReadTelemetry(link.b, decoder, stats, reading, true,
+                                   10));
+  CHECK_EQ(stats.received, 1u);
+  CHECK_EQ(stats.next_seq, 1);
+  CHECK(test::Uart::ReadTelemetry(link.b, decoder, stats, reading, true, 10));
+  CHECK_EQ(reading.time.Sec(), 2u);
+  CHECK_EQ(stats.received, 2u);
+  CHECK_EQ(stats.lost, 1u);
+}
+
+// Every record type written to a port shares its sequence.
+void TestPortSequence() {
+  using Com = common::com::UART::HardwareCom<0>;
+  test::Link link;
+  sim::Connect(Serial, link.b);
+  Com::Init(115200);
+  PacketDecoder decoder(common::com::UART::kMaxPacketSize);
+  TelemetryStats stats;
+  common::SensorReading reading;
+  int32_t value{0};
+  double real{0};
+  Com::WriteTelemetry(Reading(0));
+  CHECK(test::Uart::ReadTelemetry(link.b, decoder, stats, reading, true, 10));
+  Com::WriteTelemetry(int32_t{7});
+  CHECK(test::Uart::ReadTelemetry(link.b, decoder, stats, value, true, 10));
+  Com::WriteTelemetry(2.5);
+  CHECK(test::Uart::ReadTelemetry(link.b, decoder, stats, real, true, 10));
+  Com::WriteTelemetry(Reading(1));
+  CHECK(test::Uart::ReadTelemetry(link.b, decoder, stats, reading, true, 10));
+  CHECK_EQ(value, 7);
+  CHECK(real == 2.5);
+  CHECK_EQ(reading.time.Sec(), 1u);
+  CHECK_EQ(stats.received, 4u);
+  CHECK_EQ(stats.lost, 0u);
+}
+
+}  // namespace
+
+int main() {
+  TestStream();
+  TestGaps();
+  TestLossyLine();
+  TestUndecodable();
+  TestPortSequence();
+  return test::Result();
+}
@@ -0,0 +1,64 @@
+#include "test.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// Log worker threads allocate too.
+std::atomic<size_t> allocs{0};
+std::atomic<size_t> alloc_bytes{0};
+
+}  // namespace
+
+void *operator new(size_t size) {
+  allocs.fetch_add(1, std::memory_order_relaxed);
+  alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+  if (void *ptr = malloc(size ? size : 1)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept {
+  free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+  free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+  free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+  free(ptr);
+}
+
+namespace test {
+
+int &Failures() {
+  static int failures{0};
+  return failures;
+}
+
+size_t Allocs() {
+  return allocs;
+}
+
+size_t AllocBytes() {
+  return alloc_bytes;
+}
+
+void ResetAllocs() {
+  allocs = 0;
+  alloc_bytes = 0;
+}
+
+}  // namespace test
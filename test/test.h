@@ -0,0 +1,83 @@
+#pragma once
+
+// Minimal checks for the host tests. A failed CHECK prints where and keeps
+// going, Result() turns the failure count into the exit status.
+
+#include <Arduino.h>
+
+#include <chrono>
+#include <cstdio>
+#include <type_traits>
+
+namespace test {
+
+int &Failures();
+
+// Heap allocations and bytes since the last ResetAllocs(), counted by the
+// global operator new.
+size_t Allocs();
+size_t AllocBytes();
+void ResetAllocs();
+
+inline int Result() {
+  if (Failures()) {
+    printf("%d check(s) failed\n", Failures());
+  }
+  return Failures() ? 1 : 0;
+}
+
+// Wall clock nanoseconds per call of fn, over n calls.
+template <typename Fn>
+double NsPerOp(size_t n, Fn &&fn) {
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i{0}; i < n; ++i) {
+    fn(i);
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() / n;
+}
+
+// a == b, integers of mixed signedness compared by value (a negative one
+// never equals an unsigned one).
+template <typename A, typename B>
+inline bool Equal(const A &a, const B &b) {
+  if constexpr (std::is_integral<A>::value && std::is_integral<B>::value &&
+                std::is_signed<A>::value != std::is_signed<B>::value) {
+    using Unsigned = std::make_unsigned_t<std::common_type_t<A, B>>;
+    if constexpr (std::is_signed<A>::value) {
+      return a >= 0 && static_cast<Unsigned>(a) == static_cast<Unsigned>(b);
+    } else {
+      return b >= 0 && static_cast<Unsigned>(a) == static_cast<Unsigned>(b);
+    }
+  } else {
+    return a == b;
+  }
+}
+
+// Keeps the optimizer from dropping a result nobody reads.
+template <typename T>
+inline void Use(const T &value) {
+  asm volatile("" : : "g"(&value) : "memory");
+}
+
+}  // namespace test
+
+#define CHECK(cond)                                                     \
+  do {                                                                  \
+    if (!(cond)) {                                                      \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);   \
+      ++test::Failures();                                               \
+    }                                                                   \
+  } while (0)
+
+#define CHECK_EQ(a, b)                                                  \
+  do {                                                                  \
+    auto check_a = (a);                                                 \
+    auto check_b = (b);                                                 \
+    if (!test::Equal(check_a, check_b)) {                               \
+      printf("%s:%d: CHECK_EQ(%s, %s) failed: %s != %s\n", __FILE__,    \
+             __LINE__, #a, #b, std::to_string(check_a).c_str(),         \
+             std::to_string(check_b).c_str());                          \
+      ++test::Failures();                                               \
+    }                                                                   \
+  } while (0)
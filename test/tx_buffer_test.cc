@@ -0,0 +1,134 @@
+#include "com_link.h"
+#include "common/com/tx_buffer.h"
+
+#include "test.h"
+
+namespace {
+
+using common::com::TxBuffer;
+
+// Bytes stay queued until the size threshold, the time threshold or a full
+// buffer, and leave in the order they were written.
+void TestThresholds() {
+  test::Link link;
+  TxBuffer<HardwareSerial, 16> buffer;
+  buffer.Attach(link.a);
+  CHECK(!buffer.Enabled());
+  buffer.Configure(8, 5);
+  CHECK(buffer.Enabled());
+
+  buffer.Write("abcd", 4);
+  buffer.Poll();
+  CHECK_EQ(buffer.Pending(), 4u);
+  CHECK_EQ(link.a.Sent(), 0u);
+  buffer.Write("efgh", 4);
+  buffer.Poll();
+  CHECK_EQ(buffer.Pending(), 0u);
+  CHECK_EQ(link.a.Sent(), 8u);
+
+  buffer.Write("ij", 2);
+  delay(4);
+  buffer.Poll();
+  CHECK_EQ(buffer.Pending(), 2u);
+  delay(1);
+  buffer.Poll();
+  CHECK_EQ(buffer.Pending(), 0u);
+
+  // A full buffer pushes what it holds to make room.
+  std::string data = test::Pattern(40);
+  buffer.Write(data.data(), data.size());
+  CHECK(buffer.Pending() > 0);
+  CHECK(buffer.Pending() <= 16);
+  buffer.Push();
+  CHECK_EQ(link.a.Sent(), 10u + data.size());
+
+  link.a.flush();
+  delay(1);
+  std::string got;
+  while (link.b.available()) {
+    got += static_cast<char>(link.b.read());
+  }
+  CHECK(got == "abcdefghij" + data);
+
+  // A threshold above the capacity is the capacity.
+  buffer.Configure(100, 1000);
+  buffer.Write(data.data(), 16);
+  buffer.Poll();
+  CHECK_EQ(buffer.Pending(), 0u);
+}
+
+// Coalesced writes only block while the UART's own TX ring is full, the
+// straight writes wait for every one of them to leave. A chunked write
+// after queued ones keeps the order on the wire.
+void TestHardwareCom() {
+  using Com = common::com::UART::HardwareCom<0, 64>;
+  HardwareSerial peer;
+  sim::Reset();
+  sim::Connect(Serial, peer);
+  Com::Init(115200);
+
+  for (int32_t i{0}; i < 10; ++i) {
+    Com::Write(i);
+  }
+  uint64_t straight_us = Serial.BlockedUs();
+  CHECK(straight_us > 0);
+  for (int32_t i{0}; i < 10; ++i) {
+    int32_t value{-1};
+    CHECK(test::Uart::Read(peer, value, true, false, 10, nullptr));
+    CHECK_EQ(value, i);
+  }
+
+  Serial.ResetCounters();
+  Com::SetCoalescing(32, 10);
+  for (int32_t i{0}; i < 10; ++i) {
+    Com::Write(i);
+  }
+  CHECK_EQ(Serial.BlockedUs(), 0u);
+  CHECK_EQ(Serial.Sent(), 32u);
+  delay(10);
+  Com::Poll();
+  CHECK_EQ(Serial.Sent(), 40u);
+  for (int32_t i{0}; i < 10; ++i) {
+    int32_t value{-1};
+    CHECK(test::Uart::Read(peer, value, true, false, 10, nullptr));
+    CHECK_EQ(value, i);
+  }
+
+  // The reader takes the queued value, then the transfer behind it.
+  common::com::Transfer<HardwareSerial> rx;
+  common::com::LinkState peer_link{common::com::UART::kWindowSize};
+  int32_t value{-1};
+  sim::SetBackground([&] {
+    if (value < 0) {
+      if (peer.available() >= 4) {
+        test::Uart::Read(peer, value, false, false, 0, nullptr);
+      }
+      return;
+    }
+    rx.Poll();
+  });
+  CHECK(rx.BeginRead(peer, 0, common::com::UART::kChunkSize, 1000,
+                     &peer_link));
+  Com::Write(int32_t{7});
+  std::string data = test::Pattern(100);
+  Com::Write(data);
+  CHECK_EQ(value, 7);
+  CHECK(rx.Status() == common::com::TransferStatus::DONE);
+  CHECK(rx.Data() == data);
+  sim::SetBackground(nullptr);
+
+  Com::Write(int32_t{8});
+  Com::Flush();
+  CHECK(test::Uart::Read(peer, value, false, false, 0, nullptr));
+  CHECK_EQ(value, 8);
+  Com::SetCoalescing(0, 0);
+  sim::Reset();
+}
+
+}  // namespace
+
+int main() {
+  TestThresholds();
+  TestHardwareCom();
+  return test::Result();
+}
@@ -0,0 +1,157 @@
+#include "common/utility/variant.h"
+
+#include <string>
+#include <type_traits>
+
+#include "test.h"
+
+namespace {
+
+using Value = common::Variant<double, int, std::string>;
+
+static_assert(std::is_nothrow_move_constructible<Value>::value);
+static_assert(std::is_nothrow_move_assignable<Value>::value);
+
+const char kLong[] = "a string long enough to live on the heap";
+
+void TestInPlace() {
+  test::ResetAllocs();
+  Value a(2.5);
+  Value b(a);
+  Value c(std::move(b));
+  Value d;
+  d = c;
+  d.Emplace<int>(3);
+  CHECK_EQ(test::Allocs(), 0u);
+  CHECK(c.HoldsAlternative<double>() && *c.GetIf<double>() == 2.5);
+  CHECK(*d.GetIf<int>() == 3);
+  CHECK(sizeof(common::Variant<double, int>) == 2 * sizeof(double));
+}
+
+void TestOwnership() {
+  Value a{std::string(kLong)};
+  Value b(std::move(a));
+  // Moved-from is valueless.
+  CHECK(a.Index() == static_cast<size_t>(-1));
+  CHECK(a.GetIf<std::string>() == nullptr);
+  a = std::move(b);
+  CHECK(b.Index() == static_cast<size_t>(-1));
+  CHECK(*a.GetIf<std::string>() == kLong);
+  b = std::move(a);
+  CHECK(*b.GetIf<std::string>() == kLong);
+
+  Value c;
+  c = b;
+  CHECK(*c.GetIf<std::string>() == kLong);
+  CHECK(*b.GetIf<std::string>() == kLong);
+
+  // Replacing the string releases it.
+  test::ResetAllocs();
+  c.Emplace<double>(1.0);
+  c = Value(std::string(kLong));
+  CHECK(test::Allocs() == 1);
+  c = Value(4);
+  CHECK(*c.GetIf<int>() == 4);
+  CHECK(c.GetIf<std::string>() == nullptr);
+
+  Value d("abc");
+  CHECK(d.HoldsAlternative<std::string>());
+}
+
+// Names the alternatives it is called with, in order.
+struct Names {
+  std::string operator()(double) const { return "d"; }
+  std::string operator()(int) const { return "i"; }
+  std::string operator()(const std::string &) const { return "s"; }
+  std::string operator()(char) const { return "c"; }
+  std::string operator()(bool) const { return "b"; }
+
+  template <typename A, typename B, typename... Rest>
+  std::string operator()(const A &a, const B &b, const Rest &...rest) const {
+    return (*this)(a) + (*this)(b, rest...);
+  }
+};
+
+// Every combination of variants of different sizes reaches the visitor
+// with the right alternatives: checks the row-major table index.
+void TestVisitMany() {
+  using Small = common::Variant<char, bool>;
+  const Value values[] = {Value(1.5), Value(2), Value(std::string("x"))};
+  const Small smalls[] = {Small('c'), Small(true)};
+  const char kValue[] = "dis";
+  const char kSmall[] = "cb";
+  for (const Value &a : values) {
+    for (const Small &b : smalls) {
+      std::string expected{kValue[a.Index()], kSmall[b.Index()]};
+      CHECK(common::Visit(Names{}, a, b) == expected);
+      for (const Value &c : values) {
+        expected = {kSmall[b.Index()], kValue[c.Index()], kValue[a.Index()]};
+        CHECK(common::Visit(Names{}, b, c, a) == expected);
+      }
+    }
+  }
+  static_assert(common::detail::AlternativeIndex<Value, Small, Value>(
+                    2 * 6 + 1 * 3 + 0, 0) == 2);
+  static_assert(common::detail::AlternativeIndex<Value, Small, Value>(
+                    2 * 6 + 1 * 3 + 0, 1) == 1);
+  static_assert(common::detail::AlternativeIndex<Value, Small, Value>(
+                    2 * 6 + 1 * 3 + 0, 2) == 0);
+
+  // Alternatives are passed by reference.
+  Value value(2);
+  common::Visit([](auto &alternative) { alternative += alternative; },
+                value);
+  CHECK(*value.GetIf<int>() == 4);
+}
+
+// A valueless variant anywhere skips the visitor.
+void TestVisitValueless() {
+  Value moved(1.5);
+  Value a(std::move(moved));
+  int calls{0};
+  auto count = [&calls](const auto &...) {
+    ++calls;
+    return 7;
+  };
+  CHECK_EQ(common::Visit(count, a), 7);
+  CHECK_EQ(common::Visit(count, moved), 0);
+  CHECK_EQ(common::Visit(count, a, moved), 0);
+  CHECK_EQ(common::Visit(count, moved, a), 0);
+  CHECK(common::Visit(Names{}, Value()).empty());
+  CHECK_EQ(calls, 1);
+}
+
+// Visitors returning a reference are refused: a valueless variant leaves
+// nothing to return.
+template <typename Visitor, typename = void>
+struct CanVisit : std::false_type {};
+
+template <typename Visitor>
+struct CanVisit<Visitor,
+                std::void_t<decltype(common::Visit(
+                    std::declval<Visitor &>(), std::declval<Value &>()))>>
+    : std::true_type {};
+
+struct ByValue {
+  template <typename T>
+  size_t operator()(T &value) const { return sizeof(value); }
+};
+
+struct ByReference {
+  int dummy{0};
+  template <typename T>
+  int &operator()(T &) { return dummy; }
+};
+
+static_assert(CanVisit<ByValue>::value);
+static_assert(!CanVisit<ByReference>::value);
+
+}  // namespace
+
+int main() {
+  TestInPlace();
+  TestOwnership();
+  TestVisitMany();
+  TestVisitValueless();
+  return test::Result();
+}
@@ -0,0 +1,118 @@
+#include "common/event/defs.h"
+
+#include <limits>
+#include <string>
+
+#include "test.h"
+
+namespace {
+
+using common::com::ByteSpan;
+using common::com::CompactEncoding;
+using common::com::FixedEncoding;
+using common::com::StringSink;
+
+template <typename Type>
+std::string EncodeCompact(Type value) {
+  std::string bytes;
+  StringSink sink(bytes);
+  CompactEncoding::EncodeInt(value, sink);
+  return bytes;
+}
+
+template <typename Type>
+void CheckRoundTrip(Type value, size_t size) {
+  std::string bytes = EncodeCompact(value);
+  CHECK_EQ(bytes.size(), size);
+  ByteSpan span(bytes);
+  Type decoded{0};
+  CHECK(CompactEncoding::DecodeInt(span, decoded));
+  CHECK(decoded == value);
+  CHECK_EQ(span.Remaining(), 0u);
+}
+
+// LEB128 sizes at the 7 bit boundaries, zigzag keeps small negative values
+// small.
+void TestSizes() {
+  CheckRoundTrip<uint16_t>(0, 1);
+  CheckRoundTrip<uint16_t>(127, 1);
+  CheckRoundTrip<uint16_t>(128, 2);
+  CheckRoundTrip<uint16_t>(16383, 2);
+  CheckRoundTrip<uint16_t>(16384, 3);
+  CheckRoundTrip<uint16_t>(std::numeric_limits<uint16_t>::max(), 3);
+  CheckRoundTrip<uint32_t>(std::numeric_limits<uint32_t>::max(), 5);
+  CheckRoundTrip<uint64_t>(std::numeric_limits<uint64_t>::max(), 10);
+  CheckRoundTrip<int16_t>(-1, 1);
+  CheckRoundTrip<int16_t>(-64, 1);
+  CheckRoundTrip<int16_t>(63, 1);
+  CheckRoundTrip<int16_t>(64, 2);
+  CheckRoundTrip<int16_t>(-65, 2);
+  CheckRoundTrip<int32_t>(std::numeric_limits<int32_t>::min(), 5);
+  CheckRoundTrip<int32_t>(std::numeric_limits<int32_t>::max(), 5);
+  CheckRoundTrip<int64_t>(std::numeric_limits<int64_t>::min(), 10);
+  // Bytes are copied as they are.
+  CheckRoundTrip<int8_t>(-100, 1);
+  CheckRoundTrip<uint8_t>(200, 1);
+}
+
+template <typename Type>
+bool Decodes(const std::string &bytes) {
+  ByteSpan span(bytes);
+  Type value;
+  bool ok = CompactEncoding::DecodeInt(span, value);
+  CHECK_EQ(ok, span.Ok());
+  return ok;
+}
+
+void TestMalformed() {
+  CHECK(!Decodes<uint32_t>(""));
+  CHECK(!Decodes<uint32_t>("\x80"));
+  CHECK(!Decodes<uint32_t>("\xFF\xFF"));
+  // Six bytes for a uint32_t.
+  CHECK(!Decodes<uint32_t>("\x80\x80\x80\x80\x80\x01"));
+  // Bits past the 16th / 32nd.
+  CHECK(Decodes<uint16_t>("\xFF\xFF\x03"));
+  CHECK(!Decodes<uint16_t>("\xFF\xFF\x04"));
+  CHECK(Decodes<uint32_t>("\xFF\xFF\xFF\xFF\x0F"));
+  CHECK(!Decodes<uint32_t>("\xFF\xFF\xFF\xFF\x1F"));
+  CHECK(!Decodes<int32_t>("\xFF\xFF\xFF\xFF\x10"));
+}
+
+// Event with the compact policy, as a build with COMMON_EVENT_ENCODING set
+// to CompactEncoding has it.
+struct CompactEvent : common::Event {
+  using EncodingPolicy = CompactEncoding;
+};
+
+// The policy is picked per message type, string lengths shrink to a byte.
+void TestMessagePolicy() {
+  CompactEvent event;
+  event.time = common::Time::FromSec(1700000123);
+  event.error_code = 7;
+  event.source_name = common::Symbol::Static("pump");
+  event.event_msg = "flow low";
+
+  std::string fixed;
+  common::com::Encode(static_cast<const common::Event &>(event), fixed);
+  std::string compact;
+  common::com::Encode(event, compact);
+  CHECK(compact.size() < fixed.size());
+
+  CompactEvent decoded;
+  ByteSpan span(compact);
+  CHECK(common::com::Decode(span, decoded));
+  CHECK_EQ(span.Remaining(), 0u);
+  CHECK_EQ(decoded.time.Sec(), 1700000123u);
+  CHECK_EQ(decoded.error_code, 7);
+  CHECK(decoded.source_name == "pump");
+  CHECK(decoded.event_msg == "flow low");
+}
+
+}  // namespace
+
+int main() {
+  TestSizes();
+  TestMalformed();
+  TestMessagePolicy();
+  return test::Result();
+}
@@ -0,0 +1,222 @@
+#!/usr/bin/env python3
+"""Host side of binary logging (src/common/binary_log.h).
+
+Builds the string table of every COMMON_FORMAT literal in the sources and
+turns binary log records back into the text lines the other handlers write:
+
+  tools/binary_log.py table src > strings.tsv
+  tools/binary_log.py decode strings.tsv LOG.d00   # or stdin, e.g. a serial dump
+
+Text printed around the records (serial output) is passed through.
+"""
+
+import argparse
+import json
+import os
+import re
+import struct
+import sys
+import time
+
+LEVELS = {-1: "DEBUG", 0: "INFO", 1: "WARN", 2: "ERROR", 3: "FATAL"}
+
+# BinaryLogType: struct format, or None for strings.
+TYPES = {
+    1: "<B", 2: "<b", 3: "<H", 4: "<h", 5: "<I", 6: "<i", 7: "<Q", 8: "<q",
+    9: "<f", 10: "<d", 11: None, 12: "<?",
+}
+
+LITERALS = re.compile(r'COMMON_FORMAT\(\s*((?:"(?:[^"\\\n]|\\.)*"\s*)+)\)')
+LITERAL = re.compile(r'"((?:[^"\\\n]|\\.)*)"')
+ESCAPES = {"n": 10, "t": 9, "r": 13, "0": 0, "a": 7, "b": 8, "f": 12, "v": 11}
+
+
+def unescape(literal):
+    """C string literal body to the bytes the compiler emits."""
+    out = bytearray()
+    raw = literal.encode("utf-8")
+    i = 0
+    while i < len(raw):
+        c = raw[i]
+        i += 1
+        if c != ord("\\"):
+            out.append(c)
+            continue
+        e = chr(raw[i])
+        i += 1
+        if e == "x":
+            digits = re.match(rb"[0-9a-fA-F]+", raw[i:]).group(0)
+            out.append(int(digits, 16) & 0xFF)
+            i += len(digits)
+        elif e in "01234567":
+            digits = re.match(rb"[0-7]{1,3}", raw[i - 1:]).group(0)
+            out.append(int(digits, 8) & 0xFF)
+            i += len(digits) - 1
+        else:
+            out.append(ESCAPES.get(e, ord(e)))
+    return bytes(out)
+
+
+def format_id(fmt):
+    """detail::FormatId: FNV-1a folded to 16 bits."""
+    h = 2166136261
+    for b in fmt:
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return (h >> 16) ^ (h & 0xFFFF)
+
+
+def placeholders(fmt):
+    return fmt.count(b"%%")
+
+
+def build_table(paths):
+    table = {}
+    for root_path in paths:
+        for root, _, files in os.walk(root_path):
+            for name in sorted(files):
+                if not name.endswith((".h", ".cc", ".cpp", ".ino")):
+                    continue
+                with open(os.path.join(root, name), encoding="utf-8",
+                          errors="replace") as f:
+                    source = f.read()
+                for match in LITERALS.finditer(source):
+                    fmt = b"".join(unescape(m.group(1))
+                                   for m in LITERAL.finditer(match.group(1)))
+                    fid = format_id(fmt)
+                    if table.get(fid, fmt) != fmt:
+                        sys.exit("id collision %04x: %r and %r, reword one"
+                                 % (fid, table[fid], fmt))
+                    table[fid] = fmt
+    return table
+
+
+def write_table(table, out):
+    for fid in sorted(table):
+        out.write("%04x\t%s\n" % (
+            fid, json.dumps(table[fid].decode("utf-8", "replace"))))
+
+
+def read_table(path):
+    table = {}
+    with open(path, encoding="utf-8") as f:
+        for line in f:
+            fid, fmt = line.rstrip("\n").split("\t", 1)
+            table[int(fid, 16)] = json.loads(fmt).encode("utf-8")
+    return table
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def format_float(value):
+    """FormatArg::PrintFloat."""
+    if value != value:
+        return "nan"
+    if value in (float("inf"), float("-inf")):
+        return "inf"
+    if abs(value) > 4294967040.0:
+        return "ovf"
+    sign = "-" if value < 0 else ""
+    value = abs(value) + 0.5 / 10000
+    integer = int(value)
+    fraction = int((value - integer) * 10000) % 10000
+    return "%s%d.%04d" % (sign, integer, fraction)
+
+
+def parse_record(payload, table):
+    """Text line of a record, None if it is not one."""
+    if len(payload) < 8:
+        return None
+    fid, level, error_code, sec = struct.unpack_from("<HbBI", payload)
+    fmt = table.get(fid)
+    if fmt is None or level not in LEVELS:
+        return None
+    count = placeholders(fmt)
+    pos = 8 + (count + 1) // 2
+    if pos > len(payload):
+        return None
+    types = [(payload[8 + i // 2] >> (4 * (i % 2))) & 0xF
+             for i in range(count)]
+    args = []
+    for t in types:
+        if t not in TYPES:
+            return None
+        if TYPES[t] is None:
+            if pos >= len(payload):
+                return None
+            size = payload[pos]
+            text = payload[pos + 1:pos + 1 + size]
+            if len(text) != size:
+                return None
+            args.append(text)
+            pos += 1 + size
+            continue
+        size = struct.calcsize(TYPES[t])
+        if pos + size > len(payload):
+            return None
+        value, = struct.unpack_from(TYPES[t], payload, pos)
+        pos += size
+        if t in (9, 10):
+            args.append(format_float(value).encode())
+        else:
+            args.append(str(int(value)).encode())
+    if pos != len(payload):
+        return None
+
+    parts = fmt.split(b"%%")
+    msg = parts[0] + b"".join(a + p for a, p in zip(args, parts[1:]))
+    stamp = time.strftime("%Y-%m-%dT%H:%M:%S", time.gmtime(sec))
+    return "%s    %s    %d    %s" % (stamp, LEVELS[level], error_code,
+                                     msg.decode("utf-8", "replace"))
+
+
+def decode(data, table, out):
+    for chunk in data.split(b"\0"):
+        if not chunk:
+            continue
+        # Serial dumps interleave text lines, the record is a suffix.
+        for start in range(len(chunk)):
+            payload = cobs_decode(chunk[start:])
+            line = payload is not None and parse_record(payload, table)
+            if line:
+                out.write(chunk[:start].decode("utf-8", "replace"))
+                out.write(line + "\n")
+                break
+        else:
+            out.write(chunk.decode("utf-8", "replace"))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    commands = parser.add_subparsers(dest="command", required=True)
+    table = commands.add_parser("table", help="string table of the sources")
+    table.add_argument("paths", nargs="+")
+    dec = commands.add_parser("decode", help="records to text")
+    dec.add_argument("table")
+    dec.add_argument("log", nargs="?")
+    args = parser.parse_args()
+
+    if args.command == "table":
+        write_table(build_table(args.paths), sys.stdout)
+    else:
+        if args.log:
+            with open(args.log, "rb") as f:
+                data = f.read()
+        else:
+            data = sys.stdin.buffer.read()
+        decode(data, read_table(args.table), sys.stdout)
+
+
+if __name__ == "__main__":
+    main()